@@ -0,0 +1,72 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <string.h>
+
+/**
+ * Anchor the value at stack index iIndex, below the key at the top
+ * of the stack, under that key; pops the key.
+ */
+static void
+anchor(lkonf_context * iLc, const int iIndex)
+{
+	lua_State * L = iLc->state;
+							/* S: v ... k */
+	lua_pushvalue(L, iIndex < 0 ? iIndex - 1 : iIndex);	/* S: v ... k v */
+	if (LUA_NOREF == iLc->load_anchors) {
+		lua_newtable(L);			/* S: v ... k v a */
+		iLc->load_anchors =
+		    luaL_ref(L, LUA_REGISTRYINDEX);	/* S: v ... k v */
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, iLc->load_anchors);
+	lua_insert(L, -3);				/* S: v ... a k v */
+	lua_rawset(L, -3);				/* S: v ... a */
+	lua_pop(L, 1);					/* S: v ... */
+}
+
+void
+lki_anchor(lkonf_context * iLc, const int iIndex, const char * iPath)
+{
+	lua_pushstring(iLc->state, iPath);		/* S: v ... p */
+	anchor(iLc, iIndex);
+}
+
+void
+lki_anchor_ikeys(lkonf_context * iLc, const int iIndex, lkonf_ikeys iKeys)
+{
+		/*
+		 * Encode the keys rather than formatting a path:
+		 * each is a type byte then the name and its nul, or the
+		 * bytes of the index. The type bytes aren't the start of
+		 * a path, so these don't collide with lki_anchor().
+		 */
+	luaL_Buffer lb;
+	luaL_buffinit(iLc->state, &lb);
+
+	size_t ki;
+	for (ki = 0; LK_KEY_END != iKeys[ki].type; ++ki) {
+		if (LK_KEY_INDEX == iKeys[ki].type) {
+			luaL_addchar(&lb, '\2');
+			luaL_addlstring(&lb, (const char *)&iKeys[ki].index,
+				sizeof(iKeys[ki].index));
+		} else {
+			luaL_addchar(&lb, '\1');
+			luaL_addlstring(&lb, iKeys[ki].name,
+				strlen(iKeys[ki].name) + 1);
+		}
+	}
+
+	luaL_pushresult(&lb);				/* S: v ... k */
+	anchor(iLc, iIndex);
+}
+
+void
+lki_release_anchors(lkonf_context * iLc)
+{
+	if (! iLc->state || LUA_NOREF == iLc->load_anchors) {
+		return;
+	}
+
+	luaL_unref(iLc->state, LUA_REGISTRYINDEX, iLc->load_anchors);
+	iLc->load_anchors = LUA_NOREF;
+}
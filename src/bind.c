@@ -0,0 +1,469 @@
+#include "internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Maximum length of the full path of a binding.
+ */
+#define BIND_PATH_MAX	256
+
+/**
+ * State of lkonf_bind().
+ */
+typedef struct
+{
+	lkonf_context *		lc;		/** Context. */
+	lkonf_bind_report	report;		/** Error callback, or NULL. */
+	void *			arg;		/** Argument for report. */
+	lkonf_error		code;		/** First error code. */
+	char			string[128];	/** First error string. */
+} bind_state;
+
+/**
+ * Report the error in iBs->lc for iPath, remember it if it's the first,
+ * and reset the error so that binding can continue.
+ */
+static void
+report_error(bind_state * iBs, const char * iPath)
+{
+	const lkonf_error code = lkonf_get_error_code(iBs->lc);
+	const char * string = lkonf_get_error_string(iBs->lc);
+
+	if (iBs->report) {
+		iBs->report(iBs->arg, iPath, code, string);
+	}
+
+	if (LK_OK == iBs->code) {
+		iBs->code = code;
+		snprintf(iBs->string, sizeof(iBs->string), "%s", string);
+	}
+
+	lki_reset_error(iBs->lc);
+}
+
+/**
+ * Set and report an error for iPath.
+ */
+static void
+bind_error(
+	bind_state *		iBs,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iPath)
+{
+	lki_set_error_item(iBs->lc, iCode, iString, iPath);
+	report_error(iBs, iPath);
+}
+
+/**
+ * Join iPrefix and iPath into oPath.
+ * @return False if oPath is too short.
+ */
+static bool
+join_path(const char * iPrefix, const char * iPath, char * oPath)
+{
+	const int len = snprintf(oPath, BIND_PATH_MAX, "%s%s%s",
+		iPrefix, *iPrefix && '[' != *iPath ? "." : "", iPath);
+
+	return len >= 0 && len < BIND_PATH_MAX;
+}
+
+/**
+ * Copy iLen bytes of iString to a new string in oValue.
+ * @return False if out of memory.
+ */
+static bool
+copy_string(const char * iString, size_t iLen, char ** oValue)
+{
+	char * copy = malloc(iLen + 1);
+	if (! copy) {
+		*oValue = 0;
+		return false;
+	}
+	memcpy(copy, iString, iLen);
+	copy[iLen] = '\0';
+
+	*oValue = copy;
+	return true;
+}
+
+/**
+ * Set the member of oStruct bound by iBinding to its fallback value.
+ * Members of a struct are set to their fallback values,
+ * and the length of an array to 0.
+ */
+static void
+set_fallback(
+	bind_state *		iBs,
+	const lkonf_binding *	iBinding,
+	const char *		iPath,
+	char *			oStruct)
+{
+	void * member = oStruct + iBinding->offset;
+
+	switch (iBinding->type) {
+
+	case LK_BIND_BOOLEAN:
+		*(bool *)member = iBinding->fallback.boolean;
+		break;
+
+	case LK_BIND_INTEGER:
+		*(lua_Integer *)member = iBinding->fallback.integer;
+		break;
+
+	case LK_BIND_DOUBLE:
+		*(double *)member = iBinding->fallback.number;
+		break;
+
+	case LK_BIND_STRING:
+		*(char **)member = 0;
+		if (iBinding->fallback.string && ! copy_string(
+		    iBinding->fallback.string, strlen(iBinding->fallback.string),
+		    (char **)member)) {
+			bind_error(iBs, LK_RESOURCE_EXHAUSTED,
+				"Copying string result for", iPath);
+		}
+		break;
+
+	case LK_BIND_STRUCT: {
+		size_t i;
+		for (i = 0; i < iBinding->count; ++i) {
+			const lkonf_binding * field = &iBinding->fields[i];
+			char path[BIND_PATH_MAX];
+			if (field->path && join_path(iPath, field->path, path)) {
+				set_fallback(iBs, field, path, member);
+			}
+		}
+		break;
+	}
+
+	case LK_BIND_BOOLEAN_ARRAY:
+	case LK_BIND_INTEGER_ARRAY:
+	case LK_BIND_DOUBLE_ARRAY:
+		*(size_t *)(oStruct + iBinding->length_offset) = 0;
+		break;
+
+	}
+}
+
+/**
+ * Store the number or boolean at the top of the stack in oMember.
+ * @param iState	Lua state.
+ * @param iType		Type of oMember; LK_BIND_BOOLEAN, INTEGER or DOUBLE.
+ * @param[out] oMember	Member.
+ * @return Error string if the value is of the wrong type, otherwise 0.
+ */
+static const char *
+store_scalar(lua_State * iState, const lkonf_bind_type iType, void * oMember)
+{
+	const int type = lua_type(iState, -1);
+
+	switch (iType) {
+
+	case LK_BIND_BOOLEAN:
+		if (LUA_TBOOLEAN != type) {
+			return "Not a boolean";
+		}
+		*(bool *)oMember = lua_toboolean(iState, -1);
+		return 0;
+
+	case LK_BIND_INTEGER:
+		if (LUA_TNUMBER != type
+		    || ! lki_to_integer(iState, -1, (lua_Integer *)oMember)) {
+			return "Not an integer";
+		}
+		return 0;
+
+	case LK_BIND_DOUBLE:
+		if (LUA_TNUMBER != type) {
+			return "Not a double";
+		}
+		*(double *)oMember = lua_tonumber(iState, -1);
+		return 0;
+
+	default:
+		return "Invalid binding type";
+	}
+}
+
+/**
+ * Bind the array at the top of the stack to the member bound by iBinding.
+ */
+static void
+bind_array(
+	bind_state *		iBs,
+	const lkonf_binding *	iBinding,
+	const char *		iPath,
+	char *			oStruct)
+{
+	lua_State * L = iBs->lc->state;
+	size_t * length = (size_t *)(oStruct + iBinding->length_offset);
+	*length = 0;
+
+	if (! lua_istable(L, -1)) {
+		bind_error(iBs, LK_OUT_OF_RANGE, "Not a table", iPath);
+		return;
+	}
+
+	lki_push_storage(L, -1);			/* S: t s */
+#if LUA_VERSION_NUM >= 502
+	const size_t len = lua_rawlen(L, -1);
+#else
+	const size_t len = lua_objlen(L, -1);
+#endif
+
+	if (len > iBinding->count) {
+		bind_error(iBs, LK_OUT_OF_RANGE,
+			"Array longer than buffer", iPath);
+		return;
+	}
+
+	lkonf_bind_type type;
+	size_t size;
+	switch (iBinding->type) {
+	case LK_BIND_BOOLEAN_ARRAY:
+		type = LK_BIND_BOOLEAN;
+		size = sizeof(bool);
+		break;
+	case LK_BIND_INTEGER_ARRAY:
+		type = LK_BIND_INTEGER;
+		size = sizeof(lua_Integer);
+		break;
+	default:
+		type = LK_BIND_DOUBLE;
+		size = sizeof(double);
+		break;
+	}
+
+	char * elements = oStruct + iBinding->offset;
+	size_t i;
+	for (i = 0; i < len; ++i) {
+		lua_rawgeti(L, -1, (int)(i + 1));	/* S: t s s[i] */
+		const char * error = store_scalar(L, type, elements + i * size);
+		lua_pop(L, 1);				/* S: t s */
+		if (error) {
+			*length = i;
+			lki_set_error_index(iBs->lc,
+				LK_OUT_OF_RANGE, error, iPath, i + 1);
+			report_error(iBs, iPath);
+			return;
+		}
+	}
+
+	*length = len;
+}
+
+static void
+bind_fields(
+	bind_state *		iBs,
+	const int		iTable,
+	const char *		iPrefix,
+	const lkonf_binding *	iBindings,
+	const size_t		iNumBindings,
+	char *			oStruct);
+
+/**
+ * Bind the value at the top of the stack to the member bound by iBinding.
+ */
+static void
+bind_value(
+	bind_state *		iBs,
+	const lkonf_binding *	iBinding,
+	const char *		iPath,
+	char *			oStruct)
+{
+	lua_State * L = iBs->lc->state;
+	void * member = oStruct + iBinding->offset;
+
+	if (lua_isnil(L, -1)) {
+		set_fallback(iBs, iBinding, iPath, oStruct);
+		if (iBinding->required) {
+			bind_error(iBs, LK_NOT_FOUND, "Missing", iPath);
+		}
+		return;
+	}
+
+	switch (iBinding->type) {
+
+	case LK_BIND_BOOLEAN:
+	case LK_BIND_INTEGER:
+	case LK_BIND_DOUBLE: {
+		const char * error = store_scalar(L, iBinding->type, member);
+		if (error) {
+			set_fallback(iBs, iBinding, iPath, oStruct);
+			bind_error(iBs, LK_OUT_OF_RANGE, error, iPath);
+		}
+		break;
+	}
+
+	case LK_BIND_STRING: {
+		if (LUA_TSTRING != lua_type(L, -1)) {
+			set_fallback(iBs, iBinding, iPath, oStruct);
+			bind_error(iBs, LK_OUT_OF_RANGE, "Not a string", iPath);
+			break;
+		}
+		size_t len;
+		const char * str = lua_tolstring(L, -1, &len);
+		if (! copy_string(str, len, (char **)member)) {
+			bind_error(iBs, LK_RESOURCE_EXHAUSTED,
+				"Copying string result for", iPath);
+		}
+		break;
+	}
+
+	case LK_BIND_STRUCT:
+		if (! lua_istable(L, -1)) {
+			set_fallback(iBs, iBinding, iPath, oStruct);
+			bind_error(iBs, LK_OUT_OF_RANGE, "Not a table", iPath);
+			break;
+		}
+		bind_fields(iBs, lua_gettop(L), iPath,
+			iBinding->fields, iBinding->count, member);
+		break;
+
+	case LK_BIND_BOOLEAN_ARRAY:
+	case LK_BIND_INTEGER_ARRAY:
+	case LK_BIND_DOUBLE_ARRAY:
+		bind_array(iBs, iBinding, iPath, oStruct);
+		break;
+
+	default:
+		bind_error(iBs, LK_INVALID_ARGUMENT,
+			"Invalid binding type", iPath);
+		break;
+
+	}
+}
+
+/**
+ * Bind iBindings relative to the table at iTable, to oStruct.
+ * @param iBs		State.
+ * @param iTable	Absolute index of table.
+ * @param iPrefix	Full path of the table, for errors and functions.
+ * @param iBindings	Bindings.
+ * @param iNumBindings	Number of bindings.
+ * @param[out] oStruct	Struct.
+ */
+static void
+bind_fields(
+	bind_state *		iBs,
+	const int		iTable,
+	const char *		iPrefix,
+	const lkonf_binding *	iBindings,
+	const size_t		iNumBindings,
+	char *			oStruct)
+{
+	lkonf_context * lc = iBs->lc;
+
+	if (iNumBindings && ! iBindings) {
+		bind_error(iBs, LK_INVALID_ARGUMENT, "Bindings NULL", iPrefix);
+		return;
+	}
+
+	if (! lua_checkstack(lc->state, 8)) {
+		bind_error(iBs, LK_RESOURCE_EXHAUSTED, "Too deep", iPrefix);
+		return;
+	}
+
+	size_t i;
+	for (i = 0; i < iNumBindings; ++i) {
+		const lkonf_binding * b = &iBindings[i];
+
+		char path[BIND_PATH_MAX];
+		if (! b->path) {
+			bind_error(iBs, LK_INVALID_ARGUMENT,
+				"Binding path NULL", iPrefix);
+			continue;
+		}
+		if (! join_path(iPrefix, b->path, path)) {
+			bind_error(iBs, LK_OUT_OF_RANGE, "Path too long", b->path);
+			continue;
+		}
+
+		const int top = lua_gettop(lc->state);
+
+		lua_pushvalue(lc->state, iTable);		/* S: t */
+		if (LK_OK != lki_walk_path(lc, b->path)) {
+				/* Report the full path rather than b->path. */
+			lki_set_error_item(lc, lc->error_code,
+				lc->error_message, path);
+			set_fallback(iBs, b, path, oStruct);
+			report_error(iBs, path);
+			lua_settop(lc->state, top);
+			continue;
+		}						/* S: v */
+
+		if (lua_isfunction(lc->state, -1)) {
+			LKI_PROBE_FUNCTION_CALL(path, 0);
+			lua_pushstring(lc->state, path);	/* S: f path */
+			if (LK_OK != lki_call_chunk(lc, 1, 1)) {
+				set_fallback(iBs, b, path, oStruct);
+				report_error(iBs, path);
+				lua_settop(lc->state, top);
+				continue;
+			}					/* S: v */
+		}
+
+		bind_value(iBs, b, path, oStruct);
+		lua_settop(lc->state, top);
+	}
+}
+
+lkonf_error
+lkonf_bind(
+	lkonf_context *		iLc,
+	const char *		iRoot,
+	const lkonf_binding *	iBindings,
+	const size_t		iNumBindings,
+	void *			oStruct,
+	lkonf_bind_report	iReport,
+	void *			iArg)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! iRoot) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iRoot NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (! oStruct) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oStruct NULL");
+		return lki_state_exit(iLc);
+	}
+
+		/* Find the root once; bindings are relative to it. */
+	if (! *iRoot) {
+		lki_push_globals(iLc->state);		/* S: t */
+	} else if (LK_OK != lki_find_table_by_path(iLc, iRoot)) {
+		return lki_state_exit(iLc);
+	} else if (! lua_istable(iLc->state, -1)) {
+		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Not a table", iRoot);
+		return lki_state_exit(iLc);
+	}
+
+	bind_state bs;
+	memset(&bs, 0, sizeof(bs));
+	bs.lc = iLc;
+	bs.report = iReport;
+	bs.arg = iArg;
+	bs.code = LK_OK;
+
+	bind_fields(&bs, lua_gettop(iLc->state), iRoot,
+		iBindings, iNumBindings, oStruct);
+
+		/* The first error is the result. */
+	if (LK_OK != bs.code) {
+		lki_set_error_litem(iLc, bs.code, 0,
+			bs.string, strlen(bs.string));
+	}
+
+	return lki_state_exit(iLc);
+}
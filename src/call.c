@@ -0,0 +1,85 @@
+#include "internal.h"
+
+#include <limits.h>
+
+lkonf_error
+lkonf_call(
+	lkonf_context *			iLc,
+	const lkonf_function_ref *	iRef,
+	const lkonf_value *		iArgs,
+	const size_t			iNumArgs,
+	lkonf_value *			oResults,
+	const size_t			iNumResults)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! iRef) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iRef NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (iRef->lc != iLc) {
+		lki_set_error(iLc,
+			LK_INVALID_ARGUMENT, "iRef not from iLc");
+		return lki_state_exit(iLc);
+	}
+
+	if (iNumArgs && ! iArgs) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iArgs NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (iNumResults && ! oResults) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oResults NULL");
+		return lki_state_exit(iLc);
+	}
+
+	lua_State * L = iLc->state;
+
+	if (iNumArgs > INT_MAX / 4 || iNumResults > INT_MAX / 4
+	    || ! lua_checkstack(L, (int)(iNumArgs + iNumResults) + 2)) {
+		lki_set_error(iLc,
+			LK_RESOURCE_EXHAUSTED, "Too many arguments or results");
+		return lki_state_exit(iLc);
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, iRef->ref);		/* S: st */
+	const int st = lua_gettop(L);
+	lua_rawgeti(L, st, 1);					/* S: st f */
+
+	size_t i;
+	for (i = 0; i < iNumArgs; ++i) {			/* S: st f a... */
+		if (! lki_push_value(L, &iArgs[i])) {
+			lki_set_error_index(iLc, LK_INVALID_ARGUMENT,
+				"Invalid argument", iRef->path, i + 1);
+			return lki_state_exit(iLc);
+		}
+	}
+
+	LKI_PROBE_FUNCTION_CALL(iRef->path, 0);
+	if (LK_OK != lki_call_chunk(iLc, (int)iNumArgs, (int)iNumResults)) {
+		return lki_state_exit(iLc);
+	}
+								/* S: st r... */
+	for (i = 0; i < iNumResults; ++i) {
+		const int idx = st + 1 + (int)i;
+		lki_to_value(L, idx, &oResults[i]);
+
+			/* Anchor strings until the next call with iRef,
+			 * releasing any string from the previous call. */
+		if (LK_TYPE_STRING == oResults[i].type) {
+			lua_pushvalue(L, idx);
+		} else {
+			lua_pushnil(L);
+		}
+		lua_rawseti(L, st, (int)i + 2);
+	}
+
+	return lki_state_exit(iLc);
+}
@@ -0,0 +1,146 @@
+#include "internal.h"
+
+#include <limits.h>
+#include <string.h>
+
+/**
+ * Arguments of run_batch(), passed as light userdata.
+ */
+typedef struct
+{
+	lkonf_context *		lc;		/** Context. */
+	const char *		path;		/** Path of the function. */
+	const lkonf_value *	inputs;		/** Argument per element. */
+	size_t			count;		/** Number of elements. */
+	lkonf_value *		outputs;	/** Result per element. */
+	lkonf_error *		errors;		/** Error per element, or 0. */
+	lkonf_error		first;		/** Error of first failure. */
+} batch;
+
+/**
+ * Call the function for each element of a batch, in one protected call.
+ * Each element is called with its own lua_pcall(), so an error fails
+ * just that element; errors raised by the count hook end the batch.
+ * Argument 1 is the batch, argument 2 the call state table.
+ * @return The error message of the first failed element, or nil.
+ */
+static int
+run_batch(lua_State * iState)
+{
+	batch * b = lua_touserdata(iState, 1);
+	lua_settop(iState, 2);					/* S: b st */
+	lua_rawgeti(iState, 2, 1);				/* S: b st f */
+	lua_pushnil(iState);					/* S: b st f e */
+
+		/* Anchor strings until the next batch with this reference. */
+	lua_createtable(iState, 0, 0);				/* S: b st f e a */
+	lua_pushvalue(iState, -1);				/* S: b st f e a a */
+	lua_rawseti(iState, 2, 0);				/* S: b st f e a */
+
+	size_t i;
+	for (i = 0; i < b->count; ++i) {
+		lkonf_error code = LK_OK;
+
+		lua_pushvalue(iState, 3);			/* S: ... f */
+		if (! lki_push_value(iState, &b->inputs[i])) {
+			lua_pop(iState, 1);			/* S: ... */
+			lua_pushfstring(iState, "Invalid argument: %s[%d]",
+				b->path, (int)(i + 1));		/* S: ... m */
+			code = LK_INVALID_ARGUMENT;
+		} else if (lua_pcall(iState, 1, 1, 0)) {	/* S: ... r|m */
+			if (b->lc->hook_error) {
+				lua_error(iState);
+			}
+			code = LK_LUA_ERROR;
+		}
+
+		if (code) {
+			lkonf_value * o = &b->outputs[i];
+			memset(o, 0, sizeof(*o));
+			o->type = LK_TYPE_NIL;
+			if (! b->first) {
+				b->first = code;
+				lua_replace(iState, 4);		/* S: ... */
+			} else {
+				lua_pop(iState, 1);		/* S: ... */
+			}
+		} else {
+			lki_to_value(iState, -1, &b->outputs[i]);
+			if (LK_TYPE_STRING == b->outputs[i].type) {
+				lua_rawseti(iState, 5, (int)(i + 1));
+			} else {
+				lua_pop(iState, 1);		/* S: ... */
+			}
+		}
+
+		if (b->errors) {
+			b->errors[i] = code;
+		}
+	}
+
+	lua_pushvalue(iState, 4);				/* S: ... e */
+	return 1;
+}
+
+lkonf_error
+lkonf_call_batch(
+	lkonf_context *			iLc,
+	const lkonf_function_ref *	iRef,
+	const lkonf_value *		iInputs,
+	const size_t			iCount,
+	lkonf_value *			oOutputs,
+	lkonf_error *			oErrors)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! iRef) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iRef NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (iRef->lc != iLc) {
+		lki_set_error(iLc,
+			LK_INVALID_ARGUMENT, "iRef not from iLc");
+		return lki_state_exit(iLc);
+	}
+
+	if (iCount && ! iInputs) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iInputs NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (iCount && ! oOutputs) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oOutputs NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (iCount > INT_MAX) {
+		lki_set_error(iLc, LK_OUT_OF_RANGE, "iCount too large");
+		return lki_state_exit(iLc);
+	}
+
+	batch b = {
+		iLc, iRef->path, iInputs, iCount, oOutputs, oErrors, LK_OK
+	};
+
+	lua_pushcfunction(iLc->state, &run_batch);		/* S: r */
+	lua_pushlightuserdata(iLc->state, &b);			/* S: r b */
+	lua_rawgeti(iLc->state, LUA_REGISTRYINDEX, iRef->ref);	/* S: r b st */
+
+	LKI_PROBE_FUNCTION_CALL(iRef->path, 0);
+	if (LK_OK != lki_call_chunk(iLc, 2, 1)) {		/* S: e */
+		return lki_state_exit(iLc);
+	}
+
+	if (b.first) {
+		lki_set_error_from_state(iLc, b.first);
+	}
+
+	return lki_state_exit(iLc);
+}
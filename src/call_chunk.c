@@ -19,36 +19,154 @@ lki_call_chunk(lkonf_context * iLc, const int iNumArgs, const int iNumResults)
 		return iLc->error_code;
 	}
 
-	if (iLc->instruction_limit > 0) {
-		lua_sethook(
-			iLc->state,
-			&lki_maskcount_exceeded,
-			LUA_MASKCOUNT,
-			iLc->instruction_limit);
+	if (LKI_FLAG_TAKE(iLc->interrupt)) {
+		return lki_set_error(iLc, LK_INTERRUPTED, "Interrupted");
+	}
+
+	iLc->call_start = iLc->instruction_count;
+	iLc->hook_error = LK_OK;
+
+	iLc->call_deadline = iLc->deadline;
+	if (iLc->time_limit > 0 || iLc->deadline) {
+		const uint64_t now = lki_monotonic_time();
+		if (iLc->time_limit > 0) {
+			const uint64_t end =
+			    now + (uint64_t)iLc->time_limit * 1000;
+			if (! iLc->call_deadline || end < iLc->call_deadline) {
+				iLc->call_deadline = end;
+			}
+		}
+		if (now >= iLc->call_deadline) {
+			return lki_set_error(iLc,
+				LK_DEADLINE_EXCEEDED, "Deadline exceeded");
+		}
 	}
 
 // TODO sandbox
 
 	if (lua_pcall(iLc->state, iNumArgs, iNumResults, 0)) {
-		lki_set_error_from_state(iLc, LK_LUA_ERROR);
+		lki_set_error_from_state(iLc,
+			iLc->hook_error ? iLc->hook_error : LK_LUA_ERROR);
 	}
+	iLc->call_deadline = 0;
+	iLc->hook_error = LK_OK;
 
-	if (iLc->instruction_limit > 0) {
-		lua_sethook(
-			iLc->state,
-			&lki_maskcount_exceeded,
-			LUA_MASKCOUNT,
-			0);
+		/*
+		 * The chunk may have modified the state,
+		 * unless everything reachable from the globals is sealed.
+		 */
+	lki_push_globals(iLc->state);
+	if (! lki_is_closed(iLc->state, -1)) {
+		lki_cache_invalidate(iLc);
 	}
+	lua_pop(iLc->state, 1);
 
 	return iLc->error_code;
 }
 
 
 void
-lki_maskcount_exceeded(lua_State * iState, lua_Debug * iArg)
+lki_update_hook(lkonf_context * iLc)
+{
+	assert(iLc);
+
+	if (! iLc->state) {
+		return;
+	}
+
+	int count = LKI_HOOK_COUNT;
+	if (iLc->instruction_limit > 0 &&
+	    iLc->instruction_limit / 8 < count) {
+		count = iLc->instruction_limit / 8;
+	}
+	if (iLc->instruction_budget > 0 &&
+	    iLc->instruction_budget / 8 < count) {
+		count = (int)(iLc->instruction_budget / 8);
+	}
+	if (count < 1) {
+		count = 1;
+	}
+
+#if defined(LKONF_LUAJIT)
+	const bool limited = iLc->instruction_limit > 0
+	    || iLc->instruction_budget > 0
+	    || iLc->time_limit > 0
+	    || iLc->deadline;
+	if (limited != iLc->jit_off) {
+		iLc->jit_off = limited;
+		if (limited) {
+				/* Existing traces would also skip the hook. */
+			luaJIT_setmode(iLc->state, 0,
+				LUAJIT_MODE_ENGINE | LUAJIT_MODE_FLUSH);
+			luaJIT_setmode(iLc->state, 0,
+				LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+		} else {
+			luaJIT_setmode(iLc->state, 0,
+				LUAJIT_MODE_ENGINE | LUAJIT_MODE_ON);
+		}
+	}
+#endif
+
+	if (count == iLc->hook_count) {
+		return;
+	}
+
+	iLc->hook_count = count;
+	lua_sethook(iLc->state, &lki_count_hook, LUA_MASKCOUNT, count);
+}
+
+
+void
+lki_count_hook(lua_State * iState, lua_Debug * iArg)
 {
 	(void)iArg;	/* UNUSED */
 
-        luaL_error(iState, "Instruction count exceeded");
+#if defined(LKONF_LUAJIT)
+	lua_getfield(iState, LUA_REGISTRYINDEX, LKI_CONTEXT);
+	lkonf_context * lc = lua_touserdata(iState, -1);
+	lua_pop(iState, 1);
+#else
+	void * ud = 0;
+	lua_getallocf(iState, &ud);
+	lkonf_context * lc = ud;
+#endif
+	assert(lc);
+
+	lc->instruction_count += lc->hook_count;
+
+		/*
+		 * Once interrupted, raise again on every tick until the
+		 * call returns, so the chunk can't catch it with pcall()
+		 * and carry on.  The limits and deadline stay exceeded.
+		 */
+	if (LK_INTERRUPTED == lc->hook_error || LKI_FLAG_TAKE(lc->interrupt)) {
+		lc->hook_error = LK_INTERRUPTED;
+		luaL_error(iState, "Interrupted");
+	}
+
+		/*
+		 * The hook count carries across calls, so the call may have
+		 * started up to hook_count instructions before call_start.
+		 * Allow for that so a call is never stopped early.
+		 */
+	if (lc->instruction_limit > 0 &&
+	    lc->instruction_count - lc->call_start >=
+	    (long)lc->instruction_limit + lc->hook_count) {
+		lc->hook_error = LK_LUA_ERROR;
+		LKI_PROBE_INSTRUCTION_LIMIT(iState);
+		luaL_error(iState, "Instruction count exceeded");
+	}
+
+	if (lc->instruction_budget > 0 &&
+	    lc->instruction_count > lc->instruction_budget) {
+		lc->hook_error = LK_LUA_ERROR;
+		LKI_PROBE_INSTRUCTION_LIMIT(iState);
+		luaL_error(iState, "Instruction budget exceeded");
+	}
+
+	if (lc->call_deadline &&
+	    lki_monotonic_time() >= lc->call_deadline) {
+		lc->hook_error = LK_DEADLINE_EXCEEDED;
+		luaL_error(iState, "Deadline exceeded");
+	}
 }
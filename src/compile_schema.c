@@ -0,0 +1,230 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+static bool
+compile_value(lkonf_context * iLc, const lkonf_schema * iSchema);
+
+/**
+ * Compile the matcher for the fields of a LK_SCHEMA_TABLE into
+ * the matchers table at the top of the stack, unless already compiled.
+ * @return False if the schema is invalid; the error is set.
+ */
+static bool
+compile_fields(
+	lkonf_context *		iLc,
+	const lkonf_schema *	iFields,
+	const size_t		iCount)
+{
+	lua_State * L = iLc->state;
+
+	if (! lua_checkstack(L, 6)) {
+		lki_set_error(iLc, LK_RESOURCE_EXHAUSTED, "Too deep");
+		return false;
+	}
+
+#if LUA_VERSION_NUM >= 502
+	lua_rawgetp(L, -1, iFields);				/* S: M m? */
+#else
+	lua_pushlightuserdata(L, (void *)iFields);		/* S: M f */
+	lua_rawget(L, -2);					/* S: M m? */
+#endif
+	const bool compiled = ! lua_isnil(L, -1);
+	lua_pop(L, 1);						/* S: M */
+	if (compiled) {
+		return true;
+	}
+
+	lua_createtable(L, 0, (int)iCount);			/* S: M m */
+#if LUA_VERSION_NUM >= 502
+	lua_pushvalue(L, -1);					/* S: M m m */
+	lua_rawsetp(L, -3, iFields);				/* S: M m */
+#else
+	lua_pushlightuserdata(L, (void *)iFields);		/* S: M m f */
+	lua_pushvalue(L, -2);					/* S: M m f m */
+	lua_rawset(L, -4);					/* S: M m */
+#endif
+
+	int required = 0;
+	size_t i;
+	for (i = 0; i < iCount; ++i) {
+		const lkonf_schema * field = &iFields[i];
+
+		if (! field->name || ! *field->name) {
+			lki_set_error(iLc,
+				LK_INVALID_ARGUMENT, "Schema name empty");
+			return false;
+		}
+
+		lua_pushstring(L, field->name);			/* S: M m k */
+		lua_pushvalue(L, -1);				/* S: M m k k */
+		lua_rawget(L, -3);				/* S: M m k m[k] */
+		if (! lua_isnil(L, -1)) {
+			lki_set_error_item(iLc, LK_INVALID_ARGUMENT,
+				"Duplicate schema name", field->name);
+			return false;
+		}
+		lua_pop(L, 1);					/* S: M m k */
+		lua_pushlightuserdata(L, (void *)field);	/* S: M m k s */
+		lua_rawset(L, -3);				/* S: M m */
+
+		if (field->flags & LK_SCHEMA_REQUIRED) {
+			++required;
+		}
+
+		lua_pushvalue(L, -2);				/* S: M m M */
+		if (! compile_value(iLc, field)) {
+			return false;
+		}
+		lua_pop(L, 1);					/* S: M m */
+	}
+
+	lua_pushinteger(L, required);				/* S: M m n */
+	lua_rawseti(L, -2, 1);					/* S: M m */
+	lua_pop(L, 1);						/* S: M */
+
+	return true;
+}
+
+/**
+ * Compile the matchers for the element of a LK_SCHEMA_ARRAY into
+ * the matchers table at the top of the stack, unless already compiled,
+ * so that an array whose element refers back to it terminates.
+ * The array is keyed by the address of its fields member,
+ * which can't be the address of a fields array.
+ * @return False if the schema is invalid; the error is set.
+ */
+static bool
+compile_element(lkonf_context * iLc, const lkonf_schema * iArray)
+{
+	lua_State * L = iLc->state;
+	const void * key = &iArray->fields;
+
+	if (! lua_checkstack(L, 3)) {
+		lki_set_error(iLc, LK_RESOURCE_EXHAUSTED, "Too deep");
+		return false;
+	}
+
+#if LUA_VERSION_NUM >= 502
+	lua_rawgetp(L, -1, key);				/* S: M c? */
+#else
+	lua_pushlightuserdata(L, (void *)key);			/* S: M a */
+	lua_rawget(L, -2);					/* S: M c? */
+#endif
+	const bool compiled = ! lua_isnil(L, -1);
+	lua_pop(L, 1);						/* S: M */
+	if (compiled) {
+		return true;
+	}
+
+	lua_pushboolean(L, 1);					/* S: M true */
+#if LUA_VERSION_NUM >= 502
+	lua_rawsetp(L, -2, key);				/* S: M */
+#else
+	lua_pushlightuserdata(L, (void *)key);			/* S: M true a */
+	lua_insert(L, -2);					/* S: M a true */
+	lua_rawset(L, -3);					/* S: M */
+#endif
+
+	return compile_value(iLc, iArray->fields);
+}
+
+/**
+ * Check iSchema and compile the matchers it contains into
+ * the matchers table at the top of the stack.
+ * @return False if the schema is invalid; the error is set.
+ */
+static bool
+compile_value(lkonf_context * iLc, const lkonf_schema * iSchema)
+{
+	if (iSchema->flags & ~(LK_SCHEMA_REQUIRED | LK_SCHEMA_RANGE
+	    | LK_SCHEMA_OPEN)) {
+		lki_set_error_item(iLc, LK_INVALID_ARGUMENT,
+			"Invalid schema flags", iSchema->name);
+		return false;
+	}
+
+	switch (iSchema->type) {
+
+	case LK_SCHEMA_ANY:
+	case LK_SCHEMA_BOOLEAN:
+	case LK_SCHEMA_NUMBER:
+	case LK_SCHEMA_INTEGER:
+	case LK_SCHEMA_STRING:
+	case LK_SCHEMA_FUNCTION:
+		return true;
+
+	case LK_SCHEMA_TABLE:
+		if (iSchema->count && ! iSchema->fields) {
+			lki_set_error_item(iLc, LK_INVALID_ARGUMENT,
+				"Schema fields NULL", iSchema->name);
+			return false;
+		}
+		return compile_fields(iLc, iSchema->fields, iSchema->count);
+
+	case LK_SCHEMA_ARRAY:
+		if (1 != iSchema->count || ! iSchema->fields) {
+			lki_set_error_item(iLc, LK_INVALID_ARGUMENT,
+				"Invalid array schema", iSchema->name);
+			return false;
+		}
+		return compile_element(iLc, iSchema);
+
+	}
+
+	lki_set_error_item(iLc, LK_INVALID_ARGUMENT,
+		"Invalid schema type", iSchema->name);
+	return false;
+}
+
+lkonf_error
+lkonf_compile_schema(
+	lkonf_context *		iLc,
+	const lkonf_schema *	iSchema,
+	lkonf_validator **	oValidator)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! oValidator) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValidator NULL");
+		return lki_state_exit(iLc);
+	}
+	*oValidator = 0;
+
+	if (! iSchema) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iSchema NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (LK_SCHEMA_TABLE != iSchema->type
+	    && LK_SCHEMA_ARRAY != iSchema->type) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iSchema not a table");
+		return lki_state_exit(iLc);
+	}
+
+	lua_newtable(iLc->state);				/* S: M */
+	if (! compile_value(iLc, iSchema)) {
+		return lki_state_exit(iLc);
+	}
+
+	lkonf_validator * v = calloc(1, sizeof(*v));
+	if (! v) {
+		lki_set_error(iLc,
+			LK_RESOURCE_EXHAUSTED, "Allocating validator");
+		return lki_state_exit(iLc);
+	}
+	v->lc = iLc;
+	v->schema = iSchema;
+	v->ref = luaL_ref(iLc->state, LUA_REGISTRYINDEX);	/* S: */
+
+	*oValidator = v;
+
+	return lki_state_exit(iLc);
+}
@@ -4,6 +4,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if ! defined(LKONF_LUAJIT)
+/**
+ * Lua allocator; as per luaL_newstate().
+ * The lkonf_context is the userdata, so that hooks can find it.
+ */
+static void *
+state_alloc(void * iUd, void * iPtr, size_t iOsize, size_t iNsize)
+{
+	(void)iUd;	/* UNUSED */
+	(void)iOsize;	/* UNUSED */
+
+	if (0 == iNsize) {
+		free(iPtr);
+		return 0;
+	}
+
+	return realloc(iPtr, iNsize);
+}
+#endif
+
+/**
+ * Lua panic function; as per luaL_newstate().
+ */
+static int
+state_panic(lua_State * iState)
+{
+	fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n",
+		lua_tostring(iState, -1));
+	return 0;
+}
+
 lkonf_context *
 lkonf_construct(void)
 {
@@ -16,14 +47,40 @@ lkonf_construct(void)
 // TODO set default lc->instruction_limit ?
 
 	lki_reset_error(lc);
+	lc->generation = 1;
+	lc->sort_cache = LUA_NOREF;
+	lc->load_anchors = LUA_NOREF;
 
+#if defined(LKONF_LUAJIT)
+		/*
+		 * LuaJIT doesn't support lua_newstate() on some 64-bit targets,
+		 * so the hooks find the lkonf_context in the registry instead.
+		 */
 	lc->state = luaL_newstate();
+#else
+	lc->state = lua_newstate(&state_alloc, lc);
+#endif
 	if (! lc->state) {
-		lc->error_code = LK_INVALID_ARGUMENT;
-		snprintf(
-			lc->error_string, sizeof(lc->error_string),
-			"Can't allocate lua state");
+		lki_set_error(lc,
+			LK_INVALID_ARGUMENT, "Can't allocate lua state");
+		return lc;
 	}
 
+#if defined(LKONF_LUAJIT)
+	lua_pushlightuserdata(lc->state, lc);
+	lua_setfield(lc->state, LUA_REGISTRYINDEX, LKI_CONTEXT);
+#endif
+
+	lua_atpanic(lc->state, &state_panic);
+	lki_update_hook(lc);
+
+#if LUA_VERSION_NUM >= 504
+		/*
+		 * A loaded config is mostly long-lived tables, with short-lived
+		 * garbage from function-valued keys; that suits generational GC.
+		 */
+	lua_gc(lc->state, LUA_GCGEN, 0, 0);
+#endif
+
 	return lc;
 }
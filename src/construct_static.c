@@ -0,0 +1,25 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+lkonf_context *
+lkonf_construct_static(const lkonf_static_node * iRoot)
+{
+	if (! iRoot || LK_TYPE_TABLE != iRoot->value.type) {
+		return 0;
+	}
+
+	lkonf_context * lc = calloc(1, sizeof(*lc));
+	if (! lc) {
+		return 0;
+	}
+
+	lki_reset_error(lc);
+	lc->generation = 1;
+	lc->sort_cache = LUA_NOREF;
+	lc->load_anchors = LUA_NOREF;
+	lc->baked = iRoot;
+
+	return lc;
+}
@@ -29,6 +29,13 @@ lkonf_copy_table_keys(
 			LK_OUT_OF_RANGE, "iDstIdx not a table");
 	}
 
+	if (lki_is_sealed(iLc->state, iDstIdx)) {
+		return lki_set_error(iLc,
+			LK_OUT_OF_RANGE, "iDstIdx sealed");
+	}
+
+	lki_cache_invalidate(iLc);
+
 	size_t ki;
 	for (ki = 1; 0 != iKeys[ki]; ++ki) {
 		lua_getfield(iLc->state, iSrcIdx, iKeys[ki]);
@@ -14,5 +14,6 @@ lkonf_destruct(lkonf_context * iLc)
 		iLc->state = 0;
 	}
 
+	lki_cache_free(iLc);
 	free(iLc);
 }
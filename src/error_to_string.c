@@ -10,6 +10,8 @@ lkonf_error_to_string(const lkonf_error iError)
 		case LK_NOT_FOUND:		return "Not found";
 		case LK_RESOURCE_EXHAUSTED:	return "Resource exhausted";
 		case LK_OUT_OF_RANGE:		return "Out of range";
+		case LK_DEADLINE_EXCEEDED:	return "Deadline exceeded";
+		case LK_INTERRUPTED:		return "Interrupted";
 	}
 
 	return "";
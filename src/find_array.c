@@ -0,0 +1,35 @@
+#include "internal.h"
+
+lkonf_error
+lki_find_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const size_t	iCapacity,
+	const bool	iBuffer,
+	size_t *	oLength)
+{
+	lki_value value;
+	if (LK_OK != lki_lookup_path(iLc, iPath, &value)) {
+		return iLc->error_code;
+	}
+
+	if (LUA_TTABLE != value.type) {
+		return lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Not a table", iPath);
+	}
+							/* S: t */
+	lki_push_storage(iLc->state, -1);		/* S: t s */
+
+#if LUA_VERSION_NUM >= 502
+	*oLength = lua_rawlen(iLc->state, -1);
+#else
+	*oLength = lua_objlen(iLc->state, -1);
+#endif
+
+	if (iBuffer && *oLength > iCapacity) {
+		return lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Array longer than buffer", iPath);
+	}
+
+	return LK_OK;
+}
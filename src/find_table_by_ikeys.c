@@ -0,0 +1,55 @@
+#include "internal.h"
+
+lkonf_error
+lki_find_table_by_ikeys(lkonf_context * iLc, lkonf_ikeys iKeys)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (! iKeys) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iKeys NULL");
+	}
+
+	if (LK_KEY_END == iKeys[0].type) {
+		return lki_set_error(iLc, LK_OUT_OF_RANGE, "Empty keys");
+	}
+
+		/* Push globals table onto stack. */
+	lki_push_globals(iLc->state);		/* S: t */
+
+		/* Iterate through keys until LK_KEY_END. */
+	size_t ki;
+	for (ki = 0; LK_KEY_END != iKeys[ki].type; ++ki) {
+		if (! lua_istable(iLc->state, -1)) {
+			return lki_set_error_ikeys(iLc,
+				LK_OUT_OF_RANGE, "Not a table", iKeys, ki);
+		}
+
+		switch (iKeys[ki].type) {
+
+		case LK_KEY_NAME:
+			if (! iKeys[ki].name) {
+				return lki_set_error(iLc,
+					LK_INVALID_ARGUMENT, "Key name NULL");
+			}
+			if (! ki && ! iKeys[ki].name[0]) {
+				return lki_set_error(iLc,
+					LK_OUT_OF_RANGE, "Empty top-level key");
+			}
+			lua_pushstring(iLc->state, iKeys[ki].name);
+			lki_get_field(iLc);		/* S: t[k] */
+			break;
+
+		case LK_KEY_INDEX:
+			lki_get_index(iLc, iKeys[ki].index);
+			break;				/* S: t[n] */
+
+		default:
+			return lki_set_error(iLc,
+				LK_INVALID_ARGUMENT, "Invalid key type");
+		}
+	}
+
+	return LK_OK;
+}
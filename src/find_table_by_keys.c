@@ -21,16 +21,11 @@ lki_find_table_by_keys(lkonf_context * iLc, lkonf_keys iKeys, size_t * oMatch)
 	}
 
 		/* Push globals table onto stack. */
-#if LUA_VERSION_NUM >= 502
-	lua_pushglobaltable(iLc->state);		/* S: t */
-#else
-	lua_pushvalue(iLc->state, LUA_GLOBALSINDEX);	/* S: t */
-#endif
+	lki_push_globals(iLc->state);		/* S: t */
 
 		/* Push first key. */
-	lua_pushstring(iLc->state, iKeys[0]);
-	lua_gettable(iLc->state, -2);			/* S: t t[k] */
-	lua_remove(iLc->state, -2);			/* S: t[k] */
+	lua_pushstring(iLc->state, iKeys[0]);		/* S: t k */
+	lki_get_field(iLc);				/* S: t[k] */
 
 		/* Iterate through remaining keys until NULL key. */
 	size_t ki;
@@ -41,8 +36,7 @@ lki_find_table_by_keys(lkonf_context * iLc, lkonf_keys iKeys, size_t * oMatch)
 		}
 
 		lua_pushstring(iLc->state, iKeys[ki]);	/* S: t[k] k2 */
-		lua_gettable(iLc->state, -2);		/* S: t[k] t[k][k2] */
-		lua_remove(iLc->state, -2);		/* S: t[k][k2] */
+		lki_get_field(iLc);			/* S: t[k][k2] */
 	}
 
 	if (oMatch) {
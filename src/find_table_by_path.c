@@ -1,40 +1,89 @@
 #include "internal.h"
 
 #include <assert.h>
-#include <stdio.h>
+#include <limits.h>
 #include <string.h>
 
+bool
+lki_parse_index(const char * iStr, size_t iLen, int * oIndex)
+{
+	if (! iLen) {
+		return false;
+	}
+
+	int n = 0;
+	size_t i;
+	for (i = 0; i < iLen; ++i) {
+		if (iStr[i] < '0' || iStr[i] > '9') {
+			return false;
+		}
+		const int d = iStr[i] - '0';
+		if (n > (INT_MAX - d) / 10) {
+			return false;
+		}
+		n = n * 10 + d;
+	}
+
+	*oIndex = n;
+	return true;
+}
+
+
 /**
- * Push next key to stack.
- * If next key is empty, no key is pushed.
+ * Replace the table at the top of the stack with the value at the next key.
+ * A key of "[n]" is integer n.
+ * A key of "n" is integer n if present, otherwise string "n".
  * @param	iLc	lkonf_context
- * @param	iPath	Pointer to key path to parse ("a.bb.c")
- * Returns		Pointer to end of key.
+ * @param	iPath	Pointer to key path to parse ("a.bb[3].c")
+ * Returns		Pointer to end of key, or 0 if the key is invalid.
  */
 static const char *
-push_next_key(lkonf_context * iLc, const char * iPath)
+get_next_key(lkonf_context * iLc, const char * iPath)
 {
 	assert(iLc);
 	assert(iPath);
 
+	int index;
+
+	if ('[' == *iPath) {
+		const char * end = strchr(iPath, ']');
+		if (! end
+		    || ! lki_parse_index(iPath + 1, end - iPath - 1, &index)
+		    || (end[1] && ! strchr(".[", end[1]))) {
+			return 0;
+		}
+		lki_get_index(iLc, index);	/* S: t[n] */
+		return end + 1;
+	}
+
 	if ('.' == *iPath) {
 		++iPath;
 	}
 
-	const size_t len = strcspn(iPath, ".");
+	const size_t len = strcspn(iPath, ".[");
 	if (!len) {
 		return 0;
 	}
-	if (len) {
-		lua_pushlstring(iLc->state, iPath, len);
+
+	if (lki_parse_index(iPath, len, &index)) {
+		lua_pushvalue(iLc->state, -1);		/* S: t t */
+		lki_get_index(iLc, index);	/* S: t t[n] */
+		if (! lua_isnil(iLc->state, -1)) {
+			lua_remove(iLc->state, -2);	/* S: t[n] */
+			return iPath + len;
+		}
+		lua_pop(iLc->state, 1);			/* S: t */
 	}
 
+	lua_pushlstring(iLc->state, iPath, len);	/* S: t k */
+	lki_get_field(iLc);				/* S: t[k] */
+
 	return iPath + len;
 }
 
 
 lkonf_error
-lki_find_table_by_path(lkonf_context * iLc, const char * iPath)
+lki_walk_path(lkonf_context * iLc, const char * iPath)
 {
 	if (! iLc) {
 		return LK_INVALID_ARGUMENT;
@@ -53,42 +102,52 @@ lki_find_table_by_path(lkonf_context * iLc, const char * iPath)
 			LK_OUT_OF_RANGE, "Empty component in", iPath);
 	}
 
-		/* Push globals table onto stack. */
-#if LUA_VERSION_NUM >= 502
-	lua_pushglobaltable(iLc->state);		/* S: t */
-#else
-	lua_pushvalue(iLc->state, LUA_GLOBALSINDEX);	/* S: t */
-#endif
-
-		/* Push first key. */
-	const char * end = push_next_key(iLc, iPath);	/* S: t k */
+		/* Replace with value at first key. */
+	const char * end = get_next_key(iLc, iPath);	/* S: t[k] */
 	if (! end) {
 		return lki_set_error_item(iLc,
-			LK_OUT_OF_RANGE, "Empty component in", iPath);
+			LK_OUT_OF_RANGE,
+			'[' == *iPath ? "Invalid index in" : "Empty component in",
+			iPath);
 	}
 
-	lua_gettable(iLc->state, -2);			/* S: t t[k] */
-	lua_remove(iLc->state, -2);			/* S: t[k] */
-
-		/* Iterate through remaining keys until EOS or empty key. */
+		/* Iterate through remaining keys until EOS or invalid key. */
 	while (*end) {
 		if (! lua_istable(iLc->state, -1)) {
-			char path[sizeof(iLc->error_string)];
-			snprintf(path, sizeof(path), "%.*s",
-				(int)(end - iPath), iPath);
-			return lki_set_error_item(iLc,
-				LK_OUT_OF_RANGE, "Not a table", path);
+			return lki_set_error_litem(iLc,
+				LK_OUT_OF_RANGE, "Not a table",
+				iPath, end - iPath);
 		}
 
-		end = push_next_key(iLc, end);		/* S: t[k] k2 */
-		if (! end) {
+		const char * next = get_next_key(iLc, end); /* S: t[k][k2] */
+		if (! next) {
 			return lki_set_error_item(iLc,
-				LK_OUT_OF_RANGE, "Empty component in", iPath);
+				LK_OUT_OF_RANGE,
+				'[' == *end ? "Invalid index in"
+					    : "Empty component in",
+				iPath);
 		}
-
-		lua_gettable(iLc->state, -2);		/* S: t[k] t[k][k2] */
-		lua_remove(iLc->state, -2);		/* S: t[k][k2] */
+		end = next;
 	}
 
 	return LK_OK;
 }
+
+
+lkonf_error
+lki_find_table_by_path(lkonf_context * iLc, const char * iPath)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (iPath && '[' == *iPath) {
+		return lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Invalid index in", iPath);
+	}
+
+		/* Push globals table onto stack. */
+	lki_push_globals(iLc->state);		/* S: t */
+
+	return lki_walk_path(iLc, iPath);			/* S: t[k]... */
+}
@@ -34,3 +34,38 @@ lki_format_keys(
 
 	return LK_OK;
 }
+
+lkonf_error
+lki_format_ikeys(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	size_t		iMaxKeys)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	luaL_Buffer lb;
+	luaL_buffinit(iLc->state, &lb);
+
+	size_t ki;
+	for (ki = 0; LK_KEY_END != iKeys[ki].type; ++ki) {
+		if (iMaxKeys && ki >= iMaxKeys) {
+			break;
+		}
+		if (LK_KEY_INDEX == iKeys[ki].type) {
+			char buf[16];
+			snprintf(buf, sizeof(buf), "[%d]", iKeys[ki].index);
+			luaL_addstring(&lb, buf);
+			continue;
+		}
+		if (ki) {
+			luaL_addstring(&lb, ".");
+		}
+		luaL_addstring(&lb, iKeys[ki].name);
+	}
+
+	luaL_pushresult(&lb);
+
+	return LK_OK;
+}
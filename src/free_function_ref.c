@@ -0,0 +1,18 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+void
+lkonf_free_function_ref(lkonf_function_ref * iRef)
+{
+	if (! iRef) {
+		return;
+	}
+
+	if (iRef->lc && iRef->lc->state) {
+		luaL_unref(iRef->lc->state, LUA_REGISTRYINDEX, iRef->ref);
+	}
+
+	free(iRef);
+}
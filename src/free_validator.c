@@ -0,0 +1,19 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+void
+lkonf_free_validator(lkonf_validator * iValidator)
+{
+	if (! iValidator) {
+		return;
+	}
+
+	if (iValidator->lc && iValidator->lc->state) {
+		luaL_unref(iValidator->lc->state,
+			LUA_REGISTRYINDEX, iValidator->ref);
+	}
+
+	free(iValidator);
+}
@@ -0,0 +1,239 @@
+#include "internal.h"
+
+#include <stdio.h>
+
+/**
+ * Store the fallback value of iCol in row iRow of iColumn.
+ */
+static void
+store_fallback(
+	const lkonf_column_spec *	iCol,
+	void *				iColumn,
+	const size_t			iRow)
+{
+	switch (iCol->type) {
+	case LK_COLUMN_BOOLEAN:
+		((bool *)iColumn)[iRow] = iCol->fallback.boolean;
+		break;
+	case LK_COLUMN_INTEGER:
+		((lua_Integer *)iColumn)[iRow] = iCol->fallback.integer;
+		break;
+	case LK_COLUMN_DOUBLE:
+		((double *)iColumn)[iRow] = iCol->fallback.number;
+		break;
+	case LK_COLUMN_STRING:
+		((const char **)iColumn)[iRow] = iCol->fallback.string;
+		break;
+	}
+}
+
+/**
+ * Store the fallback values of all iNumCols columns in row iRow.
+ */
+static void
+store_fallbacks(
+	const lkonf_column_spec *	iCols,
+	const size_t			iNumCols,
+	void * const *			iColumns,
+	const size_t			iRow)
+{
+	size_t c;
+	for (c = 0; c < iNumCols; ++c) {
+		store_fallback(&iCols[c], iColumns[c], iRow);
+	}
+}
+
+/**
+ * Store the value at the top of the stack in row iRow of iColumn.
+ * @return False if the value is of the wrong type.
+ */
+static bool
+store_value(
+	lua_State *			iState,
+	const lkonf_column_spec *	iCol,
+	void *				iColumn,
+	const size_t			iRow)
+{
+	const int type = lua_type(iState, -1);
+
+	switch (iCol->type) {
+	case LK_COLUMN_BOOLEAN:
+		if (LUA_TBOOLEAN != type) {
+			return false;
+		}
+		((bool *)iColumn)[iRow] = lua_toboolean(iState, -1);
+		return true;
+	case LK_COLUMN_INTEGER:
+		return LUA_TNUMBER == type && lki_to_integer(iState, -1,
+			&((lua_Integer *)iColumn)[iRow]);
+	case LK_COLUMN_DOUBLE:
+		if (LUA_TNUMBER != type) {
+			return false;
+		}
+		((double *)iColumn)[iRow] = lua_tonumber(iState, -1);
+		return true;
+	case LK_COLUMN_STRING:
+		if (LUA_TSTRING != type) {
+			return false;
+		}
+		((const char **)iColumn)[iRow] = lua_tostring(iState, -1);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Record an error in row iRow, optionally for field iField.
+ * @return True to continue with the next row.
+ */
+static bool
+row_error(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iPath,
+	const size_t		iRow,
+	const char *		iField,
+	lkonf_error *		oRowErrors,
+	size_t *		oRows)
+{
+	if (oRowErrors) {
+		if (LK_OK == oRowErrors[iRow]) {
+			oRowErrors[iRow] = iCode;
+		}
+		return true;
+	}
+
+	char item[128];
+	snprintf(item, sizeof(item), "%s[%zu]%s%s",
+		iPath, iRow + 1, iField ? "." : "", iField ? iField : "");
+	lki_set_error_item(iLc, iCode, iString, item);
+	*oRows = iRow + 1;
+	return false;
+}
+
+lkonf_error
+lkonf_get_columns(
+	lkonf_context *			iLc,
+	const char *			iPath,
+	const lkonf_column_spec *	iCols,
+	const size_t			iNumCols,
+	void * const *			oColumns,
+	size_t *			ioRows,
+	lkonf_error *			oRowErrors)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+
+	if (! iCols && iNumCols) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iCols NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+
+	if (! ioRows) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "ioRows NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+
+	size_t c;
+	for (c = 0; c < iNumCols; ++c) {
+		if (! iCols[c].name) {
+			lki_set_error(iLc,
+				LK_INVALID_ARGUMENT, "Column name NULL");
+			return lki_lookup_exit(iLc, iPath, 0, "columns");
+		}
+		if (oColumns && ! oColumns[c]) {
+			lki_set_error(iLc,
+				LK_INVALID_ARGUMENT, "Column buffer NULL");
+			return lki_lookup_exit(iLc, iPath, 0, "columns");
+		}
+	}
+
+	size_t rows = 0;
+	if (LK_OK != lki_find_array(iLc, iPath, *ioRows, 0 != oColumns, &rows)) {
+		if (rows > *ioRows) {
+			*ioRows = rows;
+		}
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+							/* S: t s */
+	if (! oColumns) {
+		*ioRows = rows;
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+
+	if (! lua_checkstack(iLc->state, (int)iNumCols + 4)) {
+		lki_set_error(iLc, LK_RESOURCE_EXHAUSTED, "Too many columns");
+		return lki_lookup_exit(iLc, iPath, 0, "columns");
+	}
+
+		/* Anchor the array, for strings. */
+	lki_anchor(iLc, -1, iPath);
+
+		/* Push the column names once. */
+	const int names = lua_gettop(iLc->state) + 1;
+	for (c = 0; c < iNumCols; ++c) {
+		lua_pushstring(iLc->state, iCols[c].name);
+	}						/* S: t s names... */
+
+	size_t r;
+	for (r = 0; r < rows; ++r) {
+		if (oRowErrors) {
+			oRowErrors[r] = LK_OK;
+		}
+
+		lua_rawgeti(iLc->state, names - 1, (int)(r + 1));
+		if (! lua_istable(iLc->state, -1)) {	/* S: ... rec */
+			lua_pop(iLc->state, 1);
+			store_fallbacks(iCols, iNumCols, oColumns, r);
+			if (! row_error(iLc, LK_OUT_OF_RANGE, "Not a table",
+			    iPath, r, 0, oRowErrors, ioRows)) {
+				return lki_lookup_exit(iLc,
+					iPath, 0, "columns");
+			}
+			continue;
+		}
+		lki_push_storage(iLc->state, -1);	/* S: ... rec recs */
+		lua_remove(iLc->state, -2);		/* S: ... recs */
+
+		lkonf_error code = LK_OK;
+		for (c = 0; c < iNumCols; ++c) {
+			lua_pushvalue(iLc->state, names + (int)c);
+			lua_rawget(iLc->state, -2);	/* S: ... recs v */
+			if (lua_isnil(iLc->state, -1)) {
+				store_fallback(&iCols[c], oColumns[c], r);
+				if (iCols[c].required) {
+					code = LK_NOT_FOUND;
+				}
+			} else if (! store_value(iLc->state,
+			    &iCols[c], oColumns[c], r)) {
+				code = LK_OUT_OF_RANGE;
+			}
+			lua_pop(iLc->state, 1);		/* S: ... recs */
+			if (LK_OK != code) {
+				break;
+			}
+		}
+		lua_pop(iLc->state, 1);			/* S: t s names... */
+
+			/* A record with an error gets all the fallbacks. */
+		if (LK_OK != code) {
+			store_fallbacks(iCols, iNumCols, oColumns, r);
+			if (! row_error(iLc, code,
+			    LK_NOT_FOUND == code ? "Missing" : "Wrong type",
+			    iPath, r, iCols[c].name, oRowErrors, ioRows)) {
+				return lki_lookup_exit(iLc,
+					iPath, 0, "columns");
+			}
+		}
+	}
+
+	*ioRows = rows;
+
+	return lki_lookup_exit(iLc, iPath, 0, "columns");
+}
@@ -0,0 +1,11 @@
+#include "internal.h"
+
+uint64_t
+lkonf_get_deadline(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return 0;
+	}
+
+	return iLc->deadline;
+}
@@ -0,0 +1,50 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_get_double_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	double *	oValues,
+	size_t *	ioLen)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "double_array");
+	}
+
+	if (! ioLen) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "ioLen NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "double_array");
+	}
+
+	size_t len = 0;
+	if (LK_OK != lki_find_array(iLc, iPath, *ioLen, 0 != oValues, &len)) {
+		if (len > *ioLen) {
+			*ioLen = len;
+		}
+		return lki_lookup_exit(iLc, iPath, 0, "double_array");
+	}
+							/* S: t s */
+	if (oValues) {
+		size_t i;
+		for (i = 0; i < len; ++i) {
+			lua_rawgeti(iLc->state, -1, (int)(i + 1));
+			if (LUA_TNUMBER != lua_type(iLc->state, -1)) {
+				*ioLen = i + 1;
+				lki_set_error_index(iLc,
+					LK_OUT_OF_RANGE, "Not a double", iPath, i + 1);
+				return lki_lookup_exit(iLc,
+					iPath, 0, "double_array");
+			}
+			oValues[i] = lua_tonumber(iLc->state, -1);
+			lua_pop(iLc->state, 1);
+		}
+	}
+
+	*ioLen = len;
+
+	return lki_lookup_exit(iLc, iPath, 0, "double_array");
+}
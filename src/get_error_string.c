@@ -1,5 +1,52 @@
 #include "internal.h"
 
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Format the error message and item into error_string.
+ */
+static void
+format_error(lkonf_context * iLc)
+{
+	char *		buf = iLc->error_string;
+	const size_t	buflen = sizeof(iLc->error_string);
+	size_t		len = 0;
+
+	buf[0] = '\0';
+
+	if (iLc->error_message) {
+		len = snprintf(buf, buflen, "%s%s", iLc->error_message,
+			LKI_ITEM_NONE == iLc->error_item_type ? "" : ": ");
+	}
+
+	switch (iLc->error_item_type) {
+
+	case LKI_ITEM_NONE:
+		break;
+
+	case LKI_ITEM_STRING:
+		if (len < buflen) {
+			snprintf(buf + len, buflen - len, "%s", iLc->error_item);
+		}
+		break;
+
+	case LKI_ITEM_KEYS: {
+		const char *	key = iLc->error_item;
+		size_t		ki;
+		for (ki = 0; ki < iLc->error_item_keys && len < buflen; ++ki) {
+			len += snprintf(buf + len, buflen - len, "%s\"%s\"",
+				ki ? "." : "", key);
+			key += strlen(key) + 1;
+		}
+		break;
+	}
+
+	}
+
+	iLc->error_formatted = true;
+}
+
 const char *
 lkonf_get_error_string(lkonf_context * iLc)
 {
@@ -7,5 +54,9 @@ lkonf_get_error_string(lkonf_context * iLc)
 		return 0;
 	}
 
+	if (! iLc->error_formatted) {
+		format_error(iLc);
+	}
+
 	return iLc->error_string;
 }
@@ -0,0 +1,11 @@
+#include "internal.h"
+
+void
+lki_get_field(lkonf_context * iLc)
+{
+	lua_State * L = iLc->state;
+							/* S: t k */
+	lua_gettable(L, -2);				/* S: t t[k] */
+	iLc->raw_miss = lua_isnil(L, -1) && ! lki_has_index(L, -2);
+	lua_remove(L, -2);				/* S: t[k] */
+}
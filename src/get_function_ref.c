@@ -0,0 +1,60 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+lkonf_error
+lkonf_get_function_ref(
+	lkonf_context *		iLc,
+	const char *		iPath,
+	lkonf_function_ref **	oRef)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! oRef) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oRef NULL");
+		return lki_state_exit(iLc);
+	}
+	*oRef = 0;
+
+	if (LK_OK != lki_find_table_by_path(iLc, iPath)) {	/* S: f */
+		return lki_state_exit(iLc);
+	}
+
+	if (lua_isnil(iLc->state, -1)) {
+		lki_set_error(iLc, LK_NOT_FOUND, "");
+		return lki_state_exit(iLc);
+	}
+
+	if (! lua_isfunction(iLc->state, -1)) {
+		lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Not a function", iPath);
+		return lki_state_exit(iLc);
+	}
+
+	const size_t len = strlen(iPath);
+	lkonf_function_ref * fr = calloc(1, sizeof(*fr) + len + 1);
+	if (! fr) {
+		lki_set_error(iLc,
+			LK_RESOURCE_EXHAUSTED, "Allocating function ref");
+		return lki_state_exit(iLc);
+	}
+	fr->lc = iLc;
+	memcpy(fr->path, iPath, len + 1);
+
+	lua_createtable(iLc->state, 1, 0);			/* S: f st */
+	lua_insert(iLc->state, -2);				/* S: st f */
+	lua_rawseti(iLc->state, -2, 1);				/* S: st */
+	fr->ref = luaL_ref(iLc->state, LUA_REGISTRYINDEX);	/* S: */
+
+	*oRef = fr;
+
+	return lki_state_exit(iLc);
+}
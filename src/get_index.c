@@ -0,0 +1,17 @@
+#include "internal.h"
+
+void
+lki_get_index(lkonf_context * iLc, const int iIndex)
+{
+	lua_State * L = iLc->state;
+							/* S: t */
+	lua_rawgeti(L, -1, iIndex);			/* S: t t[n] */
+	if (lua_isnil(L, -1) && lua_getmetatable(L, -2)) {
+			/* Not in t; try __index, e.g. if sealed. */
+		lua_pop(L, 2);				/* S: t */
+		lua_pushinteger(L, iIndex);		/* S: t n */
+		lua_gettable(L, -2);			/* S: t t[n] */
+	}
+	iLc->raw_miss = lua_isnil(L, -1) && ! lki_has_index(L, -2);
+	lua_remove(L, -2);				/* S: t[n] */
+}
@@ -0,0 +1,11 @@
+#include "internal.h"
+
+long
+lkonf_get_instruction_budget(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return -1;
+	}
+
+	return iLc->instruction_budget;
+}
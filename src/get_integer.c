@@ -7,38 +7,27 @@ lkonf_get_integer(lkonf_context * iLc, const char * iPath, lua_Integer * oValue)
 		return LK_INVALID_ARGUMENT;
 	}
 
-	if (LK_OK != lki_state_entry(iLc)) {
-		return lki_state_exit(iLc);
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "integer");
 	}
 
 	if (! oValue) {
 		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, iPath, 0, "integer");
 	}
 
-	if (LK_OK != lki_find_table_by_path(iLc, iPath)) {
-		return lki_state_exit(iLc);
+	lki_value value;
+	if (LK_OK != lki_lookup_path(iLc, iPath, &value)) {
+		return lki_lookup_exit(iLc, iPath, 0, "integer");
 	}
 
-	if (lua_isfunction(iLc->state, -1)) {
-		lua_pushstring(iLc->state, iPath);
-		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
-			return lki_state_exit(iLc);
-		}
-	}
-
-	if (LUA_TNIL == lua_type(iLc->state, -1)) {
-		lki_set_error(iLc, LK_NOT_FOUND, "");
-		return lki_state_exit(iLc);
-	}
-
-	if (LUA_TNUMBER != lua_type(iLc->state, -1)) {
+	if (LUA_TNUMBER != value.type || ! value.integral) {
 		lki_set_error_item(iLc,
 			LK_OUT_OF_RANGE, "Not an integer", iPath);
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, iPath, 0, "integer");
 	}
 
-	*oValue = lua_tointeger(iLc->state, -1);
+	*oValue = value.integer;
 
-	return lki_state_exit(iLc);
+	return lki_lookup_exit(iLc, iPath, 0, "integer");
 }
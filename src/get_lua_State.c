@@ -8,5 +8,9 @@ lkonf_get_lua_State(lkonf_context * iLc)
 	}
 
 	lki_reset_error(iLc);
+
+		/* The caller may modify the state. */
+	lki_cache_invalidate(iLc);
+
 	return iLc->state;
 }
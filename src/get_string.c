@@ -14,49 +14,37 @@ lkonf_get_string(
 		return LK_INVALID_ARGUMENT;
 	}
 
-	if (LK_OK != lki_state_entry(iLc)) {
-		return lki_state_exit(iLc);
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "string");
 	}
 
 	if (! oValue) {
 		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, iPath, 0, "string");
 	}
 
-	if (LK_OK != lki_find_table_by_path(iLc, iPath)) {
-		return lki_state_exit(iLc);
+	lki_value value;
+	if (LK_OK != lki_lookup_path(iLc, iPath, &value)) {
+		return lki_lookup_exit(iLc, iPath, 0, "string");
 	}
 
-	if (lua_isfunction(iLc->state, -1)) {
-		lua_pushstring(iLc->state, iPath);
-		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
-			return lki_state_exit(iLc);
-		}
-	}
-
-	if (LUA_TNIL == lua_type(iLc->state, -1)) {
-		lki_set_error(iLc, LK_NOT_FOUND, "");
-		return lki_state_exit(iLc);
-	}
-
-	if (LUA_TSTRING != lua_type(iLc->state, -1)) {
+	if (LUA_TSTRING != value.type) {
 		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Not a string", iPath);
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, iPath, 0, "string");
 	}
 
-	size_t len = 0;
-	const char * result = lua_tolstring(iLc->state, -1, &len);
-
-	char * copy = malloc(len + 1);
+	char * copy = malloc(value.length + 1);
 	if (! copy) {
 		lki_set_error_item(iLc, LK_RESOURCE_EXHAUSTED,
 			"Copying string result for", iPath);
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, iPath, 0, "string");
 	}
-	memcpy(copy, result, len + 1);
+	memcpy(copy, value.string, value.length + 1);
 
 	*oValue = copy;
-	*oLen = len;
+	if (oLen) {
+		*oLen = value.length;
+	}
 
-	return lki_state_exit(iLc);
+	return lki_lookup_exit(iLc, iPath, 0, "string");
 }
@@ -0,0 +1,45 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_get_string_ref(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const char **	oValue,
+	size_t *	oLen)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "string");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "string");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_path(iLc, iPath, &value)) {
+		return lki_lookup_exit(iLc, iPath, 0, "string");
+	}
+
+	if (LUA_TSTRING != value.type) {
+		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Not a string", iPath);
+		return lki_lookup_exit(iLc, iPath, 0, "string");
+	}
+
+		/* The string is on the stack unless baked; keep it alive
+		 * until the next load or lookup of iPath. */
+	if (iLc->state) {
+		lki_anchor(iLc, -1, iPath);
+	}
+
+	*oValue = value.string;
+	if (oLen) {
+		*oLen = value.length;
+	}
+
+	return lki_lookup_exit(iLc, iPath, 0, "string");
+}
@@ -0,0 +1,11 @@
+#include "internal.h"
+
+long
+lkonf_get_time_limit(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return -1;
+	}
+
+	return iLc->time_limit;
+}
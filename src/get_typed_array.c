@@ -0,0 +1,55 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_get_typed_array(
+	lkonf_context *		iLc,
+	const char *		iPath,
+	lkonf_array_type *	oType,
+	const void **		oData,
+	size_t *		oLen)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+
+	if (! oType) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oType NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+
+	if (! oData) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oData NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+
+	if (! oLen) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oLen NULL");
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_path(iLc, iPath, &value)) {
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+							/* S: ud */
+	lki_typed_array * ta = LUA_TUSERDATA == value.type
+	    ? lki_to_typed_array(iLc->state, -1) : 0;
+	if (! ta) {
+		lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Not a typed array", iPath);
+		return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+	}
+
+		/* Anchor until the next load, in case the config changes. */
+	lki_anchor(iLc, -1, iPath);
+
+	*oType = ta->type;
+	*oData = ta->data;
+	*oLen = ta->length;
+
+	return lki_lookup_exit(iLc, iPath, 0, "typed_array");
+}
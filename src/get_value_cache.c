@@ -0,0 +1,11 @@
+#include "internal.h"
+
+bool
+lkonf_get_value_cache(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return false;
+	}
+
+	return iLc->value_cache;
+}
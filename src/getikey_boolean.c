@@ -0,0 +1,33 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_getikey_boolean(lkonf_context * iLc, lkonf_ikeys iKeys, bool * oValue)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, 0, "boolean");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, 0, 0, "boolean");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_ikeys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, 0, "boolean");
+	}
+
+	if (LUA_TBOOLEAN != value.type) {
+		lki_set_error_ikeys(iLc,
+			LK_OUT_OF_RANGE, "Not a boolean", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "boolean");
+	}
+
+	*oValue = value.boolean;
+
+	return lki_lookup_exit(iLc, 0, 0, "boolean");
+}
@@ -0,0 +1,33 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_getikey_double(lkonf_context * iLc, lkonf_ikeys iKeys, double * oValue)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, 0, "double");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, 0, 0, "double");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_ikeys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, 0, "double");
+	}
+
+	if (LUA_TNUMBER != value.type) {
+		lki_set_error_ikeys(iLc,
+			LK_OUT_OF_RANGE, "Not a double", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "double");
+	}
+
+	*oValue = value.number;
+
+	return lki_lookup_exit(iLc, 0, 0, "double");
+}
@@ -0,0 +1,33 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_getikey_integer(lkonf_context * iLc, lkonf_ikeys iKeys, lua_Integer * oValue)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, 0, "integer");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, 0, 0, "integer");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_ikeys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, 0, "integer");
+	}
+
+	if (LUA_TNUMBER != value.type || ! value.integral) {
+		lki_set_error_ikeys(iLc,
+			LK_OUT_OF_RANGE, "Not an integer", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "integer");
+	}
+
+	*oValue = value.integer;
+
+	return lki_lookup_exit(iLc, 0, 0, "integer");
+}
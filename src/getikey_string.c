@@ -0,0 +1,52 @@
+#include "internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+lkonf_error
+lkonf_getikey_string(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	char **		oValue,
+	size_t *	oLen)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_ikeys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	if (LUA_TSTRING != value.type) {
+		lki_set_error_ikeys(iLc,
+			LK_OUT_OF_RANGE, "Not a string", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	char * copy = malloc(value.length + 1);
+	if (! copy) {
+		lki_set_error_ikeys(iLc,
+			LK_RESOURCE_EXHAUSTED,
+			"Copying string result for", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+	memcpy(copy, value.string, value.length + 1);
+
+	*oValue = copy;
+	if (oLen) {
+		*oLen = value.length;
+	}
+
+	return lki_lookup_exit(iLc, 0, 0, "string");
+}
@@ -0,0 +1,46 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_getikey_string_ref(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	const char **	oValue,
+	size_t *	oLen)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	if (! oValue) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	lki_value value;
+	if (LK_OK != lki_lookup_ikeys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+	if (LUA_TSTRING != value.type) {
+		lki_set_error_ikeys(iLc,
+			LK_OUT_OF_RANGE, "Not a string", iKeys, 0);
+		return lki_lookup_exit(iLc, 0, 0, "string");
+	}
+
+		/* The string is on the stack unless baked; keep it alive
+		 * until the next load or lookup of iKeys. */
+	if (iLc->state) {
+		lki_anchor_ikeys(iLc, -1, iKeys);
+	}
+
+	*oValue = value.string;
+	if (oLen) {
+		*oLen = value.length;
+	}
+
+	return lki_lookup_exit(iLc, 0, 0, "string");
+}
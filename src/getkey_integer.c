@@ -7,41 +7,27 @@ lkonf_getkey_integer(lkonf_context * iLc, lkonf_keys iKeys, lua_Integer * oValue
 		return LK_INVALID_ARGUMENT;
 	}
 
-	if (LK_OK != lki_state_entry(iLc)) {
-		return lki_state_exit(iLc);
+	if (LK_OK != lki_lookup_entry(iLc)) {
+		return lki_lookup_exit(iLc, 0, iKeys, "integer");
 	}
 
 	if (! oValue) {
 		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oValue NULL");
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, 0, iKeys, "integer");
 	}
 
-	size_t last = 0;
-	if (LK_OK != lki_find_table_by_keys(iLc, iKeys, &last)) {
-		return lki_state_exit(iLc);
+	lki_value value;
+	if (LK_OK != lki_lookup_keys(iLc, iKeys, &value)) {
+		return lki_lookup_exit(iLc, 0, iKeys, "integer");
 	}
 
-	if (lua_isfunction(iLc->state, -1)) {
-		if (LK_OK != lki_format_keys(iLc, iKeys, 0)) {
-			return lki_state_exit(iLc);
-		}
-		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
-			return lki_state_exit(iLc);
-		}
-	}
-
-	if (LUA_TNIL == lua_type(iLc->state, -1)) {
-		lki_set_error(iLc, LK_NOT_FOUND, "");
-		return lki_state_exit(iLc);
-	}
-
-	if (LUA_TNUMBER != lua_type(iLc->state, -1)) {
+	if (LUA_TNUMBER != value.type || ! value.integral) {
 		lki_set_error_keys(iLc,
 			LK_OUT_OF_RANGE, "Not an integer", iKeys, 0);
-		return lki_state_exit(iLc);
+		return lki_lookup_exit(iLc, 0, iKeys, "integer");
 	}
 
-	*oValue = lua_tointeger(iLc->state, -1);
+	*oValue = value.integer;
 
-	return lki_state_exit(iLc);
+	return lki_lookup_exit(iLc, 0, iKeys, "integer");
 }
@@ -0,0 +1,21 @@
+#include "internal.h"
+
+bool
+lki_has_index(lua_State * iState, const int iIndex)
+{
+	const bool sealed = lki_is_sealed(iState, iIndex);
+
+	if (! lua_getmetatable(iState, iIndex)) {	/* S: mt */
+		return false;
+	}
+	lua_pushliteral(iState, "__index");		/* S: mt k */
+	lua_rawget(iState, -2);				/* S: mt mt[k] */
+	bool has = ! lua_isnil(iState, -1);
+	if (sealed) {
+			/* __index is the storage; look at its own. */
+		has = lki_has_index(iState, -1);
+	}
+	lua_pop(iState, 2);				/* S: */
+
+	return has;
+}
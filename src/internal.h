@@ -34,6 +34,294 @@
 
 #include <lkonf.h>
 
+#include <stdint.h>
+
+#if defined(LKONF_LUAJIT)
+#include <luajit.h>
+#endif
+
+#include "probes.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && ! defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+
+/**
+ * Flag that may be set from another thread or a signal handler.
+ */
+typedef atomic_int		lki_flag;
+
+/**
+ * Set lki_flag.
+ */
+#define LKI_FLAG_SET(f)		atomic_store(&(f), 1)
+
+/**
+ * Clear lki_flag, returning non-zero if it was set.
+ */
+#define LKI_FLAG_TAKE(f)	atomic_exchange(&(f), 0)
+
+#else
+#include <signal.h>
+
+typedef volatile sig_atomic_t	lki_flag;
+
+#define LKI_FLAG_SET(f)		((f) = 1)
+#define LKI_FLAG_TAKE(f)	((f) ? ((f) = 0, 1) : 0)
+
+#endif
+
+
+/**
+ * Linkage of the lki_*() functions.
+ * Static when building the amalgamation lkonf_all.c,
+ * so that they can be inlined into the public functions
+ * and aren't exported from liblkonf.
+ * Otherwise hidden where supported, so that they aren't exported,
+ * calls to them don't go through the PLT,
+ * and --enable-lto can inline them.
+ */
+#if defined(LKONF_AMALGAMATION)
+#define LKI_API		static
+#elif defined(__GNUC__)
+#define LKI_API		extern __attribute__((visibility("hidden")))
+#else
+#define LKI_API		LUA_API
+#endif
+
+
+/**
+ * Type of the item in an lkonf_context error.
+ */
+typedef enum
+{
+	LKI_ITEM_NONE		= 0,	/** No item. */
+	LKI_ITEM_STRING		= 1,	/** String. */
+	LKI_ITEM_KEYS		= 2,	/** Keys. */
+} lki_error_item;
+
+
+/**
+ * Number of entries in the lookup cache.
+ */
+#define LKI_CACHE_SIZE		256
+
+/**
+ * Maximum length of a key in the lookup cache.
+ * Longer paths aren't cached.
+ */
+#define LKI_CACHE_KEY_MAX	80
+
+/**
+ * Value of a lookup.
+ */
+typedef struct
+{
+	/**
+	 * Lua type of the value (LUA_T*).
+	 */
+	int		type;
+
+	/**
+	 * Value if LUA_TBOOLEAN.
+	 */
+	bool		boolean;
+
+	/**
+	 * Value if LUA_TNUMBER.
+	 */
+	lua_Number	number;
+
+	/**
+	 * Value if LUA_TNUMBER and integral, as per lki_to_integer().
+	 */
+	lua_Integer	integer;
+
+	/**
+	 * True if LUA_TNUMBER with an exact lua_Integer value.
+	 */
+	bool		integral;
+
+	/**
+	 * Value if LUA_TSTRING.
+	 * Valid until the lkonf_context is next used.
+	 */
+	const char *	string;
+
+	/**
+	 * Length of string.
+	 */
+	size_t		length;
+} lki_value;
+
+
+/**
+ * Lookup cache entry.
+ */
+typedef struct
+{
+	/**
+	 * Generation of the entry.
+	 * Valid if it matches lkonf_context generation; 0 if unused.
+	 */
+	uint64_t	generation;
+
+	/**
+	 * Hash of key.
+	 */
+	uint64_t	hash;
+
+	/**
+	 * Length of key.
+	 */
+	size_t		len;
+
+	/**
+	 * Key; either a path, or nul followed by nul-terminated keys.
+	 */
+	char		key[LKI_CACHE_KEY_MAX];
+
+	/**
+	 * Cached value; LUA_TNIL if missing.
+	 * A string value points into the Lua string held by ref.
+	 */
+	lki_value	value;
+
+	/**
+	 * Registry reference of the Lua string if value is LUA_TSTRING.
+	 */
+	int		ref;
+} lki_cache_entry;
+
+
+/**
+ * Typed array userdata, created by the typed-array constructors.
+ */
+typedef struct
+{
+	/**
+	 * Element type.
+	 */
+	lkonf_array_type	type;
+
+	/**
+	 * Number of elements.
+	 */
+	size_t			length;
+
+	/**
+	 * Elements, suitably aligned.
+	 */
+	union {
+		double		f;
+		int64_t		i;
+	}			data[];
+} lki_typed_array;
+
+/**
+ * Registry name of the typed array metatable.
+ */
+#define LKI_TYPED_ARRAY	"lkonf.typed_array"
+
+/**
+ * Registry name of the lkonf_context light userdata,
+ * for the count hook when the context isn't the allocator userdata.
+ */
+#define LKI_CONTEXT	"lkonf.context"
+
+/**
+ * Leading bytes of a binary chunk.
+ * LuaJIT bytecode has its own format, despite defining LUA_SIGNATURE.
+ */
+#if defined(LKONF_LUAJIT)
+#define LKI_SIGNATURE	"\033LJ"
+#else
+#define LKI_SIGNATURE	LUA_SIGNATURE
+#endif
+
+
+/**
+ * lkonf_iter implementation object.
+ */
+struct lkonf_iter_s
+{
+	/**
+	 * Context.
+	 */
+	lkonf_context *	lc;
+
+	/**
+	 * lkonf_iter_mode flags.
+	 */
+	int		mode;
+
+	/**
+	 * Registry reference of the iteration state table:
+	 * { table, sorted keys, current key, current value }.
+	 */
+	int		ref;
+
+	/**
+	 * Length of the table; the end of LK_ITER_ARRAY.
+	 */
+	size_t		length;
+
+	/**
+	 * Position in the array or sorted keys.
+	 */
+	size_t		position;
+};
+
+
+/**
+ * lkonf_function_ref implementation object.
+ */
+struct lkonf_function_ref_s
+{
+	/**
+	 * Context.
+	 */
+	lkonf_context *	lc;
+
+	/**
+	 * Registry reference of the call state table:
+	 * { [0] = outputs, function, results... }, where string results
+	 * of the last lkonf_call() and string outputs of the last
+	 * lkonf_call_batch() are kept so they remain valid.
+	 */
+	int		ref;
+
+	/**
+	 * Path the function was found at, for errors and probes.
+	 */
+	char		path[];
+};
+
+
+/**
+ * lkonf_validator implementation object.
+ */
+struct lkonf_validator_s
+{
+	/**
+	 * Context.
+	 */
+	lkonf_context *		lc;
+
+	/**
+	 * Root schema.
+	 */
+	const lkonf_schema *	schema;
+
+	/**
+	 * Registry reference of the matchers table, indexed by
+	 * the fields of each LK_SCHEMA_TABLE as light userdata.
+	 * Each matcher maps names to their schema as light userdata,
+	 * and [1] to the number of required names.
+	 */
+	int			ref;
+};
+
 
 /**
  * lkonf_context implementation object.
@@ -51,16 +339,156 @@ struct lkonf_context_s
 	lkonf_error	error_code;
 
 	/**
-	 * Current error string.
+	 * Current error message; static string.
 	 * Empty if no error.
+	 * If 0, the error string is error_item.
+	 */
+	const char *	error_message;
+
+	/**
+	 * Type of error_item.
+	 */
+	lki_error_item	error_item_type;
+
+	/**
+	 * Raw error item, copied when the error is set.
+	 * A string for LKI_ITEM_STRING, or nul-separated keys for LKI_ITEM_KEYS.
+	 */
+	char		error_item[128];
+
+	/**
+	 * Length of error_item.
+	 */
+	size_t		error_item_len;
+
+	/**
+	 * Number of keys in error_item for LKI_ITEM_KEYS.
+	 */
+	size_t		error_item_keys;
+
+	/**
+	 * True if error_string has been formatted for the current error.
+	 */
+	bool		error_formatted;
+
+	/**
+	 * Current error string, formatted by lkonf_get_error_string()
+	 * from error_message and error_item.
 	 */
 	char		error_string[128];
 
 	/**
-	 * Instruction limit (mask count).
+	 * Instruction limit per call.
 	 */
 	int		instruction_limit;
 
+	/**
+	 * Instruction budget across calls.
+	 */
+	long		instruction_budget;
+
+	/**
+	 * Instructions counted by the count hook.
+	 * Increases by hook_count each time the hook runs.
+	 */
+	long		instruction_count;
+
+	/**
+	 * instruction_count at the start of the current lki_call_chunk().
+	 */
+	long		call_start;
+
+	/**
+	 * Time limit per call, in microseconds.
+	 */
+	long		time_limit;
+
+	/**
+	 * Deadline for calls, in CLOCK_MONOTONIC nanoseconds.
+	 */
+	uint64_t	deadline;
+
+	/**
+	 * Deadline of the current lki_call_chunk(), from the time limit
+	 * and deadline.  0 if none.
+	 */
+	uint64_t	call_deadline;
+
+	/**
+	 * Error code raised by the count hook during the current
+	 * lki_call_chunk(), if any.  Reset on entry and exit.
+	 */
+	lkonf_error	hook_error;
+
+	/**
+	 * Interrupt requested by lkonf_interrupt().
+	 * Taken by the count hook or lki_call_chunk().
+	 */
+	lki_flag	interrupt;
+
+	/**
+	 * Count passed to lua_sethook(); the hook granularity.
+	 * 0 if the hook is not installed.
+	 */
+	int		hook_count;
+
+#if defined(LKONF_LUAJIT)
+	/**
+	 * True if the JIT compiler is off because limits are set.
+	 */
+	bool		jit_off;
+#endif
+
+	/**
+	 * Generation of the Lua state contents.
+	 * Incremented by lki_cache_invalidate() whenever the
+	 * Lua state may have been modified, invalidating lookup_cache.
+	 */
+	uint64_t	generation;
+
+	/**
+	 * Lookup cache of paths and keys known to be nil,
+	 * and their values if value_cache is enabled.
+	 * Allocated on first use.
+	 */
+	lki_cache_entry *	lookup_cache;
+
+	/**
+	 * Cache boolean, number and string values in lookup_cache.
+	 */
+	bool		value_cache;
+
+	/**
+	 * Set by the lki_find_table_*() functions if the value found
+	 * is nil and the table it is missing from has no __index
+	 * that could supply it.  Only such misses are cached.
+	 */
+	bool		raw_miss;
+
+	/**
+	 * Registry reference of weak-keyed table of sorted keys per table,
+	 * for LK_ITER_SORTED, or LUA_NOREF.
+	 */
+	int		sort_cache;
+
+	/**
+	 * generation when sort_cache was created.
+	 */
+	uint64_t	sort_generation;
+
+	/**
+	 * Registry reference of table of values whose contents have been
+	 * returned without copying since the last load, such as by
+	 * lkonf_get_typed_array(), keyed by path, or LUA_NOREF.
+	 */
+	int		load_anchors;
+
+	/**
+	 * Static data from lkonf_construct_static(), or 0.
+	 * If set, state is 0 and lookups use this instead.
+	 */
+	const lkonf_static_node *	baked;
+
 	/**
 	 * Lua state stack depth.
 	 * Use by lki_state_entry() and lki_state_exit() during
@@ -76,18 +504,20 @@ struct lkonf_context_s
  * @param iLc Context.
  * @warning Asserts that iLc is not 0.
  */
-LUA_API void
+LKI_API void
 lki_reset_error(lkonf_context * iLc);
 
 /**
  * Set the lkonf_context error code and string.
+ * The error string is formatted when needed by lkonf_get_error_string(),
+ * so setting errors on the lookup path doesn't format or allocate.
  * @param iLc Context.
  * @param iCode Error code.
- * @param iString Error string.
+ * @param iString Error string; must be a static string.
  * @return iCode.
  * @warning Asserts that iLc is not 0.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_set_error(
 	lkonf_context *		iLc,
 	const lkonf_error	iCode,
@@ -98,12 +528,12 @@ lki_set_error(
  * Error string is of the form: iString + ": " + iItem.
  * @param iLc Context.
  * @param iCode Error code.
- * @param iString Error string.
- * @param iItem Item text.
+ * @param iString Error string; must be a static string.
+ * @param iItem Item text; copied.
  * @return iCode.
  * @warning Asserts that iLc is not 0.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_set_error_item(
 	lkonf_context *		iLc,
 	const lkonf_error	iCode,
@@ -112,17 +542,37 @@ lki_set_error_item(
 
 /**
  * Set the lkonf_context error code and string.
- * Error string is of the form: iString + ": " + lki_format_keys(iKeys).
+ * Error string is of the form: iString + ": " + iItem[0..iLen).
+ * @param iLc Context.
+ * @param iCode Error code.
+ * @param iString Error string; must be a static string.
+ * @param iItem Item text; copied.
+ * @param iLen Length of iItem to use.
+ * @return iCode.
+ * @warning Asserts that iLc is not 0.
+ */
+LKI_API lkonf_error
+lki_set_error_litem(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iItem,
+	size_t			iLen);
+
+/**
+ * Set the lkonf_context error code and string.
+ * Error string is of the form: iString + ": " + formatted iKeys,
+ * as per lki_format_keys().
  * @param iLc		Context.
  * @param iCode		Error code.
- * @param iString	Error string.
- * @param iKeys		Keys to format.
+ * @param iString	Error string; must be a static string.
+ * @param iKeys		Keys to format; copied.
  * @param iMaxKeys	Maximum number of keys in iKeys to format, if > 0.
  *			If 0, all keys are formatted.
  * @return iCode.
  * @warning Asserts that iLc is not 0.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_set_error_keys(
 	lkonf_context *		iLc,
 	const lkonf_error	iCode,
@@ -130,6 +580,24 @@ lki_set_error_keys(
 	lkonf_keys		iKeys,
 	size_t			iMaxKeys);
 
+/**
+ * Set the error code and message, with iKeys formatted as a path.
+ * @param iLc		lkonf_context.
+ * @param iCode		Error code.
+ * @param iString	Error string. Not copied; must be static.
+ * @param iKeys		Keys to format as "name[index].name".
+ * @param iMaxKeys	Maximum number of keys in iKeys to format, if > 0.
+ *			If 0, all keys are formatted.
+ * @return iCode.
+ */
+LKI_API lkonf_error
+lki_set_error_ikeys(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	lkonf_ikeys		iKeys,
+	size_t			iMaxKeys);
+
 /**
  * Set the error code to iCode and error string to the string at Lua stack top.
  * @param iLc Context.
@@ -137,7 +605,7 @@ lki_set_error_keys(
  * @return iCode.
  * @warning Asserts that iLc is not 0.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_set_error_from_state(lkonf_context * iLc, const lkonf_error iCode);
 
 
@@ -150,7 +618,7 @@ lki_set_error_from_state(lkonf_context * iLc, const lkonf_error iCode);
  * @param iLc Context.
  * @return Error code.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_state_entry(lkonf_context * iLc);
 
 /**
@@ -160,13 +628,44 @@ lki_state_entry(lkonf_context * iLc);
  * @return Current error code of iLc.
  * @warning Asserts that the Lua stack hasn't gone below the depth.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_state_exit(lkonf_context * iLc);
 
+/**
+ * Lookup entry.
+ * As per lki_state_entry(), but also allows contexts
+ * from lkonf_construct_static().
+ * Call on entry to the value retrieval methods.
+ * @param iLc	Context.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_lookup_entry(lkonf_context * iLc);
+
+/**
+ * Lookup exit.
+ * Fires the lookup probe then calls lki_state_exit().
+ * Call on exit from the value retrieval methods.
+ * @param iLc	Context.
+ * @param iPath	Path for lkonf_get_*(), or NULL.
+ * @param iKeys	Keys for lkonf_getkey_*(), or NULL.
+ * @param iType	Requested type, as a string for the probe.
+ * @return Current error code of iLc.
+ */
+LKI_API lkonf_error
+lki_lookup_exit(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	lkonf_keys	iKeys,
+	const char *	iType);
+
 
 /**
  * Call chunk at top of stack.
  * If there's an error the iLc error state will be setup.
+ * The instruction limit applies to each call, the budget across calls.
+ * The time limit and deadline result in LK_DEADLINE_EXCEEDED.
+ * A pending lkonf_interrupt() results in LK_INTERRUPTED.
  * @warning Asserts that iLc and iLc->state are not 0.
  * @param iLc		Context.
  * @param iNumArgs	Number of arguments.
@@ -174,14 +673,36 @@ lki_state_exit(lkonf_context * iLc);
  * @return Error code.
  * @todo sandbox
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_call_chunk(lkonf_context * iLc, const int iNumArgs, const int iNumResults);
 
 /**
- * Raise lua error for maskcount exceeded.
+ * Maximum instructions between calls of the count hook.
+ */
+#define LKI_HOOK_COUNT	1000
+
+/**
+ * Install or adjust the count hook in iLc->state,
+ * based on the instruction limit and budget, time limit and deadline.
+ * The hook is always installed, so that lkonf_interrupt() is noticed.
+ * The hook is installed once rather than per lki_call_chunk(),
+ * so the hook count carries across calls.
+ * The granularity is an eighth of the smallest limit, up to LKI_HOOK_COUNT.
+ * With LuaJIT, compiled code doesn't run hooks, so the JIT compiler
+ * is turned off and its traces flushed while any limit is set.
+ * @param iLc	Context.
  */
-LUA_API void
-lki_maskcount_exceeded(lua_State * iState, lua_Debug * iArg);
+LKI_API void
+lki_update_hook(lkonf_context * iLc);
+
+/**
+ * Count hook.
+ * Updates the instruction count of the lkonf_context owning iState,
+ * and raises a Lua error if the instruction limit or budget is exceeded,
+ * the deadline of the call has passed, or an interrupt is pending.
+ */
+LKI_API void
+lki_count_hook(lua_State * iState, lua_Debug * iArg);
 
 
 /**
@@ -192,9 +713,31 @@ lki_maskcount_exceeded(lua_State * iState, lua_Debug * iArg);
  * @return Error code.
  * @todo document possible error codes and strings?
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_find_table_by_path(lkonf_context * iLc, const char * iPath);
 
+/**
+ * Parse a non-negative decimal integer that fits in an int,
+ * as used for integer keys in paths.
+ * @param	iStr	Digits.
+ * @param	iLen	Number of characters in iStr.
+ * @param[out]	oIndex	Integer.
+ * @return		True if iStr is a valid integer.
+ */
+LKI_API bool
+lki_parse_index(const char * iStr, size_t iLen, int * oIndex);
+
+/**
+ * Replace the table at the top of the stack with the value at iPath,
+ * relative to that table.
+ * iPath may start with an integer key "[n]".
+ * @param iLc	lkonf_context.
+ * @param iPath	Path of table keys to traverse.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_walk_path(lkonf_context * iLc, const char * iPath);
+
 /**
  * Find table by keys.
  * Sets error state appropriately.
@@ -205,9 +748,211 @@ lki_find_table_by_path(lkonf_context * iLc, const char * iPath);
  * @return Error code.
  * @todo document possible error codes and strings?
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_find_table_by_keys(lkonf_context * iLc, lkonf_keys iKeys, size_t * oMatch);
 
+/**
+ * Find the table at iKeys, which may contain integer keys.
+ * Pushes the value found onto the stack.
+ * @param iLc	lkonf_context.
+ * @param iKeys	Keys to traverse; array terminated with LK_END.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_find_table_by_ikeys(lkonf_context * iLc, lkonf_ikeys iKeys);
+
+/**
+ * Replace the table at the top of the stack with the value at iIndex.
+ * Uses lua_rawgeti(), falling back to the metatable if nil.
+ * Sets iLc->raw_miss.
+ * @param iLc		Context.
+ * @param iIndex	Integer key.
+ */
+LKI_API void
+lki_get_index(lkonf_context * iLc, const int iIndex);
+
+/**
+ * Replace the table and key at the top of the stack with the value
+ * at that key, as per lua_gettable().
+ * Sets iLc->raw_miss.
+ * @param iLc		Context.
+ */
+LKI_API void
+lki_get_field(lkonf_context * iLc);
+
+/**
+ * Determine if missing keys of a table may be supplied by __index,
+ * looking through the storage of a sealed table.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of table.
+ * @return		True if the table or its storage has an __index.
+ */
+LKI_API bool
+lki_has_index(lua_State * iState, const int iIndex);
+
+/**
+ * Invalidate the lookup cache.
+ * Call whenever the Lua state may have been modified;
+ * lki_call_chunk() calls this after running any chunk.
+ * @param iLc	Context.
+ */
+LKI_API void
+lki_cache_invalidate(lkonf_context * iLc);
+
+/**
+ * Hash a lookup cache key.
+ * @param iKey	Key.
+ * @param iLen	Length of iKey.
+ * @return	Hash.
+ */
+LKI_API uint64_t
+lki_cache_hash(const char * iKey, size_t iLen);
+
+/**
+ * Encode iKeys as a lookup cache key:
+ * a nul followed by each key and a nul.
+ * @param iKeys		Keys.
+ * @param[out] oKey	Buffer of LKI_CACHE_KEY_MAX bytes.
+ * @return		Length of key in oKey, or 0 if too long.
+ */
+LKI_API size_t
+lki_cache_keys(lkonf_keys iKeys, char * oKey);
+
+/**
+ * Encode iKeys as a lookup cache key:
+ * a \001 followed by each key as "n" name or "i" index, and a nul.
+ * @param iKeys		Keys.
+ * @param[out] oKey	Buffer of LKI_CACHE_KEY_MAX bytes.
+ * @return		Length of key in oKey, or 0 if too long.
+ */
+LKI_API size_t
+lki_cache_ikeys(lkonf_ikeys iKeys, char * oKey);
+
+/**
+ * Find iKey in the lookup cache.
+ * @param iLc	Context.
+ * @param iHash	Hash of iKey, from lki_cache_hash().
+ * @param iKey	Key.
+ * @param iLen	Length of iKey.
+ * @return	Entry for iKey in the current generation, or 0 if none.
+ */
+LKI_API const lki_cache_entry *
+lki_cache_find(
+	lkonf_context *	iLc,
+	uint64_t	iHash,
+	const char *	iKey,
+	size_t		iLen);
+
+/**
+ * Cache iKey with iValue in the current generation.
+ * Keys longer than LKI_CACHE_KEY_MAX are ignored.
+ * @param iLc		Context.
+ * @param iHash		Hash of iKey, from lki_cache_hash().
+ * @param iKey		Key.
+ * @param iLen		Length of iKey.
+ * @param iValue	Value; a string value must be at the top of the stack,
+ *			and is referenced from the registry.
+ */
+LKI_API void
+lki_cache_add(
+	lkonf_context *		iLc,
+	uint64_t		iHash,
+	const char *		iKey,
+	size_t			iLen,
+	const lki_value *	iValue);
+
+/**
+ * Free the lookup cache.
+ * String references are released by closing the Lua state.
+ * @param iLc	Context.
+ */
+LKI_API void
+lki_cache_free(lkonf_context * iLc);
+
+
+/**
+ * Lookup the value at iPath.
+ * If the value is a function, it is called as function(iPath).
+ * Uses and maintains the lookup cache.
+ * Sets error state appropriately, including LK_NOT_FOUND for nil.
+ * Values not found in the cache, including tables, are left on the stack.
+ * @param iLc		Context.
+ * @param iPath		Path of "."-separated table keys to traverse.
+ * @param[out] oValue	Value, if LK_OK.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_lookup_path(lkonf_context * iLc, const char * iPath, lki_value * oValue);
+
+/**
+ * Lookup the value at iKeys.
+ * If the value is a function, it is called as function(formatted iKeys).
+ * Uses and maintains the lookup cache.
+ * Sets error state appropriately, including LK_NOT_FOUND for nil.
+ * @param iLc		Context.
+ * @param iKeys		Table keys to traverse.
+ * @param[out] oValue	Value, if LK_OK.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_lookup_keys(lkonf_context * iLc, lkonf_keys iKeys, lki_value * oValue);
+
+/**
+ * Lookup the value at iKeys, which may contain integer keys.
+ * If the value is a function, it is called as function(formatted iKeys).
+ * Uses and maintains the lookup cache.
+ * Sets error state appropriately, including LK_NOT_FOUND for nil.
+ * @param iLc		Context.
+ * @param iKeys		Table keys to traverse.
+ * @param[out] oValue	Value, if LK_OK.
+ * @return Error code.
+ */
+LKI_API lkonf_error
+lki_lookup_ikeys(lkonf_context * iLc, lkonf_ikeys iKeys, lki_value * oValue);
+
+/**
+ * Lookup the value at iPath in the static data of iLc.
+ * As per lki_lookup_path().
+ * @param iLc		Context from lkonf_construct_static().
+ * @param iPath		Path.
+ * @param[out] oValue	Value.
+ * @return Error code; LK_NOT_FOUND if missing.
+ */
+LKI_API lkonf_error
+lki_static_lookup_path(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	lki_value *	oValue);
+
+/**
+ * Lookup the value at iKeys in the static data of iLc.
+ * As per lki_lookup_keys().
+ * @param iLc		Context from lkonf_construct_static().
+ * @param iKeys		Keys.
+ * @param[out] oValue	Value.
+ * @return Error code; LK_NOT_FOUND if missing.
+ */
+LKI_API lkonf_error
+lki_static_lookup_keys(
+	lkonf_context *	iLc,
+	lkonf_keys	iKeys,
+	lki_value *	oValue);
+
+/**
+ * Lookup the value at iKeys in the static data of iLc.
+ * As per lki_lookup_ikeys().
+ * @param iLc		Context from lkonf_construct_static().
+ * @param iKeys		Keys.
+ * @param[out] oValue	Value.
+ * @return Error code; LK_NOT_FOUND if missing.
+ */
+LKI_API lkonf_error
+lki_static_lookup_ikeys(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	lki_value *	oValue);
+
+
 /**
  * Format iKeys as a human-readable string, and leave on the stack.
  * @param iLc		lkonf_context.
@@ -216,8 +961,204 @@ lki_find_table_by_keys(lkonf_context * iLc, lkonf_keys iKeys, size_t * oMatch);
  *			If 0, all keys are formatted.
  * @return		Error code, or LK_OK if pushed ok.
  */
-LUA_API lkonf_error
+LKI_API lkonf_error
 lki_format_keys(lkonf_context * iLc, lkonf_keys iKeys, size_t iMaxKeys);
 
+/**
+ * Format iKeys as a path of the form "name[index].name",
+ * and leave on the stack.
+ * @param iLc		lkonf_context.
+ * @param iKeys		Keys to format.
+ * @param iMaxKeys	Maximum number of keys in iKeys to format, if > 0.
+ *			If 0, all keys are formatted.
+ * @return		Error code, or LK_OK if pushed ok.
+ */
+LKI_API lkonf_error
+lki_format_ikeys(lkonf_context * iLc, lkonf_ikeys iKeys, size_t iMaxKeys);
+
+
+/**
+ * Determine if a table has been sealed by lkonf_seal().
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of value to check.
+ * @return		True if the value is a sealed table.
+ */
+LKI_API bool
+lki_is_sealed(lua_State * iState, const int iIndex);
+
+/**
+ * Determine if a table has been sealed by lkonf_seal(),
+ * and every table reachable from it, including through the
+ * __index of an original metatable, is sealed too.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of value to check.
+ * @return		True if the value is a closed sealed table.
+ */
+LKI_API bool
+lki_is_closed(lua_State * iState, const int iIndex);
+
+/**
+ * Find the array at iPath, for the lkonf_get_*_array() functions.
+ * Pushes the table, or its storage if sealed.
+ * @param iLc		lkonf_context.
+ * @param iPath		Path to array.
+ * @param iCapacity	Capacity of the caller's buffer.
+ * @param iBuffer	True if the caller has a buffer to fill.
+ * @param[out] oLength	Length of the array.
+ * @return		Error code, or LK_OK if pushed.
+ */
+LKI_API lkonf_error
+lki_find_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const size_t	iCapacity,
+	const bool	iBuffer,
+	size_t *	oLength);
+
+
+/**
+ * Set the error code and message, with iPath[iIndex] as the item.
+ * @param iLc		lkonf_context.
+ * @param iCode		Error code.
+ * @param iString	Error string. Not copied; must be static.
+ * @param iPath		Path to array.
+ * @param iIndex	Index in array.
+ * @return iCode.
+ */
+LKI_API lkonf_error
+lki_set_error_index(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iPath,
+	const size_t		iIndex);
+
+
+/**
+ * Register the typed array metatable,
+ * and set the constructors in the table at iIndex.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of table; must be absolute.
+ */
+LKI_API void
+lki_open_typed_arrays(lua_State * iState, const int iIndex);
+
+
+/**
+ * Get the typed array at iIndex.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of value.
+ * @return		Typed array, or 0 if not a typed array.
+ */
+LKI_API lki_typed_array *
+lki_to_typed_array(lua_State * iState, const int iIndex);
+
+
+/**
+ * Anchor the value at iIndex as the value of iPath until the next load,
+ * so that pointers into it remain valid.
+ * Replaces any value previously anchored for iPath,
+ * so repeated lookups of a path don't accumulate anchors.
+ * @param iLc		lkonf_context.
+ * @param iIndex	Stack index of value.
+ * @param iPath		Path the value was found at.
+ */
+LKI_API void
+lki_anchor(lkonf_context * iLc, const int iIndex, const char * iPath);
+
+
+/**
+ * As lki_anchor(), for the value found at iKeys.
+ * Keyed by an encoding of iKeys rather than by their path,
+ * so that no path is formatted.
+ * @param iLc		lkonf_context.
+ * @param iIndex	Stack index of value.
+ * @param iKeys		Keys the value was found at.
+ */
+LKI_API void
+lki_anchor_ikeys(lkonf_context * iLc, const int iIndex, lkonf_ikeys iKeys);
+
+
+/**
+ * Release values anchored by lki_anchor().
+ * @param iLc	lkonf_context.
+ */
+LKI_API void
+lki_release_anchors(lkonf_context * iLc);
+
+
+/**
+ * Push the storage table of a table sealed by lkonf_seal(),
+ * or the value itself if not sealed.
+ * For raw access such as lua_next().
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of value.
+ */
+LKI_API void
+lki_push_storage(lua_State * iState, const int iIndex);
+
+
+/**
+ * Push the table of globals.
+ * @param iState	Lua state.
+ */
+LKI_API void
+lki_push_globals(lua_State * iState);
+
+
+/**
+ * Convert the number at iIndex to a lua_Integer, without truncation.
+ * With Lua 5.3 and later this uses lua_tointegerx(), which is exact
+ * for the integer subtype; with earlier versions the lua_Number
+ * must be in range and have no fractional part.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of a number.
+ * @param[out] oValue	Integer value; 0 if not integral.
+ * @return True if the number is an exact lua_Integer.
+ */
+LKI_API bool
+lki_to_integer(lua_State * iState, const int iIndex, lua_Integer * oValue);
+
+/**
+ * Push iValue, as an argument to a function.
+ * With Lua 5.3 and later, a number whose integer is equal to
+ * its number is pushed as an integer.
+ * @param iState	Lua state.
+ * @param iValue	LK_TYPE_NIL, LK_TYPE_BOOLEAN, LK_TYPE_NUMBER,
+ *			or LK_TYPE_STRING with a non-0 string.
+ * @return False if iValue can't be pushed; nothing is pushed.
+ */
+LKI_API bool
+lki_push_value(lua_State * iState, const lkonf_value * iValue);
+
+/**
+ * Fill oValue from the value at iIndex.
+ * Strings point into the Lua state.
+ * @param iState	Lua state.
+ * @param iIndex	Stack index of value.
+ * @param[out] oValue	Value.
+ */
+LKI_API void
+lki_to_value(lua_State * iState, const int iIndex, lkonf_value * oValue);
+
+
+/**
+ * Push an array of the keys of the table at the top of the stack,
+ * sorted as per LK_ITER_SORTED.
+ * Uses and maintains sort_cache.
+ * @param iLc	lkonf_context.
+ * @return	Error code, or LK_OK if pushed.
+ */
+LKI_API lkonf_error
+lki_sorted_keys(lkonf_context * iLc);
+
+
+/**
+ * Current time of CLOCK_MONOTONIC.
+ * @return Nanoseconds, or 0 if the clock can't be read.
+ */
+LKI_API uint64_t
+lki_monotonic_time(void);
+
 
 #endif /* LKONF_INTERNAL_H */
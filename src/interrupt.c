@@ -0,0 +1,14 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_interrupt(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+		/* Only set the flag; may be running in a signal handler. */
+	LKI_FLAG_SET(iLc->interrupt);
+
+	return LK_OK;
+}
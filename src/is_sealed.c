@@ -0,0 +1,50 @@
+#include "internal.h"
+
+bool
+lki_is_sealed(lua_State * iState, const int iIndex)
+{
+	if (! lua_istable(iState, iIndex)) {
+		return false;
+	}
+
+	if (! lua_getmetatable(iState, iIndex)) {	/* S: */
+		return false;
+	}
+							/* S: mt */
+	lua_pushliteral(iState, "__sealed");		/* S: mt k */
+	lua_rawget(iState, -2);				/* S: mt mt[k] */
+	const bool sealed = lua_toboolean(iState, -1);
+	lua_pop(iState, 2);				/* S: */
+
+	return sealed;
+}
+
+bool
+lki_is_closed(lua_State * iState, const int iIndex)
+{
+	if (! lki_is_sealed(iState, iIndex)) {
+		return false;
+	}
+
+	lua_getmetatable(iState, iIndex);		/* S: mt */
+	lua_pushliteral(iState, "__open");		/* S: mt k */
+	lua_rawget(iState, -2);				/* S: mt mt[k] */
+	const bool open = lua_toboolean(iState, -1);
+	lua_pop(iState, 2);				/* S: */
+
+	return ! open;
+}
+
+void
+lki_push_storage(lua_State * iState, const int iIndex)
+{
+	if (! lki_is_sealed(iState, iIndex)) {
+		lua_pushvalue(iState, iIndex);		/* S: t */
+		return;
+	}
+
+	lua_getmetatable(iState, iIndex);		/* S: mt */
+	lua_pushliteral(iState, "__index");		/* S: mt k */
+	lua_rawget(iState, -2);				/* S: mt s */
+	lua_remove(iState, -2);				/* S: s */
+}
@@ -0,0 +1,80 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+lkonf_error
+lkonf_iter_begin(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const int	iMode,
+	lkonf_iter **	oIter)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! oIter) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "oIter NULL");
+		return lki_state_exit(iLc);
+	}
+	*oIter = 0;
+
+	if (iMode & ~(LK_ITER_ALL | LK_ITER_SORTED)) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iMode invalid");
+		return lki_state_exit(iLc);
+	}
+
+	if (iPath && ! *iPath) {
+		lki_push_globals(iLc->state);		/* S: t */
+	} else if (LK_OK != lki_find_table_by_path(iLc, iPath)) {
+		return lki_state_exit(iLc);
+	} else if (! lua_istable(iLc->state, -1)) {
+		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Not a table", iPath);
+		return lki_state_exit(iLc);
+	}
+
+	lkonf_iter * it = calloc(1, sizeof(*it));
+	if (! it) {
+		lki_set_error(iLc,
+			LK_RESOURCE_EXHAUSTED, "Allocating iterator");
+		return lki_state_exit(iLc);
+	}
+	it->lc = iLc;
+	it->mode = iMode;
+	if (! (it->mode & LK_ITER_ALL)) {
+		it->mode |= LK_ITER_ALL;
+	}
+
+		/* Iterate the storage of sealed tables. */
+	lki_push_storage(iLc->state, -1);			/* S: t s */
+#if LUA_VERSION_NUM >= 502
+	it->length = lua_rawlen(iLc->state, -1);
+#else
+	it->length = lua_objlen(iLc->state, -1);
+#endif
+
+	lua_createtable(iLc->state, 4, 0);			/* S: t s st */
+	lua_pushvalue(iLc->state, -2);				/* S: t s st s */
+	lua_rawseti(iLc->state, -2, 1);				/* S: t s st */
+
+	if ((it->mode & LK_ITER_SORTED) && (it->mode & LK_ITER_HASH)) {
+		lua_pushvalue(iLc->state, -2);			/* S: t s st s */
+		if (LK_OK != lki_sorted_keys(iLc)) {		/* S: t s st s k */
+			free(it);
+			return lki_state_exit(iLc);
+		}
+		lua_rawseti(iLc->state, -3, 2);			/* S: t s st s */
+		lua_pop(iLc->state, 1);				/* S: t s st */
+	}
+
+	it->ref = luaL_ref(iLc->state, LUA_REGISTRYINDEX);	/* S: t s */
+
+	*oIter = it;
+
+	return lki_state_exit(iLc);
+}
@@ -0,0 +1,18 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+
+void
+lkonf_iter_end(lkonf_iter * iIter)
+{
+	if (! iIter) {
+		return;
+	}
+
+	if (iIter->lc && iIter->lc->state) {
+		luaL_unref(iIter->lc->state, LUA_REGISTRYINDEX, iIter->ref);
+	}
+
+	free(iIter);
+}
@@ -0,0 +1,127 @@
+#include "internal.h"
+
+/**
+ * Determine if the key at iIndex is in the array part,
+ * i.e., an integer from 1 to iLength.
+ */
+static bool
+is_array_key(lua_State * iState, const int iIndex, const size_t iLength)
+{
+	if (LUA_TNUMBER != lua_type(iState, iIndex)) {
+		return false;
+	}
+
+	const lua_Number n = lua_tonumber(iState, iIndex);
+	return n >= 1 && n <= (lua_Number)iLength && n == (lua_Integer)n;
+}
+
+/**
+ * Push the next key and value.
+ * @return False at the end.
+ */
+static bool
+push_next(lkonf_iter * iIter)
+{
+	lua_State * ls = iIter->lc->state;
+							/* S: st t */
+
+		/* Array part, in order. */
+	if (! (iIter->mode & LK_ITER_SORTED) || ! (iIter->mode & LK_ITER_HASH)) {
+		while ((iIter->mode & LK_ITER_ARRAY) &&
+		    iIter->position < iIter->length) {
+			++iIter->position;
+			lua_pushinteger(ls, (lua_Integer)iIter->position);
+			lua_rawgeti(ls, -2, (int)iIter->position);
+			if (! lua_isnil(ls, -1)) {
+				return true;		/* S: st t k v */
+			}
+			lua_pop(ls, 2);			/* S: st t */
+		}
+	}
+
+	if (! (iIter->mode & LK_ITER_HASH)) {
+		return false;
+	}
+
+		/* Sorted keys. */
+	if (iIter->mode & LK_ITER_SORTED) {
+		lua_rawgeti(ls, -2, 2);			/* S: st t keys */
+		for (;;) {
+			lua_rawgeti(ls, -1, (int)++iIter->position);
+			if (lua_isnil(ls, -1)) {	/* S: st t keys k */
+				lua_pop(ls, 2);		/* S: st t */
+				return false;
+			}
+			if (! (iIter->mode & LK_ITER_ARRAY) &&
+			    is_array_key(ls, -1, iIter->length)) {
+				lua_pop(ls, 1);		/* S: st t keys */
+				continue;
+			}
+			lua_remove(ls, -2);		/* S: st t k */
+			lua_pushvalue(ls, -1);		/* S: st t k k */
+			lua_rawget(ls, -3);		/* S: st t k v */
+			return true;
+		}
+	}
+
+		/*
+		 * Other keys, in traversal order, skipping the array part.
+		 * The current key is kept in the state table for lua_next(),
+		 * which also anchors it.
+		 */
+	lua_rawgeti(ls, -2, 3);				/* S: st t k */
+	while (lua_next(ls, -2)) {			/* S: st t k v */
+		lua_pushvalue(ls, -2);			/* S: st t k v k */
+		lua_rawseti(ls, -5, 3);			/* S: st t k v */
+		if (! is_array_key(ls, -2, iIter->length)) {
+			return true;
+		}
+		lua_pop(ls, 1);				/* S: st t k */
+	}
+
+	return false;
+}
+
+lkonf_error
+lkonf_iter_next(lkonf_iter * iIter, lkonf_value * oKey, lkonf_value * oValue)
+{
+	if (! iIter) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lkonf_context * lc = iIter->lc;
+
+	if (LK_OK != lki_state_entry(lc)) {
+		return lki_state_exit(lc);
+	}
+
+	if (! oKey) {
+		lki_set_error(lc, LK_INVALID_ARGUMENT, "oKey NULL");
+		return lki_state_exit(lc);
+	}
+
+	if (! oValue) {
+		lki_set_error(lc, LK_INVALID_ARGUMENT, "oValue NULL");
+		return lki_state_exit(lc);
+	}
+
+	lua_rawgeti(lc->state, LUA_REGISTRYINDEX, iIter->ref);	/* S: st */
+	lua_rawgeti(lc->state, -1, 1);				/* S: st t */
+
+	if (! push_next(iIter)) {
+		lki_set_error(lc, LK_NOT_FOUND, "");
+		return lki_state_exit(lc);
+	}
+								/* S: st t k v */
+		/*
+		 * Anchor the value so that strings remain valid.
+		 * String keys are anchored by the table.
+		 */
+	lua_pushvalue(lc->state, -1);
+	lua_rawseti(lc->state, -5, 4);
+
+	lki_to_value(lc->state, -2, oKey);
+	lki_to_value(lc->state, -1, oValue);
+
+	return lki_state_exit(lc);
+}
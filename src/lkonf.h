@@ -37,6 +37,7 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include <lua.h>
 
@@ -62,6 +63,8 @@ typedef enum
 	LK_NOT_FOUND		= 3,	/** Element not found. */
 	LK_OUT_OF_RANGE		= 4,	/** Invalid element/key. */
 	LK_RESOURCE_EXHAUSTED	= 5,	/** Not enough resources (memory). */
+	LK_DEADLINE_EXCEEDED	= 6,	/** Time limit or deadline passed. */
+	LK_INTERRUPTED		= 7,	/** Interrupted by lkonf_interrupt(). */
 } lkonf_error;
 
 
@@ -71,6 +74,275 @@ typedef enum
 typedef const char * const	lkonf_keys[];
 
 
+/**
+ * Type of an lkonf_ikey.
+ */
+typedef enum
+{
+	LK_KEY_END	= 0,	/** End of lkonf_ikeys. */
+	LK_KEY_NAME	= 1,	/** String key in name. */
+	LK_KEY_INDEX	= 2,	/** Integer key in index. */
+} lkonf_key_type;
+
+
+/**
+ * Key that is either a string or an integer.
+ * Use LK_NAME(), LK_INDEX() and LK_END to initialise.
+ */
+typedef struct
+{
+	lkonf_key_type	type;	/** Type of key. */
+	const char *	name;	/** String key if type is LK_KEY_NAME. */
+	int		index;	/** Integer key if type is LK_KEY_INDEX. */
+} lkonf_ikey;
+
+/** lkonf_ikey initialiser for string key n. */
+#define LK_NAME(n)	{ LK_KEY_NAME, (n), 0 }
+
+/** lkonf_ikey initialiser for integer key i. */
+#define LK_INDEX(i)	{ LK_KEY_INDEX, 0, (i) }
+
+/** lkonf_ikey initialiser for the end of lkonf_ikeys. */
+#define LK_END		{ LK_KEY_END, 0, 0 }
+
+
+/**
+ * Array of string or integer keys, terminated with LK_END.
+ */
+typedef const lkonf_ikey	lkonf_ikeys[];
+
+
+/**
+ * Type of an lkonf_value.
+ */
+typedef enum
+{
+	LK_TYPE_NIL		= 0,	/** nil. */
+	LK_TYPE_BOOLEAN		= 1,	/** boolean. */
+	LK_TYPE_NUMBER		= 2,	/** number. */
+	LK_TYPE_STRING		= 3,	/** string. */
+	LK_TYPE_TABLE		= 4,	/** table. */
+	LK_TYPE_FUNCTION	= 5,	/** function. */
+	LK_TYPE_OTHER		= 6,	/** Any other Lua type. */
+} lkonf_type;
+
+
+/**
+ * Typed Lua value.
+ */
+typedef struct
+{
+	lkonf_type	type;		/** Type of value. */
+	bool		boolean;	/** Value if LK_TYPE_BOOLEAN. */
+	double		number;		/** Value if LK_TYPE_NUMBER. */
+	lua_Integer	integer;	/** number if integral, else 0. */
+	const char *	string;		/** Value if LK_TYPE_STRING. */
+	size_t		length;		/** Length of string. */
+} lkonf_value;
+
+
+/**
+ * Element type of typed arrays.
+ */
+typedef enum
+{
+	LK_ARRAY_U8	= 1,	/** uint8_t, from u8{...}. */
+	LK_ARRAY_I16	= 2,	/** int16_t, from i16{...}. */
+	LK_ARRAY_I32	= 3,	/** int32_t, from i32{...}. */
+	LK_ARRAY_I64	= 4,	/** int64_t, from i64{...}. */
+	LK_ARRAY_F32	= 5,	/** float, from f32{...}. */
+	LK_ARRAY_F64	= 6,	/** double, from f64{...}. */
+} lkonf_array_type;
+
+
+/**
+ * Type of a column for lkonf_get_columns().
+ */
+typedef enum
+{
+	LK_COLUMN_BOOLEAN	= 1,	/** bool. */
+	LK_COLUMN_INTEGER	= 2,	/** lua_Integer. */
+	LK_COLUMN_DOUBLE	= 3,	/** double. */
+	LK_COLUMN_STRING	= 4,	/** const char *, owned by lkonf. */
+} lkonf_column_type;
+
+
+/**
+ * Column specification for lkonf_get_columns().
+ */
+typedef struct
+{
+	const char *		name;		/** Field of each record. */
+	lkonf_column_type	type;		/** Type of field. */
+	bool			required;	/** Field must be present. */
+	lkonf_value		fallback;	/** Value if field is missing. */
+} lkonf_column_spec;
+
+
+/**
+ * Node of a configuration evaluated into static data by lkonf-bake,
+ * for lkonf_construct_static().
+ * The children of a table are sorted with integer keys first,
+ * in order of index, then names in strcmp() order.
+ */
+typedef struct lkonf_static_node_s lkonf_static_node;
+
+struct lkonf_static_node_s
+{
+	const char *			name;		/** String key,
+							 *  or 0 if index. */
+	int				index;		/** Integer key. */
+	lkonf_value			value;		/** Value; type is not
+							 *  LK_TYPE_FUNCTION. */
+	const lkonf_static_node *	children;	/** Children if
+							 *  LK_TYPE_TABLE. */
+	size_t				count;		/** Number of
+							 *  children. */
+};
+
+
+/**
+ * Type of a struct member for lkonf_bind().
+ */
+typedef enum
+{
+	LK_BIND_BOOLEAN = 1,	/** bool. */
+	LK_BIND_INTEGER,	/** lua_Integer. */
+	LK_BIND_DOUBLE,		/** double. */
+	LK_BIND_STRING,		/** char *, which the caller must free. */
+	LK_BIND_STRUCT,		/** Nested struct, bound per fields. */
+	LK_BIND_BOOLEAN_ARRAY,	/** bool[count]. */
+	LK_BIND_INTEGER_ARRAY,	/** lua_Integer[count]. */
+	LK_BIND_DOUBLE_ARRAY,	/** double[count]. */
+} lkonf_bind_type;
+
+
+/**
+ * Binding of a struct member to a configuration value, for lkonf_bind().
+ */
+typedef struct lkonf_binding_s lkonf_binding;
+
+struct lkonf_binding_s
+{
+	const char *		path;		/** Path relative to the root. */
+	lkonf_bind_type		type;		/** Type of member. */
+	size_t			offset;		/** offsetof() member. */
+	bool			required;	/** Value must be present. */
+	lkonf_value		fallback;	/** Value if missing or invalid. */
+	const lkonf_binding *	fields;		/** LK_BIND_STRUCT members. */
+	size_t			count;		/** Number of fields,
+						 *  or capacity of array. */
+	size_t			length_offset;	/** offsetof() size_t member
+						 *  for length of array. */
+};
+
+
+/**
+ * Callback for each error found by lkonf_bind().
+ * @param iArg		Argument passed to lkonf_bind().
+ * @param iPath		Full path of the value.
+ * @param iCode		Error code.
+ * @param iString	Error string.
+ */
+typedef void (*lkonf_bind_report)(
+	void *			iArg,
+	const char *		iPath,
+	const lkonf_error	iCode,
+	const char *		iString);
+
+
+/**
+ * Type of a value for lkonf_schema.
+ */
+typedef enum
+{
+	LK_SCHEMA_ANY = 1,	/** Any value. */
+	LK_SCHEMA_BOOLEAN,	/** Boolean. */
+	LK_SCHEMA_NUMBER,	/** Number. */
+	LK_SCHEMA_INTEGER,	/** Integral number. */
+	LK_SCHEMA_STRING,	/** String. */
+	LK_SCHEMA_TABLE,	/** Table with keys per fields. */
+	LK_SCHEMA_ARRAY,	/** Table of elements 1 to #t per fields[0]. */
+	LK_SCHEMA_FUNCTION,	/** Function. */
+} lkonf_schema_type;
+
+
+/**
+ * Flags for lkonf_schema.
+ */
+typedef enum
+{
+	LK_SCHEMA_REQUIRED	= 1<<0,	/** Key must be present. */
+	LK_SCHEMA_RANGE		= 1<<1,	/** Number, or length of string or
+					 *  array, within minimum to maximum. */
+	LK_SCHEMA_OPEN		= 1<<2,	/** Table or array may contain
+					 *  other keys. */
+} lkonf_schema_flags;
+
+
+/**
+ * Schema of a value, for lkonf_compile_schema().
+ */
+typedef struct lkonf_schema_s lkonf_schema;
+
+struct lkonf_schema_s
+{
+	const char *		name;		/** Key in table. */
+	lkonf_schema_type	type;		/** Type of value. */
+	int			flags;		/** lkonf_schema_flags. */
+	double			minimum;	/** Minimum if LK_SCHEMA_RANGE. */
+	double			maximum;	/** Maximum if LK_SCHEMA_RANGE. */
+	const lkonf_schema *	fields;		/** Keys of LK_SCHEMA_TABLE,
+						 *  or element of
+						 *  LK_SCHEMA_ARRAY. */
+	size_t			count;		/** Number of fields. */
+};
+
+
+/**
+ * Opaque type for compiled schemas.
+ */
+typedef struct lkonf_validator_s lkonf_validator;
+
+
+/**
+ * Callback for each violation found by lkonf_validate().
+ * @param iArg		Argument passed to lkonf_validate().
+ * @param iPath		Full path of the value.
+ * @param iCode		Error code.
+ * @param iString	Error string.
+ */
+typedef void (*lkonf_validate_report)(
+	void *			iArg,
+	const char *		iPath,
+	const lkonf_error	iCode,
+	const char *		iString);
+
+
+/**
+ * Opaque type for table iterators.
+ */
+typedef struct lkonf_iter_s lkonf_iter;
+
+
+/**
+ * Opaque type for references to function-valued keys.
+ */
+typedef struct lkonf_function_ref_s lkonf_function_ref;
+
+
+/**
+ * Table iteration modes for lkonf_iter_begin().
+ */
+typedef enum
+{
+	LK_ITER_ARRAY	= 1<<0,	/** Integer keys 1 to #t, in order. */
+	LK_ITER_HASH	= 1<<1,	/** Other keys. */
+	LK_ITER_ALL	= LK_ITER_ARRAY | LK_ITER_HASH,	/** All keys. */
+	LK_ITER_SORTED	= 1<<2,	/** Sort keys; numbers, strings, others. */
+} lkonf_iter_mode;
+
+
 	/*
 	 * lkonf_context object management.
 	 */
@@ -86,6 +358,18 @@ LUA_API lkonf_context *
 lkonf_construct(void);
 
 
+/**
+ * Construct an lkonf_context that reads the static data iRoot,
+ * as generated by lkonf-bake, without a Lua state.
+ * Only the value retrieval functions lkonf_get_*(), lkonf_getkey_*()
+ * and lkonf_getikey_*() of booleans, numbers and strings are supported;
+ * other functions fail with LK_INVALID_ARGUMENT.
+ * @param iRoot	Root table; must be LK_TYPE_TABLE.
+ * @return lkonf_context, or 0 on failure.
+ */
+LUA_API lkonf_context *
+lkonf_construct_static(const lkonf_static_node * iRoot);
+
 /**
  * Destruct an lkonf_context.
  * @param iLc	lkonf_context to destroy.
@@ -104,6 +388,10 @@ lkonf_destruct(lkonf_context * iLc);
  *
  * @note Closing the Lua state underneath lkonf_context will result in undefined
  * behaviour.
+ * @note Lookups cache missing keys, other than those missing from a table
+ * with an __index metamethod, until the Lua state is next modified
+ * by lkonf; call lkonf_get_lua_State() again after modifying the state
+ * to invalidate the cache.
  */
 LUA_API lua_State *
 lkonf_get_lua_State(lkonf_context * iLc);
@@ -125,13 +413,31 @@ lkonf_get_error_code(lkonf_context * iLc);
 
 /**
  * Error string from most recent lkonf operation, if any.
+ * The string is formatted by the first call after an error,
+ * rather than when the error occurs.
  * @param iLc	lkonf_context to use.
  * @return	Error string, or 0 if iLc is 0.
+ *		Valid until the next operation on iLc.
  */
 LUA_API const char *
 lkonf_get_error_string(lkonf_context * iLc);
 
 
+/**
+ * Set the error of iLc, for wrappers that check values further.
+ * @param iLc		lkonf_context to use.
+ * @param iCode		Error code.
+ * @param iString	Error string, valid until the next operation on iLc,
+ *			or 0 for lkonf_error_to_string(iCode).
+ * @return		iCode, or LK_INVALID_ARGUMENT if iLc is 0.
+ */
+LUA_API lkonf_error
+lkonf_set_error_code(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString);
+
+
 /**
  * Error string description of lkonf_error.
  * @param iError	Error code.
@@ -165,6 +471,27 @@ LUA_API lkonf_error
 lkonf_load_string(lkonf_context * iLc, const char * iString);
 
 
+/**
+ * Load a precompiled (binary) Lua chunk, as generated by lkonf-embed,
+ * and execute in the sandbox.
+ * The chunk is read in place, without copying, and isn't retained.
+ * The chunk must have been compiled by the same version of Lua;
+ * otherwise the load fails with LK_LUA_ERROR.
+ * @param iLc		lkonf_context.
+ * @param iChunk	Binary chunk.
+ * @param iLen		Length of iChunk.
+ * @param iName		Chunk name for error messages, or NULL.
+ * @return		Error code, or LK_OK if ok.
+ *			LK_INVALID_ARGUMENT if iChunk isn't a binary chunk.
+ */
+LUA_API lkonf_error
+lkonf_load_embedded(
+	lkonf_context *	iLc,
+	const void *	iChunk,
+	size_t		iLen,
+	const char *	iName);
+
+
 	/*
 	 * Sandboxing and instruction limits.
 	 */
@@ -180,6 +507,10 @@ lkonf_get_instruction_limit(lkonf_context * iLc);
 
 /**
  * Set the instruction limit.
+ * The limit applies to each chunk load or function call,
+ * and is checked every limit/8 instructions, or every 1000 if fewer.
+ * A call is never stopped before the limit,
+ * but may run up to a quarter of the limit (at most 2000 instructions) over.
  * @param iLc		lkonf_context.
  * @param iLimit	Limit to set.  0 is no limit.
  * @return		Error code, or LK_OK if ok.
@@ -188,6 +519,138 @@ LUA_API lkonf_error
 lkonf_set_instruction_limit(lkonf_context * iLc, const int iLimit);
 
 
+/**
+ * Get the current instruction budget.
+ * @param iLc	lkonf_context.
+ * @return	Instruction budget in iLc. -1 if iLc is 0.
+ */
+LUA_API long
+lkonf_get_instruction_budget(lkonf_context * iLc);
+
+
+/**
+ * Set the instruction budget.
+ * Unlike the instruction limit, the budget applies across all
+ * chunk loads and function calls, until the instruction count is
+ * reset with lkonf_reset_instruction_count().
+ * @param iLc		lkonf_context.
+ * @param iBudget	Budget to set.  0 is no budget.
+ * @return		Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_set_instruction_budget(lkonf_context * iLc, const long iBudget);
+
+
+/**
+ * Get the instruction count.
+ * The count is accurate to the granularity of the limits (at most 1000).
+ * @param iLc	lkonf_context.
+ * @return	Instructions counted since construction or the last
+ *		lkonf_reset_instruction_count(). -1 if iLc is 0.
+ */
+LUA_API long
+lkonf_get_instruction_count(lkonf_context * iLc);
+
+
+/**
+ * Reset the instruction count to 0, starting a new budget.
+ * @param iLc	lkonf_context.
+ * @return	Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_reset_instruction_count(lkonf_context * iLc);
+
+
+/**
+ * Get the current time limit.
+ * @param iLc	lkonf_context.
+ * @return	Time limit in microseconds in iLc. -1 if iLc is 0.
+ */
+LUA_API long
+lkonf_get_time_limit(lkonf_context * iLc);
+
+
+/**
+ * Set the time limit.
+ * The limit applies to each chunk load or function call,
+ * which fails with LK_DEADLINE_EXCEEDED if it runs for longer.
+ * The time is checked with CLOCK_MONOTONIC every 1000 instructions or less,
+ * so time spent in C functions or garbage collection is included
+ * but can't be interrupted until Lua code resumes.
+ * @param iLc		lkonf_context.
+ * @param iLimit	Limit to set, in microseconds.  0 is no limit.
+ * @return		Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_set_time_limit(lkonf_context * iLc, const long iLimit);
+
+
+/**
+ * Get the current deadline.
+ * @param iLc	lkonf_context.
+ * @return	Deadline in iLc. 0 if none or iLc is 0.
+ */
+LUA_API uint64_t
+lkonf_get_deadline(lkonf_context * iLc);
+
+
+/**
+ * Set the deadline.
+ * Chunk loads and function calls fail with LK_DEADLINE_EXCEEDED
+ * if running after the deadline, as per lkonf_set_time_limit().
+ * The earlier of the deadline and the time limit applies to each call.
+ * @param iLc		lkonf_context.
+ * @param iDeadline	Deadline to set, in CLOCK_MONOTONIC nanoseconds.
+ *			0 is no deadline.
+ * @return		Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_set_deadline(lkonf_context * iLc, const uint64_t iDeadline);
+
+
+/**
+ * Interrupt the chunk load or function call running in iLc.
+ * May be called from another thread or a signal handler;
+ * only sets a flag, and doesn't change the error state of iLc.
+ * The running operation fails with LK_INTERRUPTED within 1000 instructions.
+ * With LuaJIT and no limits set, JIT-compiled code doesn't check,
+ * so the operation is interrupted only when interpreted code next runs.
+ * If no operation is running, the next one to run Lua code is interrupted.
+ * @param iLc	lkonf_context.
+ * @return	Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_interrupt(lkonf_context * iLc);
+
+
+/**
+ * Seal the table at iPath, and the tables it contains, making them read-only.
+ * Tables that are the __index of a table's metatable are sealed too.
+ * Tables are sealed in place, so references to them remain valid.
+ * Later assignments to sealed tables raise a Lua error,
+ * including from function-valued keys and subsequently loaded chunks.
+ * If iPath is "" the globals table is sealed. If everything is sealed,
+ * cached lookups (see lkonf_set_value_cache()) survive function calls,
+ * unless a sealed table's metatable has an __index function.
+ * Sealed functions rawset(), debug.setmetatable() and, before Lua 5.3,
+ * table.insert(), table.remove() and table.sort() are replaced by
+ * versions that reject sealed tables, and debug.getmetatable() by one
+ * that doesn't return their metatable; references to the originals
+ * taken before sealing are not.
+ * Raw reads such as rawget() and next() see sealed tables as empty.
+ * With Lua 5.1 and LuaJIT, so do the length operator, pairs() and
+ * ipairs(); lkonf_iter_next() sees their contents with every version.
+ * Sealing visits every table once and creates two tables for each,
+ * so it is linear in the size of the subtree but not cheap:
+ * about 35 ms for 10^5 nodes with Lua 5.1.
+ * @param iLc	lkonf_context.
+ * @param iPath	Path to table, or "" for the globals table.
+ * @return	Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_seal(lkonf_context * iLc, const char * iPath);
+
+
 /**
  * Copy the iKeys from iSrcIdx to iDstIdx..
  * @param	iLc	lkonf_context.
@@ -195,6 +658,7 @@ lkonf_set_instruction_limit(lkonf_context * iLc, const int iLimit);
  * @param	iDstIdx	Index of table to copy to.
  * @param	iKeys	Keys to traverse; array terminated with NULL key.
  * @return		Error code, or LK_OK if ok.
+ *			LK_OUT_OF_RANGE if iDstIdx is sealed.
  */
 LUA_API lkonf_error
 lkonf_copy_table_keys(
@@ -208,12 +672,43 @@ lkonf_copy_table_keys(
 	 * Value retrieval.
 	 */
 
+/**
+ * Get whether values are cached.
+ * @param iLc	lkonf_context.
+ * @return	True if values are cached. False if iLc is 0.
+ */
+LUA_API bool
+lkonf_get_value_cache(lkonf_context * iLc);
+
+
+/**
+ * Set whether values are cached.
+ * If enabled, boolean, number and string values found by the value retrieval
+ * functions are cached by path or keys, so that later lookups of
+ * unchanged values don't use Lua.
+ * Missing values are always cached, unless the table they are missing
+ * from has an __index metamethod.
+ * The cache is invalidated whenever lkonf may have modified the Lua state,
+ * such as loading a chunk or calling a function-valued key,
+ * and by lkonf_get_lua_State().
+ * Function results are not cached.
+ * @param iLc		lkonf_context.
+ * @param iEnable	True to cache values.
+ * @return		Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_set_value_cache(lkonf_context * iLc, const bool iEnable);
+
+
 /**
  * Get boolean value at iPath.
  * The value at iPath must be either a boolean
  * or a function that returns a boolean when called as function(iPath).
  * @param	iLc	lkonf_context.
  * @param	iPath	String of the form "[table[.table[...]].]key".
+ *			A component "[n]" is integer key n;
+ *			a component "n" is integer key n if present,
+ *			otherwise string key "n".
  * @param[out]	oValue	Result.
  * @return	Error code, or LK_OK if oValue populated.
  */
@@ -232,6 +727,19 @@ lkonf_get_boolean(lkonf_context * iLc, const char * iPath, bool * oValue);
 LUA_API lkonf_error
 lkonf_getkey_boolean(lkonf_context * iLc, lkonf_keys iKeys, bool * oValue);
 
+/**
+ * Get boolean value at iKeys, which may contain integer keys.
+ * The value at iKeys must be either a boolean
+ * or a function that returns a boolean when called as function(path),
+ * where path is of the form "table[n].key".
+ * @param	iLc	lkonf_context.
+ * @param	iKeys	Keys to traverse; array terminated with LK_END.
+ * @param[out]	oValue	Result.
+ * @return	Error code, or LK_OK if oValue populated.
+ */
+LUA_API lkonf_error
+lkonf_getikey_boolean(lkonf_context * iLc, lkonf_ikeys iKeys, bool * oValue);
+
 
 /**
  * Get double value at iPath.
@@ -239,6 +747,9 @@ lkonf_getkey_boolean(lkonf_context * iLc, lkonf_keys iKeys, bool * oValue);
  * or a function that returns a double when called as function(iPath).
  * @param	iLc	lkonf_context.
  * @param	iPath	String of the form "[table[.table[...]].]key".
+ *			A component "[n]" is integer key n;
+ *			a component "n" is integer key n if present,
+ *			otherwise string key "n".
  * @param[out]	oValue	Result.
  * @return	Error code, or LK_OK if oValue populated.
  */
@@ -257,6 +768,19 @@ lkonf_get_double(lkonf_context * iLc, const char * iPath, double * oValue);
 LUA_API lkonf_error
 lkonf_getkey_double(lkonf_context * iLc, lkonf_keys iKeys, double * oValue);
 
+/**
+ * Get double value at iKeys, which may contain integer keys.
+ * The value at iKeys must be either a double
+ * or a function that returns a double when called as function(path),
+ * where path is of the form "table[n].key".
+ * @param	iLc	lkonf_context.
+ * @param	iKeys	Keys to traverse; array terminated with LK_END.
+ * @param[out]	oValue	Result.
+ * @return	Error code, or LK_OK if oValue populated.
+ */
+LUA_API lkonf_error
+lkonf_getikey_double(lkonf_context * iLc, lkonf_ikeys iKeys, double * oValue);
+
 
 /**
  * Get integer value at iPath.
@@ -264,6 +788,9 @@ lkonf_getkey_double(lkonf_context * iLc, lkonf_keys iKeys, double * oValue);
  * or a function that returns an integer when called as function(iPath).
  * @param	iLc	lkonf_context.
  * @param	iPath	String of the form "[table[.table[...]].]key".
+ *			A component "[n]" is integer key n;
+ *			a component "n" is integer key n if present,
+ *			otherwise string key "n".
  * @param[out]	oValue	Result.
  * @return	Error code, or LK_OK if oValue populated.
  */
@@ -288,6 +815,22 @@ lkonf_getkey_integer(
 	lkonf_keys	iKeys,
 	lua_Integer *	oValue);
 
+/**
+ * Get integer value at iKeys, which may contain integer keys.
+ * The value at iKeys must be either an integer
+ * or a function that returns an integer when called as function(path),
+ * where path is of the form "table[n].key".
+ * @param	iLc	lkonf_context.
+ * @param	iKeys	Keys to traverse; array terminated with LK_END.
+ * @param[out]	oValue	Result.
+ * @return	Error code, or LK_OK if oValue populated.
+ */
+LUA_API lkonf_error
+lkonf_getikey_integer(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	lua_Integer *	oValue);
+
 
 /**
  * Get string value at iPath.
@@ -296,6 +839,9 @@ lkonf_getkey_integer(
  * Coercion from other types is not supported.
  * @param	iLc	lkonf_context.
  * @param	iPath	String of the form "[table[.table[...]].]key".
+ *			A component "[n]" is integer key n;
+ *			a component "n" is integer key n if present,
+ *			otherwise string key "n".
  * @param[out]	oValue	Result string. Caller must free if return is LK_OK.
  *			Is nul ('\0') terminated, but may contain nul
  *			characters; use oLen to obtain the full length.
@@ -329,6 +875,420 @@ lkonf_getkey_string(
 	char **		oValue,
 	size_t *	oLen);
 
+/**
+ * Get string value at iKeys, which may contain integer keys.
+ * The value at iKeys must be either a string
+ * or a function that returns a string when called as function(path),
+ * where path is of the form "table[n].key".
+ * Coercion from other types is not supported.
+ * @param	iLc	lkonf_context.
+ * @param	iKeys	Keys to traverse; array terminated with LK_END.
+ * @param[out]	oValue	Result string. Caller must free if return is LK_OK.
+ *			Is nul ('\0') terminated, but may contain nul
+ *			characters; use oLen to obtain the full length.
+ * @param[out]	oLen	Length of oValue, if oLen is not NULL.
+ * @return	Error code, or LK_OK if oValue (and possibly oLen) populated.
+ */
+LUA_API lkonf_error
+lkonf_getikey_string(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	char **		oValue,
+	size_t *	oLen);
+
+/**
+ * Get string value at iPath without copying it.
+ * As per lkonf_get_string(), except that oValue is owned by lkonf.
+ * oValue is valid until the next lkonf_load_file(), lkonf_load_string()
+ * or lkonf_load_embedded(), or until the next lkonf_get_string_ref()
+ * of the same path, which replaces it if the value (such as that of
+ * a function) has changed.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	String of the form "[table[.table[...]].]key".
+ * @param[out]	oValue	Result string; not to be freed.
+ *			Is nul ('\0') terminated, but may contain nul
+ *			characters; use oLen to obtain the full length.
+ * @param[out]	oLen	Length of oValue, if oLen is not NULL.
+ * @return	Error code, or LK_OK if oValue (and possibly oLen) populated.
+ */
+LUA_API lkonf_error
+lkonf_get_string_ref(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const char **	oValue,
+	size_t *	oLen);
+
+/**
+ * Get string value at iKeys without copying it.
+ * As per lkonf_getikey_string(), except that oValue is owned by lkonf,
+ * with the lifetime of lkonf_get_string_ref(), replaced by the next
+ * lkonf_getikey_string_ref() of the same keys.
+ * @param	iLc	lkonf_context.
+ * @param	iKeys	Keys to traverse; array terminated with LK_END.
+ * @param[out]	oValue	Result string; not to be freed.
+ * @param[out]	oLen	Length of oValue, if oLen is not NULL.
+ * @return	Error code, or LK_OK if oValue (and possibly oLen) populated.
+ */
+LUA_API lkonf_error
+lkonf_getikey_string_ref(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	const char **	oValue,
+	size_t *	oLen);
+
+/**
+ * Get array of boolean values at iPath.
+ * Reads elements 1 to #t of the table at iPath, each of which must be
+ * a boolean, into oValues.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	String of the form "[table[.table[...]].]key".
+ * @param[out]	oValues	Buffer of *ioLen elements, or NULL to only obtain
+ *			the length.
+ * @param[in,out] ioLen	Capacity of oValues; set to length of the array,
+ *			or if an element is of the wrong type, its index.
+ * @return	Error code, or LK_OK if ioLen (and oValues) populated.
+ *		LK_OUT_OF_RANGE if the array is longer than the buffer,
+ *		with ioLen set to its length.
+ */
+LUA_API lkonf_error
+lkonf_get_boolean_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	bool *	oValues,
+	size_t *	ioLen);
+
+/**
+ * Get array of double values at iPath.
+ * Reads elements 1 to #t of the table at iPath, each of which must be
+ * a double, into oValues.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	String of the form "[table[.table[...]].]key".
+ * @param[out]	oValues	Buffer of *ioLen elements, or NULL to only obtain
+ *			the length.
+ * @param[in,out] ioLen	Capacity of oValues; set to length of the array,
+ *			or if an element is of the wrong type, its index.
+ * @return	Error code, or LK_OK if ioLen (and oValues) populated.
+ *		LK_OUT_OF_RANGE if the array is longer than the buffer,
+ *		with ioLen set to its length.
+ */
+LUA_API lkonf_error
+lkonf_get_double_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	double *	oValues,
+	size_t *	ioLen);
+
+/**
+ * Get array of integer values at iPath.
+ * Reads elements 1 to #t of the table at iPath, each of which must be
+ * an integer, into oValues.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	String of the form "[table[.table[...]].]key".
+ * @param[out]	oValues	Buffer of *ioLen elements, or NULL to only obtain
+ *			the length.
+ * @param[in,out] ioLen	Capacity of oValues; set to length of the array,
+ *			or if an element is of the wrong type, its index.
+ * @return	Error code, or LK_OK if ioLen (and oValues) populated.
+ *		LK_OUT_OF_RANGE if the array is longer than the buffer,
+ *		with ioLen set to its length.
+ */
+LUA_API lkonf_error
+lkonf_get_integer_array(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	lua_Integer *	oValues,
+	size_t *	ioLen);
+
+/**
+ * Get columns of fields from the array of records (tables) at iPath.
+ * Walks records 1 to #t once, filling one buffer per column.
+ * A missing field is set to the fallback value of its column,
+ * or is an error if the column is required.
+ * Function-valued fields are not called.
+ * Strings are owned by lkonf and are valid until the next
+ * lkonf_load_file(), lkonf_load_string() or lkonf_load_embedded(),
+ * or until the next call with iPath finds a different array.
+ * If oRowErrors is not NULL, errors in a record are stored in it
+ * (with its fields set to the fallback values) and don't fail the call.
+ * Otherwise the first error in a record fails the call.
+ * @param	iLc		lkonf_context.
+ * @param	iPath		String of the form "[table[.table[...]].]key".
+ * @param	iCols		Column specifications.
+ * @param	iNumCols	Number of columns in iCols and oColumns.
+ * @param[out]	oColumns	Buffer per column of *ioRows elements,
+ *				of the type per lkonf_column_type,
+ *				or NULL to only obtain the number of rows.
+ * @param[in,out] ioRows	Capacity of buffers; set to number of rows,
+ *				or if oRowErrors is NULL and a record has an
+ *				error, its index.
+ * @param[out]	oRowErrors	Error code per row, or NULL.
+ * @return	Error code, or LK_OK if ioRows (and oColumns) populated.
+ *		LK_OUT_OF_RANGE if the array has more rows than the
+ *		buffers, with ioRows set to the number of rows.
+ */
+LUA_API lkonf_error
+lkonf_get_columns(
+	lkonf_context *			iLc,
+	const char *			iPath,
+	const lkonf_column_spec *	iCols,
+	const size_t			iNumCols,
+	void * const *			oColumns,
+	size_t *			ioRows,
+	lkonf_error *			oRowErrors);
+
+
+/**
+ * Populate the struct oStruct from the table at iRoot, as per iBindings.
+ * The root is found once, and each binding's path is relative to it.
+ * A function value is called as function(path), with the full path.
+ * A missing or invalid value is set to the fallback of its binding;
+ * a missing value is only an error if the binding is required.
+ * A missing optional LK_BIND_STRUCT sets its fields to their fallbacks.
+ * A missing optional array has length 0.
+ * All bindings are processed, even after an error.
+ * Strings are copied, including fallbacks; a NULL fallback string is NULL.
+ * @param	iLc		lkonf_context.
+ * @param	iRoot		Path to table, or "" for the globals table.
+ * @param	iBindings	Bindings.
+ * @param	iNumBindings	Number of bindings in iBindings.
+ * @param[out]	oStruct		Struct to populate.
+ * @param	iReport		Function called for each error, or NULL.
+ * @param	iArg		Argument for iReport.
+ * @return	Error code of the first error, or LK_OK if all ok.
+ */
+LUA_API lkonf_error
+lkonf_bind(
+	lkonf_context *		iLc,
+	const char *		iRoot,
+	const lkonf_binding *	iBindings,
+	const size_t		iNumBindings,
+	void *			oStruct,
+	lkonf_bind_report	iReport,
+	void *			iArg);
+
+
+	/*
+	 * Schema validation.
+	 */
+
+/**
+ * Compile a schema into a validator for lkonf_validate().
+ * The schema is checked, and the keys of each table are indexed,
+ * so validation does a single traversal of the configuration.
+ * The schema is referenced, not copied, and must outlive the validator.
+ * Schemas may be recursive.
+ * @param	iLc		lkonf_context.
+ * @param	iSchema		Schema of the root table; name is ignored.
+ *				Must be LK_SCHEMA_TABLE or LK_SCHEMA_ARRAY.
+ * @param[out]	oValidator	Validator; must be freed with
+ *				lkonf_free_validator() before iLc is destroyed.
+ * @return	Error code, or LK_OK if oValidator populated.
+ */
+LUA_API lkonf_error
+lkonf_compile_schema(
+	lkonf_context *		iLc,
+	const lkonf_schema *	iSchema,
+	lkonf_validator **	oValidator);
+
+/**
+ * Validate the table at iPath against a compiled schema,
+ * checking types, ranges, required keys, unknown keys and array elements.
+ * Function values are not called, and match any type but
+ * LK_SCHEMA_TABLE and LK_SCHEMA_ARRAY.
+ * All violations are found in one traversal.
+ * Errors are set in the lkonf_context of iValidator.
+ * @param	iValidator	Validator.
+ * @param	iPath		Path to table, or "" for the globals table.
+ * @param	iReport		Function called for each violation, or NULL.
+ * @param	iArg		Argument for iReport.
+ * @return	Error code of the first violation, or LK_OK if valid.
+ */
+LUA_API lkonf_error
+lkonf_validate(
+	lkonf_validator *	iValidator,
+	const char *		iPath,
+	lkonf_validate_report	iReport,
+	void *			iArg);
+
+/**
+ * Free a validator.
+ * @param	iValidator	Validator. May be 0.
+ */
+LUA_API void
+lkonf_free_validator(lkonf_validator * iValidator);
+
+
+	/*
+	 * Typed arrays.
+	 */
+
+/**
+ * Provide typed-array constructors u8, i16, i32, i64, f32 and f64
+ * to subsequently loaded chunks.
+ * Each takes a table of numbers, e.g., f64{ 0.5, 1, 2 },
+ * and returns a read-only userdata of packed native values,
+ * which may be indexed from 1 and used with the length operator.
+ * Integer elements must be integral and in range.
+ * @param	iLc	lkonf_context.
+ * @return	Error code, or LK_OK if ok.
+ */
+LUA_API lkonf_error
+lkonf_open_typed_arrays(lkonf_context * iLc);
+
+/**
+ * Get typed array at iPath, without copying.
+ * The value at iPath must be a typed array
+ * or a function that returns a typed array when called as function(iPath).
+ * The array remains valid until the next lkonf_load_file(),
+ * lkonf_load_string() or lkonf_load_embedded(), until the next call
+ * with iPath returns a different array, or until iLc is destroyed.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	String of the form "[table[.table[...]].]key".
+ * @param[out]	oType	Element type.
+ * @param[out]	oData	Elements.
+ * @param[out]	oLen	Number of elements.
+ * @return	Error code, or LK_OK if oType, oData and oLen populated.
+ */
+LUA_API lkonf_error
+lkonf_get_typed_array(
+	lkonf_context *		iLc,
+	const char *		iPath,
+	lkonf_array_type *	oType,
+	const void **		oData,
+	size_t *		oLen);
+
+
+	/*
+	 * Table iteration.
+	 */
+
+/**
+ * Begin iterating the table at iPath.
+ * Sorted key order is cached per table until the Lua state
+ * may have been modified.
+ * The table must not be modified during iteration.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	Path to table, or "" for the globals table.
+ * @param	iMode	lkonf_iter_mode flags.
+ *			If neither LK_ITER_ARRAY nor LK_ITER_HASH,
+ *			LK_ITER_ALL is used.
+ * @param[out]	oIter	Iterator; must be freed with lkonf_iter_end()
+ *			before iLc is destroyed.
+ * @return	Error code, or LK_OK if oIter populated.
+ */
+LUA_API lkonf_error
+lkonf_iter_begin(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	const int	iMode,
+	lkonf_iter **	oIter);
+
+/**
+ * Get the next key and value from an iterator.
+ * Strings in oKey and oValue are owned by the iterator,
+ * and are valid until the next call with iIter.
+ * Function values are not called.
+ * Errors are set in the lkonf_context of iIter.
+ * @param	iIter	Iterator.
+ * @param[out]	oKey	Key.
+ * @param[out]	oValue	Value.
+ * @return	Error code, LK_NOT_FOUND at the end,
+ *		or LK_OK if oKey and oValue populated.
+ */
+LUA_API lkonf_error
+lkonf_iter_next(lkonf_iter * iIter, lkonf_value * oKey, lkonf_value * oValue);
+
+/**
+ * Free an iterator.
+ * @param	iIter	Iterator. May be 0.
+ */
+LUA_API void
+lkonf_iter_end(lkonf_iter * iIter);
+
+
+	/*
+	 * Function calls.
+	 */
+
+/**
+ * Get a reference to the function at iPath, for lkonf_call().
+ * The function is resolved once; the reference keeps it alive
+ * even if a later load replaces the value at iPath.
+ * @param	iLc	lkonf_context.
+ * @param	iPath	Path to function.
+ * @param[out]	oRef	Reference; must be freed with
+ *			lkonf_free_function_ref() before iLc is destroyed.
+ * @return	Error code, or LK_OK if oRef populated.
+ */
+LUA_API lkonf_error
+lkonf_get_function_ref(
+	lkonf_context *		iLc,
+	const char *		iPath,
+	lkonf_function_ref **	oRef);
+
+/**
+ * Call a function with typed arguments and results.
+ * Unlike the getters, the path isn't passed to the function.
+ * Arguments may be LK_TYPE_NIL, LK_TYPE_BOOLEAN, LK_TYPE_NUMBER
+ * or LK_TYPE_STRING; with Lua 5.3 and later, a number whose
+ * integer is equal to its number is passed as an integer.
+ * Missing results are LK_TYPE_NIL and extra results are discarded.
+ * Strings in oResults are owned by iRef,
+ * and are valid until the next call with iRef.
+ * The instruction limit, time limit and deadline apply.
+ * @param	iLc		lkonf_context.
+ * @param	iRef		Function from lkonf_get_function_ref(iLc).
+ * @param	iArgs		Arguments. May be 0 if iNumArgs is 0.
+ * @param	iNumArgs	Number of arguments.
+ * @param[out]	oResults	Results. May be 0 if iNumResults is 0.
+ * @param	iNumResults	Number of results.
+ * @return	Error code, or LK_OK if oResults populated.
+ */
+LUA_API lkonf_error
+lkonf_call(
+	lkonf_context *			iLc,
+	const lkonf_function_ref *	iRef,
+	const lkonf_value *		iArgs,
+	const size_t			iNumArgs,
+	lkonf_value *			oResults,
+	const size_t			iNumResults);
+
+/**
+ * Call a function once per input, as a batch.
+ * The batch runs as a single call, so the instruction limit, time limit
+ * and deadline apply to the whole batch rather than to each element.
+ * Each element is called with one argument and its first result
+ * stored; as per lkonf_call() except that a Lua error fails only that
+ * element, whose output is LK_TYPE_NIL.
+ * If a limit is exceeded or lkonf_interrupt() called, the batch stops,
+ * and later elements of oOutputs and oErrors are not set.
+ * Strings in oOutputs are owned by iRef,
+ * and are valid until the next batch with iRef.
+ * @param	iLc		lkonf_context.
+ * @param	iRef		Function from lkonf_get_function_ref(iLc).
+ * @param	iInputs		Argument of each element.
+ * @param	iCount		Number of elements.
+ * @param[out]	oOutputs	Result of each element.
+ * @param[out]	oErrors		Error code of each element. May be 0.
+ * @return	Error code of the batch or of the first failed element,
+ *		with its error string, or LK_OK if all elements succeeded.
+ */
+LUA_API lkonf_error
+lkonf_call_batch(
+	lkonf_context *			iLc,
+	const lkonf_function_ref *	iRef,
+	const lkonf_value *		iInputs,
+	const size_t			iCount,
+	lkonf_value *			oOutputs,
+	lkonf_error *			oErrors);
+
+/**
+ * Free a function reference.
+ * @param	iRef	Reference. May be 0.
+ */
+LUA_API void
+lkonf_free_function_ref(lkonf_function_ref * iRef);
+
 
 #ifdef  __cplusplus
 } /* extern "C" */
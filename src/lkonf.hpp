@@ -0,0 +1,454 @@
+#ifndef LKONF_HPP
+#define LKONF_HPP 1
+
+/*
+ * Copyright (c) 2014-2015 Luke Mewburn <Luke@Mewburn.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * C++17 wrapper of lkonf.h.
+ * Header only; nothing in it allocates once the configuration is loaded,
+ * except get<std::string>().
+ */
+
+#include <lkonf.h>
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace lkonf {
+
+
+/**
+ * Path split into lkonf_ikeys at compile time.
+ * Components are separated by "." and a component "[n]" is integer key n.
+ * Unlike the paths of lkonf_get_*(), a component "n" is always
+ * string key "n".
+ * Declare as static constexpr, and check valid() with static_assert:
+ * @code
+ *	static constexpr lkonf::path port("server.port");
+ *	static_assert(port.valid(), "invalid path");
+ *	std::optional<int> p = lc.get<int>(port);
+ * @endcode
+ * @tparam N	Size of the path literal, including the nul.
+ */
+template <std::size_t N>
+class path
+{
+public:
+	/** Maximum number of keys in a path of N - 1 characters. */
+	static constexpr std::size_t max_keys = N / 2 + 1;
+
+	/** lkonf_ikeys of the path, terminated with LK_END. */
+	typedef std::array<lkonf_ikey, max_keys + 1> ikeys_type;
+
+	/**
+	 * Split iPath.
+	 * @param iPath	Path literal.
+	 */
+	constexpr path(const char (&iPath)[N])
+	:	names_(),
+		starts_(),
+		indexes_(),
+		count_(0),
+		valid_(N > 1)
+	{
+		std::size_t i = 0;
+		while (valid_ && i < N - 1) {
+			if ('[' == iPath[i]) {
+					/* "[n]", followed by end, "." or "[" */
+				std::size_t j = i + 1;
+				const bool neg = j < N - 1 && '-' == iPath[j];
+				if (neg) {
+					++j;
+				}
+				long long n = 0;
+				const std::size_t digits = j;
+				while (j < N - 1 && iPath[j] >= '0' && iPath[j] <= '9'
+				    && n <= 214748364LL) {
+					n = n * 10 + (iPath[j] - '0');
+					++j;
+				}
+				valid_ = j > digits && j < N - 1 && ']' == iPath[j]
+				    && n <= 2147483647LL + neg
+				    && (0 != i)
+				    && (j + 1 == N - 1 || '.' == iPath[j + 1]
+					|| '[' == iPath[j + 1]);
+				indexes_[count_] = static_cast<int>(neg ? -n : n);
+				++count_;
+				i = j + 1;
+				if (i < N - 1 && '.' == iPath[i]) {
+					++i;
+					valid_ = valid_ && i < N - 1;
+				}
+				continue;
+			}
+
+				/* name, followed by end, "." or "[" */
+			starts_[count_] = i + 1;
+			while (i < N - 1 && '.' != iPath[i] && '[' != iPath[i]) {
+				names_[i] = iPath[i];
+				++i;
+			}
+			valid_ = starts_[count_] != i + 1;
+			++count_;
+			if (i < N - 1 && '.' == iPath[i]) {
+				++i;
+				valid_ = valid_ && i < N - 1;
+			}
+		}
+	}
+
+	/**
+	 * Whether the path is valid.
+	 */
+	constexpr bool
+	valid() const noexcept
+	{
+		return valid_;
+	}
+
+	/**
+	 * lkonf_ikeys of the path.
+	 * The names point into this path, which must outlive them.
+	 * Is a constant expression if this path is static constexpr.
+	 */
+	constexpr ikeys_type
+	ikeys() const noexcept
+	{
+		ikeys_type keys = {};
+		for (std::size_t i = 0; valid_ && i < count_; ++i) {
+			if (starts_[i]) {
+				keys[i].type = LK_KEY_NAME;
+				keys[i].name = &names_[starts_[i] - 1];
+			} else {
+				keys[i].type = LK_KEY_INDEX;
+				keys[i].index = indexes_[i];
+			}
+		}
+		return keys;
+	}
+
+private:
+	/** Names, nul-terminated in place of the separators. */
+	char		names_[N];
+
+	/** Offset + 1 of each name in names_, or 0 if an index. */
+	std::size_t	starts_[max_keys];
+
+	/** Integer key of each index. */
+	int		indexes_[max_keys];
+
+	/** Number of keys. */
+	std::size_t	count_;
+
+	/** Whether the path is valid. */
+	bool		valid_;
+};
+
+
+namespace detail {
+
+/** Overloads of the lkonf getters for paths and lkonf_ikeys. */
+
+inline lkonf_error
+get(lkonf_context * iLc, const char * iPath, bool & oValue)
+{
+	return lkonf_get_boolean(iLc, iPath, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, lkonf_ikeys iKeys, bool & oValue)
+{
+	return lkonf_getikey_boolean(iLc, iKeys, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, const char * iPath, lua_Integer & oValue)
+{
+	return lkonf_get_integer(iLc, iPath, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, lkonf_ikeys iKeys, lua_Integer & oValue)
+{
+	return lkonf_getikey_integer(iLc, iKeys, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, const char * iPath, double & oValue)
+{
+	return lkonf_get_double(iLc, iPath, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, lkonf_ikeys iKeys, double & oValue)
+{
+	return lkonf_getikey_double(iLc, iKeys, &oValue);
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, const char * iPath, std::string_view & oValue)
+{
+	const char *	value = 0;
+	size_t		len = 0;
+	const lkonf_error res = lkonf_get_string_ref(iLc, iPath, &value, &len);
+	if (LK_OK == res) {
+		oValue = std::string_view(value, len);
+	}
+	return res;
+}
+
+inline lkonf_error
+get(lkonf_context * iLc, lkonf_ikeys iKeys, std::string_view & oValue)
+{
+	const char *	value = 0;
+	size_t		len = 0;
+	const lkonf_error res = lkonf_getikey_string_ref(iLc, iKeys, &value, &len);
+	if (LK_OK == res) {
+		oValue = std::string_view(value, len);
+	}
+	return res;
+}
+
+template <typename T>
+struct unsupported : std::false_type
+{
+};
+
+/**
+ * Get the value of type T at iKeys (a path or lkonf_ikeys).
+ * Integers that don't fit in T are LK_OUT_OF_RANGE.
+ */
+template <typename T, typename K>
+std::optional<T>
+get_as(lkonf_context * iLc, K iKeys)
+{
+	if constexpr (std::is_same_v<T, bool>
+	    || std::is_same_v<T, lua_Integer>
+	    || std::is_same_v<T, double>
+	    || std::is_same_v<T, std::string_view>) {
+		T value = T();
+		if (LK_OK != get(iLc, iKeys, value)) {
+			return std::nullopt;
+		}
+		return value;
+	} else if constexpr (std::is_integral_v<T>) {
+		lua_Integer value = 0;
+		if (LK_OK != get(iLc, iKeys, value)) {
+			return std::nullopt;
+		}
+		const T narrow = static_cast<T>(value);
+		if (static_cast<lua_Integer>(narrow) != value
+		    || (value < 0) != (narrow < T())) {
+			lkonf_set_error_code(iLc, LK_OUT_OF_RANGE,
+				"Out of range of type");
+			return std::nullopt;
+		}
+		return narrow;
+	} else if constexpr (std::is_floating_point_v<T>) {
+		double value = 0;
+		if (LK_OK != get(iLc, iKeys, value)) {
+			return std::nullopt;
+		}
+		return static_cast<T>(value);
+	} else if constexpr (std::is_same_v<T, std::string>) {
+		std::string_view value;
+		if (LK_OK != get(iLc, iKeys, value)) {
+			return std::nullopt;
+		}
+		return std::string(value);
+	} else {
+		static_assert(unsupported<T>::value,
+			"lkonf::context::get<T> supports bool, integers,"
+			" floating point, std::string_view and std::string");
+	}
+}
+
+} /* namespace detail */
+
+
+/**
+ * Owner of an lkonf_context.
+ */
+class context
+{
+public:
+	/**
+	 * Construct with lkonf_construct().
+	 * @throw std::bad_alloc if that fails.
+	 */
+	context()
+	:	lc_(lkonf_construct())
+	{
+		if (! lc_) {
+			throw std::bad_alloc();
+		}
+	}
+
+	/**
+	 * Take ownership of iLc, such as from lkonf_construct_static().
+	 */
+	explicit context(lkonf_context * iLc) noexcept
+	:	lc_(iLc)
+	{
+	}
+
+	context(context && ioOther) noexcept
+	:	lc_(std::exchange(ioOther.lc_, nullptr))
+	{
+	}
+
+	context &
+	operator=(context && ioOther) noexcept
+	{
+		if (this != &ioOther) {
+			lkonf_destruct(lc_);
+			lc_ = std::exchange(ioOther.lc_, nullptr);
+		}
+		return *this;
+	}
+
+	context(const context &) = delete;
+
+	context &
+	operator=(const context &) = delete;
+
+	~context()
+	{
+		lkonf_destruct(lc_);
+	}
+
+	/**
+	 * The lkonf_context, for functions not wrapped here.
+	 */
+	lkonf_context *
+	handle() const noexcept
+	{
+		return lc_;
+	}
+
+	/**
+	 * As per lkonf_load_file().
+	 */
+	lkonf_error
+	load_file(const char * iFile) noexcept
+	{
+		return lkonf_load_file(lc_, iFile);
+	}
+
+	/**
+	 * As per lkonf_load_string().
+	 */
+	lkonf_error
+	load_string(const char * iString) noexcept
+	{
+		return lkonf_load_string(lc_, iString);
+	}
+
+	/**
+	 * As per lkonf_load_embedded().
+	 */
+	lkonf_error
+	load_embedded(
+		const void *	iChunk,
+		std::size_t	iLen,
+		const char *	iName = nullptr) noexcept
+	{
+		return lkonf_load_embedded(lc_, iChunk, iLen, iName);
+	}
+
+	/**
+	 * Error code of the most recent operation.
+	 */
+	lkonf_error
+	error_code() const noexcept
+	{
+		return lkonf_get_error_code(lc_);
+	}
+
+	/**
+	 * Error string of the most recent operation.
+	 */
+	const char *
+	error_string() const noexcept
+	{
+		return lkonf_get_error_string(lc_);
+	}
+
+	/**
+	 * Get the value of type T at iPath, parsed at runtime.
+	 * T may be bool, an integer type, a floating point type,
+	 * std::string_view (valid as per lkonf_get_string_ref()),
+	 * or std::string (which is copied).
+	 * @return Value, or std::nullopt on error; see error_code().
+	 */
+	template <typename T>
+	std::optional<T>
+	get(const char * iPath) const
+	{
+		return detail::get_as<T>(lc_, iPath);
+	}
+
+	/**
+	 * Get the value of type T at the compile-time path iPath.
+	 * As per get(const char *).
+	 */
+	template <typename T, std::size_t N>
+	std::optional<T>
+	get(const path<N> & iPath) const
+	{
+		if (! iPath.valid()) {
+			return std::nullopt;
+		}
+		const typename path<N>::ikeys_type keys = iPath.ikeys();
+		return detail::get_as<T>(lc_, keys.data());
+	}
+
+	/**
+	 * Get the value of type T at iPath, or iDefault on error.
+	 */
+	template <typename T, typename P>
+	T
+	get_or(const P & iPath, T iDefault) const
+	{
+		std::optional<T> value = get<T>(iPath);
+		return value ? std::move(*value) : std::move(iDefault);
+	}
+
+private:
+	/** Context; 0 if moved from. */
+	lkonf_context *	lc_;
+};
+
+} /* namespace lkonf */
+
+#endif /* LKONF_HPP */
@@ -0,0 +1,87 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <string.h>
+
+/**
+ * State of read_chunk().
+ */
+typedef struct
+{
+	const void *	chunk;	/** Chunk, or 0 once read. */
+	size_t		len;	/** Length of chunk. */
+} embedded_reader;
+
+/**
+ * lua_Reader returning the whole chunk in one piece, without copying.
+ */
+static const char *
+read_chunk(lua_State * iState, void * iData, size_t * oSize)
+{
+	(void)iState;
+
+	embedded_reader * reader = iData;
+	const char * chunk = reader->chunk;
+
+	*oSize = reader->len;
+	reader->chunk = 0;
+	reader->len = 0;
+
+	return chunk;
+}
+
+lkonf_error
+lkonf_load_embedded(
+	lkonf_context *	iLc,
+	const void *	iChunk,
+	const size_t	iLen,
+	const char *	iName)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! iChunk) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iChunk NULL");
+		return lki_state_exit(iLc);
+	}
+
+	const char * name = iName ? iName : "=embedded";
+
+		/* Binary chunks only, so source is never compiled here. */
+	const size_t siglen = sizeof(LKI_SIGNATURE) - 1;
+	if (iLen < siglen || 0 != memcmp(iChunk, LKI_SIGNATURE, siglen)) {
+		lki_set_error_item(iLc,
+			LK_INVALID_ARGUMENT, "Not a binary chunk", name);
+		return lki_state_exit(iLc);
+	}
+
+		/* Values anchored since the previous load may now be freed. */
+	lki_release_anchors(iLc);
+
+#if LKI_PROBES_ENABLED
+	const uint64_t start =
+	    LKI_PROBE_LOAD_DONE_ENABLED() ? lki_monotonic_time() : 0;
+#endif
+	LKI_PROBE_LOAD_START(name);
+
+	embedded_reader reader = { iChunk, iLen };
+#if LUA_VERSION_NUM >= 502
+	const int res = lua_load(iLc->state, read_chunk, &reader, name, "b");
+#else
+	const int res = lua_load(iLc->state, read_chunk, &reader, name);
+#endif
+	if (res) {
+		lki_set_error_from_state(iLc, LK_LUA_ERROR);
+	} else {
+		lki_call_chunk(iLc, 0, 0);
+	}
+
+	LKI_PROBE_LOAD_DONE(name, iLc->error_code, start);
+
+	return lki_state_exit(iLc);
+}
@@ -18,12 +18,22 @@ lkonf_load_string(lkonf_context * iLc, const char * iString)
 		return lki_state_exit(iLc);
 	}
 
+		/* Values anchored since the previous load may now be freed. */
+	lki_release_anchors(iLc);
+
+#if LKI_PROBES_ENABLED
+	const uint64_t start =
+	    LKI_PROBE_LOAD_DONE_ENABLED() ? lki_monotonic_time() : 0;
+#endif
+	LKI_PROBE_LOAD_START("=string");
+
 	if (luaL_loadstring(iLc->state, iString)) {
 		lki_set_error_from_state(iLc, LK_LUA_ERROR);
-		return lki_state_exit(iLc);
+	} else {
+		lki_call_chunk(iLc, 0, 0);
 	}
 
-	lki_call_chunk(iLc, 0, 0);
+	LKI_PROBE_LOAD_DONE("=string", iLc->error_code, start);
 
 	return lki_state_exit(iLc);
 }
@@ -0,0 +1,223 @@
+#include "internal.h"
+
+#include <string.h>
+
+/**
+ * Fill oValue from the cache entry iEntry.
+ * A string value is pushed, as per from_stack().
+ * @return Error code; LK_NOT_FOUND if the entry is nil.
+ */
+static lkonf_error
+from_cache(
+	lkonf_context *		iLc,
+	const lki_cache_entry *	iEntry,
+	lki_value *		oValue)
+{
+	if (LUA_TNIL == iEntry->value.type) {
+		return lki_set_error(iLc, LK_NOT_FOUND, "");
+	}
+
+	*oValue = iEntry->value;
+	if (LUA_TSTRING == oValue->type) {
+		lua_rawgeti(iLc->state, LUA_REGISTRYINDEX, iEntry->ref);
+	}
+	return LK_OK;
+}
+
+/**
+ * Fill oValue from the value at the top of the stack,
+ * and cache it if appropriate.
+ * @param iLc		Context.
+ * @param iHash		Hash of iKey.
+ * @param iKey		Cache key, or 0 to not cache.
+ * @param iLen		Length of iKey.
+ * @param iCalled	True if the value is a function result.
+ * @param[out] oValue	Value.
+ * @return Error code; LK_NOT_FOUND if the value is nil.
+ */
+static lkonf_error
+from_stack(
+	lkonf_context *	iLc,
+	uint64_t	iHash,
+	const char *	iKey,
+	size_t		iLen,
+	bool		iCalled,
+	lki_value *	oValue)
+{
+	memset(oValue, 0, sizeof(*oValue));
+	oValue->type = lua_type(iLc->state, -1);
+
+	switch (oValue->type) {
+
+	case LUA_TBOOLEAN:
+		oValue->boolean = lua_toboolean(iLc->state, -1);
+		break;
+
+	case LUA_TNUMBER:
+		oValue->number = lua_tonumber(iLc->state, -1);
+		oValue->integral = lki_to_integer(iLc->state, -1,
+			&oValue->integer);
+		break;
+
+	case LUA_TSTRING:
+		oValue->string = lua_tolstring(iLc->state, -1, &oValue->length);
+		break;
+
+	default:
+		break;
+	}
+
+		/*
+		 * Function results aren't cached; the function may return
+		 * something else next time, and has invalidated the cache.
+		 */
+	if (iKey && ! iCalled) {
+		switch (oValue->type) {
+
+		case LUA_TNIL:
+			if (iLc->raw_miss) {
+				lki_cache_add(iLc, iHash, iKey, iLen, oValue);
+			}
+			break;
+
+		case LUA_TBOOLEAN:
+		case LUA_TNUMBER:
+		case LUA_TSTRING:
+			if (iLc->value_cache) {
+				lki_cache_add(iLc, iHash, iKey, iLen, oValue);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (LUA_TNIL == oValue->type) {
+		return lki_set_error(iLc, LK_NOT_FOUND, "");
+	}
+
+	return LK_OK;
+}
+
+lkonf_error
+lki_lookup_path(lkonf_context * iLc, const char * iPath, lki_value * oValue)
+{
+	size_t		len = 0;
+	uint64_t	hash = 0;
+
+	if (iLc->baked) {
+		return lki_static_lookup_path(iLc, iPath, oValue);
+	}
+
+	if (iPath && *iPath) {
+		len = strlen(iPath);
+		hash = lki_cache_hash(iPath, len);
+		const lki_cache_entry * e =
+		    lki_cache_find(iLc, hash, iPath, len);
+		if (e) {
+			return from_cache(iLc, e, oValue);
+		}
+	}
+
+	if (LK_OK != lki_find_table_by_path(iLc, iPath)) {
+		return iLc->error_code;
+	}
+
+	bool called = false;
+	if (lua_isfunction(iLc->state, -1)) {
+		LKI_PROBE_FUNCTION_CALL(iPath, 0);
+		lua_pushstring(iLc->state, iPath);
+		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
+			return iLc->error_code;
+		}
+		called = true;
+	}
+
+	return from_stack(iLc, hash, iPath, len, called, oValue);
+}
+
+lkonf_error
+lki_lookup_keys(lkonf_context * iLc, lkonf_keys iKeys, lki_value * oValue)
+{
+	char		ckey[LKI_CACHE_KEY_MAX];
+	size_t		clen = 0;
+	uint64_t	hash = 0;
+
+	if (iLc->baked) {
+		return lki_static_lookup_keys(iLc, iKeys, oValue);
+	}
+
+	if (iKeys && iKeys[0] && iKeys[0][0]) {
+		clen = lki_cache_keys(iKeys, ckey);
+	}
+	if (clen) {
+		hash = lki_cache_hash(ckey, clen);
+		const lki_cache_entry * e =
+		    lki_cache_find(iLc, hash, ckey, clen);
+		if (e) {
+			return from_cache(iLc, e, oValue);
+		}
+	}
+
+	size_t last = 0;
+	if (LK_OK != lki_find_table_by_keys(iLc, iKeys, &last)) {
+		return iLc->error_code;
+	}
+
+	bool called = false;
+	if (lua_isfunction(iLc->state, -1)) {
+		LKI_PROBE_FUNCTION_CALL(0, iKeys);
+		if (LK_OK != lki_format_keys(iLc, iKeys, 0)) {
+			return iLc->error_code;
+		}
+		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
+			return iLc->error_code;
+		}
+		called = true;
+	}
+
+	return from_stack(iLc, hash, clen ? ckey : 0, clen, called, oValue);
+}
+
+lkonf_error
+lki_lookup_ikeys(lkonf_context * iLc, lkonf_ikeys iKeys, lki_value * oValue)
+{
+	char		ckey[LKI_CACHE_KEY_MAX];
+	size_t		clen = 0;
+	uint64_t	hash = 0;
+
+	if (iLc->baked) {
+		return lki_static_lookup_ikeys(iLc, iKeys, oValue);
+	}
+
+	if (iKeys && LK_KEY_END != iKeys[0].type) {
+		clen = lki_cache_ikeys(iKeys, ckey);
+	}
+	if (clen) {
+		hash = lki_cache_hash(ckey, clen);
+		const lki_cache_entry * e =
+		    lki_cache_find(iLc, hash, ckey, clen);
+		if (e) {
+			return from_cache(iLc, e, oValue);
+		}
+	}
+
+	if (LK_OK != lki_find_table_by_ikeys(iLc, iKeys)) {
+		return iLc->error_code;
+	}
+
+	bool called = false;
+	if (lua_isfunction(iLc->state, -1)) {
+		LKI_PROBE_FUNCTION_CALL(0, 0);
+		if (LK_OK != lki_format_ikeys(iLc, iKeys, 0)) {
+			return iLc->error_code;
+		}
+		if (LK_OK != lki_call_chunk(iLc, 1, 1)) {
+			return iLc->error_code;
+		}
+		called = true;
+	}
+
+	return from_stack(iLc, hash, clen ? ckey : 0, clen, called, oValue);
+}
@@ -0,0 +1,172 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Number of entries probed from the hashed position.
+ */
+#define CACHE_PROBES	8
+
+void
+lki_cache_invalidate(lkonf_context * iLc)
+{
+	++iLc->generation;
+}
+
+uint64_t
+lki_cache_hash(const char * iKey, size_t iLen)
+{
+		/* FNV-1a */
+	uint64_t hash = 14695981039346656037ULL;
+	size_t i;
+	for (i = 0; i < iLen; ++i) {
+		hash ^= (unsigned char)iKey[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+size_t
+lki_cache_keys(lkonf_keys iKeys, char * oKey)
+{
+	size_t len = 0;
+	oKey[len++] = '\0';
+
+	size_t ki;
+	for (ki = 0; iKeys[ki]; ++ki) {
+		const size_t klen = strlen(iKeys[ki]) + 1;
+		if (len + klen > LKI_CACHE_KEY_MAX) {
+			return 0;
+		}
+		memcpy(oKey + len, iKeys[ki], klen);
+		len += klen;
+	}
+
+	return len;
+}
+
+size_t
+lki_cache_ikeys(lkonf_ikeys iKeys, char * oKey)
+{
+	size_t len = 0;
+	oKey[len++] = '\1';
+
+	size_t ki;
+	for (ki = 0; LK_KEY_END != iKeys[ki].type; ++ki) {
+		char		buf[16];
+		const char *	key = buf;
+		char		tag = 'i';
+
+			/* "n" name or "i" index, nul-terminated */
+		if (LK_KEY_INDEX == iKeys[ki].type) {
+			snprintf(buf, sizeof(buf), "%d", iKeys[ki].index);
+		} else if (LK_KEY_NAME == iKeys[ki].type && iKeys[ki].name) {
+			tag = 'n';
+			key = iKeys[ki].name;
+		} else {
+			return 0;
+		}
+
+		const size_t klen = strlen(key) + 1;
+		if (len + 1 + klen > LKI_CACHE_KEY_MAX) {
+			return 0;
+		}
+		oKey[len++] = tag;
+		memcpy(oKey + len, key, klen);
+		len += klen;
+	}
+
+	return len;
+}
+
+const lki_cache_entry *
+lki_cache_find(
+	lkonf_context *	iLc,
+	uint64_t	iHash,
+	const char *	iKey,
+	size_t		iLen)
+{
+	if (! iLc->lookup_cache) {
+		return 0;
+	}
+
+	size_t p;
+	for (p = 0; p < CACHE_PROBES; ++p) {
+		const lki_cache_entry * e =
+		    &iLc->lookup_cache[(iHash + p) % LKI_CACHE_SIZE];
+		if (e->generation == iLc->generation &&
+		    e->hash == iHash &&
+		    e->len == iLen &&
+		    0 == memcmp(e->key, iKey, iLen)) {
+			return e;
+		}
+	}
+
+	return 0;
+}
+
+void
+lki_cache_add(
+	lkonf_context *		iLc,
+	uint64_t		iHash,
+	const char *		iKey,
+	size_t			iLen,
+	const lki_value *	iValue)
+{
+	if (iLen > LKI_CACHE_KEY_MAX) {
+		return;
+	}
+
+	if (! iLc->lookup_cache) {
+		iLc->lookup_cache =
+		    calloc(LKI_CACHE_SIZE, sizeof(*iLc->lookup_cache));
+		if (! iLc->lookup_cache) {
+			return;
+		}
+	}
+
+		/* Use the first stale entry, or evict the hashed position. */
+	lki_cache_entry * e = &iLc->lookup_cache[iHash % LKI_CACHE_SIZE];
+	size_t p;
+	for (p = 0; p < CACHE_PROBES; ++p) {
+		lki_cache_entry * s =
+		    &iLc->lookup_cache[(iHash + p) % LKI_CACHE_SIZE];
+		if (s->generation != iLc->generation) {
+			e = s;
+			break;
+		}
+	}
+
+	if (LUA_TSTRING == e->value.type) {
+		luaL_unref(iLc->state, LUA_REGISTRYINDEX, e->ref);
+	}
+	e->generation = 0;
+	e->value = *iValue;
+
+		/* Reference the Lua string rather than copy it, so that
+		 * a cache hit can push it to be anchored. */
+	if (LUA_TSTRING == iValue->type) {
+		lua_pushvalue(iLc->state, -1);
+		e->ref = luaL_ref(iLc->state, LUA_REGISTRYINDEX);
+	}
+
+	e->generation = iLc->generation;
+	e->hash = iHash;
+	e->len = iLen;
+	memcpy(e->key, iKey, iLen);
+}
+
+void
+lki_cache_free(lkonf_context * iLc)
+{
+	if (! iLc->lookup_cache) {
+		return;
+	}
+
+	free(iLc->lookup_cache);
+	iLc->lookup_cache = 0;
+}
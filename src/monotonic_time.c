@@ -0,0 +1,15 @@
+#include "internal.h"
+
+#include <time.h>
+
+uint64_t
+lki_monotonic_time(void)
+{
+	struct timespec ts;
+
+	if (0 != clock_gettime(CLOCK_MONOTONIC, &ts)) {
+		return 0;
+	}
+
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,26 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_open_typed_arrays(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	lki_push_globals(iLc->state);		/* S: g */
+
+	if (lki_is_sealed(iLc->state, -1)) {
+		lki_set_error(iLc, LK_OUT_OF_RANGE, "Globals sealed");
+		return lki_state_exit(iLc);
+	}
+
+	lki_open_typed_arrays(iLc->state, lua_gettop(iLc->state));
+
+	lki_cache_invalidate(iLc);
+
+	return lki_state_exit(iLc);
+}
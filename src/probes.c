@@ -0,0 +1,19 @@
+#include "internal.h"
+
+#if LKI_PROBES_ENABLED
+
+/*
+ * Semaphores of the probes, declared in probes.h;
+ * incremented by tracers when they attach.
+ */
+#define LKI_PROBE_SEMAPHORE_DEFINE(n) \
+	LKI_PROBE_SEMAPHORE(n) __attribute__((section(".probes"))) = 0
+
+LKI_PROBE_SEMAPHORE_DEFINE(load__start);
+LKI_PROBE_SEMAPHORE_DEFINE(load__done);
+LKI_PROBE_SEMAPHORE_DEFINE(lookup);
+LKI_PROBE_SEMAPHORE_DEFINE(function__call);
+LKI_PROBE_SEMAPHORE_DEFINE(instruction__limit);
+LKI_PROBE_SEMAPHORE_DEFINE(error);
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef LKONF_PROBES_H
+#define LKONF_PROBES_H 1
+
+/*
+ * Copyright (c) 2014-2015 Luke Mewburn <Luke@Mewburn.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * USDT static probes in provider "lkonf".
+ * Enabled with configure --enable-usdt, which defines LKONF_USDT.
+ * Otherwise the probes expand to nothing.
+ * Do not include directly; included by internal.h.
+ */
+
+#if defined(LKONF_USDT)
+
+/*
+ * Each probe has a semaphore, defined in probes.c, that is nonzero
+ * while a tracer is attached to it, so costly arguments can be
+ * computed only when needed.
+ */
+#define _SDT_HAS_SEMAPHORES	1
+
+#include <sys/sdt.h>
+
+/**
+ * Probes are available.
+ */
+#define LKI_PROBES_ENABLED	1
+
+/**
+ * Semaphore of probe n.
+ */
+#define LKI_PROBE_SEMAPHORE(n) \
+	unsigned short lkonf_##n##_semaphore \
+	    __attribute__((visibility("hidden")))
+
+extern LKI_PROBE_SEMAPHORE(load__start);
+extern LKI_PROBE_SEMAPHORE(load__done);
+extern LKI_PROBE_SEMAPHORE(lookup);
+extern LKI_PROBE_SEMAPHORE(function__call);
+extern LKI_PROBE_SEMAPHORE(instruction__limit);
+extern LKI_PROBE_SEMAPHORE(error);
+
+/**
+ * True if a tracer is attached to load__done.
+ */
+#define LKI_PROBE_LOAD_DONE_ENABLED() \
+	__builtin_expect(lkonf_load__done_semaphore, 0)
+
+/**
+ * Chunk load starting.
+ * @param file	Filename, "=string" for lkonf_load_string(),
+ *		or chunk name for lkonf_load_embedded().
+ */
+#define LKI_PROBE_LOAD_START(file) \
+	DTRACE_PROBE1(lkonf, load__start, (file))
+
+/**
+ * Chunk load finished.
+ * Fired with the elapsed time in nanoseconds, if start is set.
+ * @param file		Filename, "=string" for lkonf_load_string(),
+ *			or chunk name for lkonf_load_embedded().
+ * @param code		lkonf_error result.
+ * @param start		lki_monotonic_time() at the start of the load
+ *			if LKI_PROBE_LOAD_DONE_ENABLED(), otherwise 0.
+ */
+#define LKI_PROBE_LOAD_DONE(file, code, start) \
+	do { \
+		if (LKI_PROBE_LOAD_DONE_ENABLED() && (start)) { \
+			DTRACE_PROBE3(lkonf, load__done, (file), (int)(code), \
+			    lki_monotonic_time() - (start)); \
+		} \
+	} while (0)
+
+/**
+ * Value lookup finished.
+ * @param path	Path for lkonf_get_*(), or NULL.
+ * @param keys	Keys for lkonf_getkey_*(), or NULL.
+ * @param type	Requested type: "boolean", "double", "integer", "string".
+ * @param code	lkonf_error result.
+ */
+#define LKI_PROBE_LOOKUP(path, keys, type, code) \
+	DTRACE_PROBE4(lkonf, lookup, (path), (keys), (type), (int)(code))
+
+/**
+ * Calling a function-valued key.
+ * @param path	Path for lkonf_get_*(), or NULL.
+ * @param keys	Keys for lkonf_getkey_*(), or NULL.
+ */
+#define LKI_PROBE_FUNCTION_CALL(path, keys) \
+	DTRACE_PROBE2(lkonf, function__call, (path), (keys))
+
+/**
+ * Instruction limit exceeded.
+ * @param state	Lua state.
+ */
+#define LKI_PROBE_INSTRUCTION_LIMIT(state) \
+	DTRACE_PROBE1(lkonf, instruction__limit, (state))
+
+/**
+ * Error set.
+ * The error string isn't formatted; the message and item are provided.
+ * @param code		lkonf_error.
+ * @param message	Error message.
+ * @param item		Error item; a path, Lua error,
+ *			or the first of the nul-separated keys.
+ */
+#define LKI_PROBE_ERROR(code, message, item) \
+	DTRACE_PROBE3(lkonf, error, (int)(code), (message), (item))
+
+#else /* ! LKONF_USDT */
+
+#define LKI_PROBES_ENABLED	0
+
+#define LKI_PROBE_LOAD_DONE_ENABLED()			0
+#define LKI_PROBE_LOAD_START(file)			do { } while (0)
+#define LKI_PROBE_LOAD_DONE(file, code, start)		do { } while (0)
+#define LKI_PROBE_LOOKUP(path, keys, type, code)	do { } while (0)
+#define LKI_PROBE_FUNCTION_CALL(path, keys)		do { } while (0)
+#define LKI_PROBE_INSTRUCTION_LIMIT(state)		do { } while (0)
+#define LKI_PROBE_ERROR(code, message, item)		do { } while (0)
+
+#endif /* ! LKONF_USDT */
+
+#endif /* LKONF_PROBES_H */
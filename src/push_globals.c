@@ -0,0 +1,11 @@
+#include "internal.h"
+
+void
+lki_push_globals(lua_State * iState)
+{
+#if LUA_VERSION_NUM >= 502
+	lua_pushglobaltable(iState);
+#else
+	lua_pushvalue(iState, LUA_GLOBALSINDEX);
+#endif
+}
@@ -0,0 +1,36 @@
+#include "internal.h"
+
+bool
+lki_push_value(lua_State * iState, const lkonf_value * iValue)
+{
+	switch (iValue->type) {
+
+	case LK_TYPE_NIL:
+		lua_pushnil(iState);
+		return true;
+
+	case LK_TYPE_BOOLEAN:
+		lua_pushboolean(iState, iValue->boolean);
+		return true;
+
+	case LK_TYPE_NUMBER:
+#if LUA_VERSION_NUM >= 503
+		if ((lua_Number)iValue->integer == iValue->number) {
+			lua_pushinteger(iState, iValue->integer);
+			return true;
+		}
+#endif
+		lua_pushnumber(iState, iValue->number);
+		return true;
+
+	case LK_TYPE_STRING:
+		if (! iValue->string) {
+			return false;
+		}
+		lua_pushlstring(iState, iValue->string, iValue->length);
+		return true;
+
+	default:
+		return false;
+	}
+}
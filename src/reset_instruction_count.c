@@ -0,0 +1,16 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_reset_instruction_count(lkonf_context * iLc)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lki_reset_error(iLc);
+
+	iLc->instruction_count = 0;
+	iLc->call_start = 0;
+
+	return LK_OK;
+}
@@ -0,0 +1,452 @@
+#include "internal.h"
+
+/**
+ * __newindex metamethod of a sealed table; rejects the assignment.
+ * Raised with lua_error() rather than luaL_error(),
+ * so the message isn't prefixed with the location of the assignment.
+ */
+static int
+reject_write(lua_State * iState)
+{
+	if (lua_type(iState, 2) == LUA_TSTRING) {
+		lua_pushfstring(iState, "Sealed table: cannot assign '%s'",
+			lua_tostring(iState, 2));
+	} else {
+		lua_pushliteral(iState, "Sealed table: cannot assign");
+	}
+	return lua_error(iState);
+}
+
+
+/**
+ * Call the function in upvalue 1 with the arguments,
+ * returning its results.
+ */
+static int
+call_guarded(lua_State * iState)
+{
+	lua_pushvalue(iState, lua_upvalueindex(1));	/* S: args... f */
+	lua_insert(iState, 1);				/* S: f args... */
+	lua_call(iState, lua_gettop(iState) - 1, LUA_MULTRET);
+	return lua_gettop(iState);
+}
+
+
+/**
+ * Guard for a function that writes to its first argument raw,
+ * such as rawset(); rejects sealed tables.
+ */
+static int
+guard_write(lua_State * iState)
+{
+	if (lki_is_sealed(iState, 1)) {
+		return reject_write(iState);
+	}
+	return call_guarded(iState);
+}
+
+
+/**
+ * Guard for debug.getmetatable(); returns the __metatable field
+ * for sealed tables, as getmetatable() does, so the storage
+ * isn't exposed.
+ */
+static int
+guard_getmetatable(lua_State * iState)
+{
+	if (lki_is_sealed(iState, 1)) {
+		lua_pushliteral(iState, "sealed");
+		return 1;
+	}
+	return call_guarded(iState);
+}
+
+
+#if LUA_VERSION_NUM >= 502
+/**
+ * __len metamethod of a sealed table; returns the length of the storage.
+ */
+static int
+storage_len(lua_State * iState)
+{
+	lki_push_storage(iState, 1);			/* S: s */
+	lua_pushinteger(iState, (lua_Integer)lua_rawlen(iState, -1));
+	return 1;
+}
+
+
+/**
+ * Iterator function returned by storage_pairs().
+ */
+static int
+storage_next(lua_State * iState)
+{
+	lua_settop(iState, 2);				/* S: s k */
+	if (lua_next(iState, 1)) {			/* S: s k v */
+		return 2;
+	}
+	lua_pushnil(iState);				/* S: s nil */
+	return 1;
+}
+
+
+/**
+ * __pairs metamethod of a sealed table; iterates the storage.
+ */
+static int
+storage_pairs(lua_State * iState)
+{
+	lua_pushcfunction(iState, &storage_next);	/* S: t f */
+	lki_push_storage(iState, 1);			/* S: t f s */
+	lua_pushnil(iState);				/* S: t f s nil */
+	return 3;
+}
+#endif
+
+
+#if LUA_VERSION_NUM == 502
+/**
+ * Iterator function returned by storage_ipairs().
+ */
+static int
+storage_inext(lua_State * iState)
+{
+	const int i = (int)lua_tointeger(iState, 2) + 1;
+	lua_pushinteger(iState, i);			/* S: s i i+1 */
+	lua_rawgeti(iState, 1, i);			/* S: s i i+1 v */
+	return lua_isnil(iState, -1) ? 1 : 2;
+}
+
+
+/**
+ * __ipairs metamethod of a sealed table; iterates the storage.
+ * Lua 5.3 and later ipairs() use the __index metamethod instead.
+ */
+static int
+storage_ipairs(lua_State * iState)
+{
+	lua_pushcfunction(iState, &storage_inext);	/* S: t f */
+	lki_push_storage(iState, 1);			/* S: t f s */
+	lua_pushinteger(iState, 0);			/* S: t f s 0 */
+	return 3;
+}
+#endif
+
+
+/**
+ * Values pushed once by lkonf_seal() for seal_table(),
+ * so that each table sealed doesn't intern the metamethod names
+ * or create the metamethod closures again.
+ * Offsets from the stack index of the first.
+ */
+enum
+{
+	SEAL_VISITED,		/** Table of tables already visited. */
+	SEAL_INDEX,		/** "__index" */
+	SEAL_NEWINDEX,		/** "__newindex" */
+	SEAL_WRITE,		/** reject_write() */
+	SEAL_METATABLE,		/** "__metatable" */
+	SEAL_NAME,		/** "sealed" */
+	SEAL_SEALED,		/** "__sealed" */
+	SEAL_OPEN,		/** "__open" */
+	SEAL_GUARDS,		/** Table of guards by function guarded. */
+#if LUA_VERSION_NUM >= 502
+	SEAL_LEN_KEY,		/** "__len" */
+	SEAL_LEN,		/** storage_len() */
+	SEAL_PAIRS_KEY,		/** "__pairs" */
+	SEAL_PAIRS,		/** storage_pairs() */
+#endif
+#if LUA_VERSION_NUM == 502
+	SEAL_IPAIRS_KEY,	/** "__ipairs" */
+	SEAL_IPAIRS,		/** storage_ipairs() */
+#endif
+	SEAL_COUNT		/** Number of values. */
+};
+
+/**
+ * Number of fields in the metatable of a sealed table, without __open.
+ */
+#if LUA_VERSION_NUM == 502
+#define SEAL_FIELDS	7
+#elif LUA_VERSION_NUM >= 503
+#define SEAL_FIELDS	6
+#else
+#define SEAL_FIELDS	4
+#endif
+
+
+/**
+ * Push the values used by seal_table().
+ * @param iState	Lua state.
+ * @return		Stack index of the first.
+ */
+static int
+push_seal_values(lua_State * iState)
+{
+	lua_newtable(iState);
+	lua_pushliteral(iState, "__index");
+	lua_pushliteral(iState, "__newindex");
+	lua_pushcfunction(iState, &reject_write);
+	lua_pushliteral(iState, "__metatable");
+	lua_pushliteral(iState, "sealed");
+	lua_pushliteral(iState, "__sealed");
+	lua_pushliteral(iState, "__open");
+	lua_newtable(iState);
+#if LUA_VERSION_NUM >= 502
+	lua_pushliteral(iState, "__len");
+	lua_pushcfunction(iState, &storage_len);
+	lua_pushliteral(iState, "__pairs");
+	lua_pushcfunction(iState, &storage_pairs);
+#endif
+#if LUA_VERSION_NUM == 502
+	lua_pushliteral(iState, "__ipairs");
+	lua_pushcfunction(iState, &storage_ipairs);
+#endif
+	return lua_gettop(iState) - SEAL_COUNT + 1;
+}
+
+
+/**
+ * Add a guard for the C function iName of the library iLib
+ * in the globals, or of the globals if iLib is NULL,
+ * that seal_table() puts in place of the function.
+ * Looked up raw, so no metamethods run.
+ * @param iState	Lua state.
+ * @param iBase		Stack index of the values from push_seal_values().
+ * @param iLib		Name of library, or NULL.
+ * @param iName		Name of function.
+ * @param iGuard	Guard, called with the function as upvalue 1.
+ */
+static void
+add_guard(lua_State * iState, const int iBase, const char * iLib,
+	const char * iName, lua_CFunction iGuard)
+{
+	lki_push_globals(iState);			/* S: g */
+	if (iLib) {
+		lki_push_storage(iState, -1);		/* S: g g */
+		lua_pushstring(iState, iLib);		/* S: g g k */
+		lua_rawget(iState, -2);			/* S: g g l */
+		lua_remove(iState, -2);			/* S: g l */
+		lua_remove(iState, -2);			/* S: l */
+		if (! lua_istable(iState, -1)) {
+			lua_pop(iState, 1);		/* S: */
+			return;
+		}
+	}
+	lki_push_storage(iState, -1);			/* S: l l */
+	lua_pushstring(iState, iName);			/* S: l l k */
+	lua_rawget(iState, -2);				/* S: l l f */
+	if (lua_iscfunction(iState, -1)) {
+		lua_pushvalue(iState, -1);		/* S: l l f f */
+		lua_pushcclosure(iState, iGuard, 1);	/* S: l l f g */
+		lua_rawset(iState, iBase + SEAL_GUARDS);	/* S: l l */
+		lua_pop(iState, 2);			/* S: */
+	} else {
+		lua_pop(iState, 3);			/* S: */
+	}
+}
+
+
+/**
+ * Add guards for the standard library functions that write
+ * tables raw, or would expose the storage of sealed tables.
+ * Before Lua 5.3, the table library writes raw.
+ * @param iState	Lua state.
+ * @param iBase		Stack index of the values from push_seal_values().
+ */
+static void
+add_guards(lua_State * iState, const int iBase)
+{
+	add_guard(iState, iBase, NULL, "rawset", &guard_write);
+	add_guard(iState, iBase, "debug", "setmetatable", &guard_write);
+	add_guard(iState, iBase, "debug", "getmetatable", &guard_getmetatable);
+#if LUA_VERSION_NUM < 503
+	add_guard(iState, iBase, "table", "insert", &guard_write);
+	add_guard(iState, iBase, "table", "remove", &guard_write);
+	add_guard(iState, iBase, "table", "sort", &guard_write);
+#endif
+}
+
+
+/**
+ * Set t[k] = v, for the table t at the top of the stack,
+ * where k and v are values pushed by push_seal_values().
+ */
+static void
+set_seal_field(lua_State * iState, const int iBase, const int iKey, const int iValue)
+{
+	lua_pushvalue(iState, iBase + iKey);		/* S: t k */
+	lua_pushvalue(iState, iBase + iValue);		/* S: t k v */
+	lua_rawset(iState, -3);				/* S: t */
+}
+
+
+/**
+ * Seal the table at the top of the stack, and the tables it contains,
+ * including the __index table of its metatable.
+ * The contents are moved to a storage table that becomes the __index
+ * of the table's new metatable, so the table keeps its identity.
+ * A table whose metatable has an __index that isn't a table is marked
+ * __open, as lookups through it may see values that aren't sealed.
+ * Functions with a guard from add_guards() are replaced by the guard.
+ * @param iState	Lua state.
+ * @param iBase		Stack index of the values from push_seal_values().
+ * @param[out] ioOpen	Set to true if any table sealed is open.
+ * @return		False if out of stack space.
+ */
+static bool
+seal_table(lua_State * iState, const int iBase, bool * ioOpen)
+{
+	const int visited = iBase + SEAL_VISITED;
+							/* S: t */
+	if (! lua_checkstack(iState, 8)) {
+		return false;
+	}
+
+	lua_pushvalue(iState, -1);			/* S: t t */
+	lua_rawget(iState, visited);			/* S: t v[t] */
+	const bool seen = ! lua_isnil(iState, -1);
+	lua_pop(iState, 1);				/* S: t */
+	if (seen) {
+		return true;
+	}
+	if (lki_is_sealed(iState, -1)) {
+		if (! lki_is_closed(iState, -1)) {
+			*ioOpen = true;
+		}
+		return true;
+	}
+	lua_pushvalue(iState, -1);			/* S: t t */
+	lua_pushboolean(iState, 1);			/* S: t t true */
+	lua_rawset(iState, visited);			/* S: t */
+
+	bool open = false;
+
+		/*
+		 * Move contents to storage, sealing contained tables.
+		 * The storage is sized for the array part, so moving
+		 * an array doesn't grow it an element at a time.
+		 */
+#if LUA_VERSION_NUM >= 502
+	lua_createtable(iState, (int)lua_rawlen(iState, -1), 0);
+#else
+	lua_createtable(iState, (int)lua_objlen(iState, -1), 0);
+#endif							/* S: t s */
+
+		/*
+		 * The storage gets a copy of the metatable, so that sealing
+		 * the metatable itself doesn't hide its metamethods.
+		 */
+	if (lua_getmetatable(iState, -2)) {		/* S: t s mt */
+		lki_push_storage(iState, -1);		/* S: t s mt m */
+		lua_remove(iState, -2);			/* S: t s m */
+		lua_newtable(iState);			/* S: t s m c */
+		lua_pushnil(iState);			/* S: t s m c nil */
+		while (lua_next(iState, -3)) {		/* S: t s m c k v */
+			if (lua_rawequal(iState, -2, iBase + SEAL_INDEX)) {
+				if (! lua_istable(iState, -1)) {
+					open = true;
+				} else if (! seal_table(iState, iBase,
+						&open)) {
+					lua_pop(iState, 5);	/* S: t */
+					return false;
+				}
+			}
+			lua_pushvalue(iState, -2);	/* S: t s m c k v k */
+			lua_insert(iState, -2);		/* S: t s m c k k v */
+			lua_rawset(iState, -4);		/* S: t s m c k */
+		}
+		lua_remove(iState, -2);			/* S: t s c */
+		lua_setmetatable(iState, -2);		/* S: t s */
+	}
+	lua_pushnil(iState);				/* S: t s nil */
+	while (lua_next(iState, -3)) {			/* S: t s k v */
+		if (lua_istable(iState, -1)
+		    && ! seal_table(iState, iBase, &open)) {
+			lua_pop(iState, 4);		/* S: t */
+			return false;
+		}
+		if (lua_iscfunction(iState, -1)) {
+			lua_pushvalue(iState, -1);	/* S: t s k v v */
+			lua_rawget(iState, iBase + SEAL_GUARDS);	/* S: t s k v g */
+			if (lua_isnil(iState, -1)) {
+				lua_pop(iState, 1);	/* S: t s k v */
+			} else {
+				lua_remove(iState, -2);	/* S: t s k g */
+			}
+		}
+		lua_pushvalue(iState, -2);		/* S: t s k v k */
+		lua_insert(iState, -2);			/* S: t s k k v */
+		lua_rawset(iState, -4);			/* S: t s k */
+		lua_pushvalue(iState, -1);		/* S: t s k k */
+		lua_pushnil(iState);			/* S: t s k k nil */
+		lua_rawset(iState, -5);			/* S: t s k */
+	}
+							/* S: t s */
+	lua_createtable(iState, 0, SEAL_FIELDS + open);	/* S: t s mt */
+	lua_pushvalue(iState, iBase + SEAL_INDEX);	/* S: t s mt k */
+	lua_pushvalue(iState, -3);			/* S: t s mt k s */
+	lua_rawset(iState, -3);				/* S: t s mt */
+	lua_remove(iState, -2);				/* S: t mt */
+	set_seal_field(iState, iBase, SEAL_NEWINDEX, SEAL_WRITE);
+#if LUA_VERSION_NUM >= 502
+	set_seal_field(iState, iBase, SEAL_LEN_KEY, SEAL_LEN);
+	set_seal_field(iState, iBase, SEAL_PAIRS_KEY, SEAL_PAIRS);
+#endif
+#if LUA_VERSION_NUM == 502
+	set_seal_field(iState, iBase, SEAL_IPAIRS_KEY, SEAL_IPAIRS);
+#endif
+	set_seal_field(iState, iBase, SEAL_METATABLE, SEAL_NAME);
+	lua_pushvalue(iState, iBase + SEAL_SEALED);
+	lua_pushboolean(iState, 1);
+	lua_rawset(iState, -3);
+	if (open) {
+		lua_pushvalue(iState, iBase + SEAL_OPEN);
+		lua_pushboolean(iState, 1);
+		lua_rawset(iState, -3);
+		*ioOpen = true;
+	}
+	lua_setmetatable(iState, -2);			/* S: t */
+
+	return true;
+}
+
+
+lkonf_error
+lkonf_seal(lkonf_context * iLc, const char * iPath)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (LK_OK != lki_state_entry(iLc)) {
+		return lki_state_exit(iLc);
+	}
+
+	if (! iPath) {
+		lki_set_error(iLc, LK_INVALID_ARGUMENT, "iPath NULL");
+		return lki_state_exit(iLc);
+	}
+
+	if (! *iPath) {
+		lki_push_globals(iLc->state);		/* S: t */
+	} else if (LK_OK != lki_find_table_by_path(iLc, iPath)) {
+		return lki_state_exit(iLc);
+	} else if (! lua_istable(iLc->state, -1)) {
+		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Not a table", iPath);
+		return lki_state_exit(iLc);
+	}
+
+	const int base = push_seal_values(iLc->state);	/* S: t values... */
+	add_guards(iLc->state, base);
+	lua_pushvalue(iLc->state, base - 1);		/* S: t values... t */
+	bool open = false;
+	if (! seal_table(iLc->state, base, &open)) {
+		lki_set_error_item(iLc, LK_OUT_OF_RANGE, "Too deep", iPath);
+	}
+
+		/* Previously cached lookups may have come from the old tables. */
+	lki_cache_invalidate(iLc);
+
+	return lki_state_exit(iLc);
+}
@@ -0,0 +1,16 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_set_deadline(lkonf_context * iLc, const uint64_t iDeadline)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lki_reset_error(iLc);
+
+	iLc->deadline = iDeadline;
+	lki_update_hook(iLc);
+
+	return LK_OK;
+}
@@ -1,16 +1,51 @@
 #include "internal.h"
 
 #include <assert.h>
-#include <string.h>
 #include <stdio.h>
+#include <string.h>
+
+/**
+ * Set the error code and message, without an item.
+ */
+static void
+set_message(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString)
+{
+	iLc->error_code = iCode;
+	iLc->error_message = iString;
+	iLc->error_item_type = LKI_ITEM_NONE;
+	iLc->error_item_len = 0;
+	iLc->error_formatted = false;
+}
+
+/**
+ * Append iLen bytes of iItem to the error item, truncating if necessary.
+ * @return False if truncated.
+ */
+static bool
+append_item(lkonf_context * iLc, const char * iItem, size_t iLen)
+{
+	const size_t avail = sizeof(iLc->error_item) - iLc->error_item_len;
+	const bool fits = iLen < avail;
+
+	if (! fits) {
+		iLen = avail - 1;
+	}
+	memcpy(iLc->error_item + iLc->error_item_len, iItem, iLen);
+	iLc->error_item_len += iLen;
+	iLc->error_item[iLc->error_item_len] = '\0';
+
+	return fits;
+}
 
 void
 lki_reset_error(lkonf_context * iLc)
 {
 	assert(iLc && "iLc NULL");
 
-	iLc->error_code = LK_OK;
-	memset(iLc->error_string, 0, sizeof(iLc->error_string));
+	set_message(iLc, LK_OK, "");
 }
 
 lkonf_error
@@ -21,8 +56,8 @@ lki_set_error(
 {
 	assert(iLc && "iLc NULL");
 
-	iLc->error_code = iCode;
-	snprintf(iLc->error_string, sizeof(iLc->error_string), "%s", iString);
+	set_message(iLc, iCode, iString);
+	LKI_PROBE_ERROR(iCode, iString, "");
 
 	return iCode;
 }
@@ -33,12 +68,25 @@ lki_set_error_item(
 	const lkonf_error	iCode,
 	const char *		iString,
 	const char *		iItem)
+{
+	return lki_set_error_litem(iLc, iCode, iString,
+		iItem, iItem ? strlen(iItem) : 0);
+}
+
+lkonf_error
+lki_set_error_litem(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iItem,
+	size_t			iLen)
 {
 	assert(iLc && "iLc NULL");
 
-	iLc->error_code = iCode;
-	snprintf(iLc->error_string, sizeof(iLc->error_string),
-		"%s: %s", iString, iItem);
+	set_message(iLc, iCode, iString);
+	iLc->error_item_type = LKI_ITEM_STRING;
+	append_item(iLc, iItem ? iItem : "", iItem ? iLen : 0);
+	LKI_PROBE_ERROR(iCode, iString, iLc->error_item);
 
 	return iCode;
 }
@@ -53,18 +101,84 @@ lki_set_error_keys(
 {
 	assert(iLc && "iLc NULL");
 
-		/* push formatted keys onto stack */
-	iLc->error_code = lki_format_keys(iLc, iKeys, iMaxKeys);
-	if (LK_OK != iLc->error_code)
-		return iLc->error_code;
+	set_message(iLc, iCode, iString);
+	iLc->error_item_type = LKI_ITEM_KEYS;
+	iLc->error_item_keys = 0;
 
-		/* format error */
-	iLc->error_code = iCode;
-	snprintf(iLc->error_string, sizeof(iLc->error_string),
-		"%s: %s", iString, lua_tostring(iLc->state, -1));
+		/* copy keys, nul-separated */
+	size_t ki;
+	for (ki = 0; iKeys && iKeys[ki]; ++ki) {
+		if (iMaxKeys && ki >= iMaxKeys) {
+			break;
+		}
+		if (! append_item(iLc, iKeys[ki], strlen(iKeys[ki]) + 1)) {
+			break;
+		}
+		++iLc->error_item_keys;
+	}
+	LKI_PROBE_ERROR(iCode, iString, iLc->error_item);
 
-		/* pop formatted keys off stack */
-	lua_pop(iLc->state, 1);
+	return iCode;
+}
+
+lkonf_error
+lki_set_error_ikeys(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	lkonf_ikeys		iKeys,
+	size_t			iMaxKeys)
+{
+	assert(iLc && "iLc NULL");
+
+	set_message(iLc, iCode, iString);
+	iLc->error_item_type = LKI_ITEM_STRING;
+
+		/* format as path: name[index].name */
+	size_t ki;
+	for (ki = 0; iKeys && LK_KEY_END != iKeys[ki].type; ++ki) {
+		if (iMaxKeys && ki >= iMaxKeys) {
+			break;
+		}
+		char	buf[16];
+		int	len;
+		if (LK_KEY_INDEX == iKeys[ki].type) {
+			len = snprintf(buf, sizeof(buf), "[%d]", iKeys[ki].index);
+		} else {
+			len = snprintf(buf, sizeof(buf), "%s", ki ? "." : "");
+		}
+		if (! append_item(iLc, buf, (size_t)len)) {
+			break;
+		}
+		if (LK_KEY_NAME == iKeys[ki].type && iKeys[ki].name &&
+		    ! append_item(iLc, iKeys[ki].name, strlen(iKeys[ki].name))) {
+			break;
+		}
+	}
+	LKI_PROBE_ERROR(iCode, iString, iLc->error_item);
+
+	return iCode;
+}
+
+lkonf_error
+lki_set_error_index(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString,
+	const char *		iPath,
+	const size_t		iIndex)
+{
+	assert(iLc && "iLc NULL");
+
+	char index[32];
+	const int len = snprintf(index, sizeof(index), "[%zu]", iIndex);
+
+	set_message(iLc, iCode, iString);
+	iLc->error_item_type = LKI_ITEM_STRING;
+	if (append_item(iLc, iPath ? iPath : "", iPath ? strlen(iPath) : 0)) {
+		append_item(iLc, index, (size_t)len);
+	}
+	LKI_PROBE_ERROR(iCode, iString, iLc->error_item);
 
 	return iCode;
 }
@@ -72,5 +186,15 @@ lki_set_error_keys(
 lkonf_error
 lki_set_error_from_state(lkonf_context * iLc, lkonf_error iCode)
 {
-	return lki_set_error(iLc, iCode, lua_tostring(iLc->state, -1));
+	assert(iLc && "iLc NULL");
+
+	size_t len = 0;
+	const char * str = lua_tolstring(iLc->state, -1, &len);
+
+	set_message(iLc, iCode, 0);
+	iLc->error_item_type = LKI_ITEM_STRING;
+	append_item(iLc, str ? str : "", str ? len : 0);
+	LKI_PROBE_ERROR(iCode, "", iLc->error_item);
+
+	return iCode;
 }
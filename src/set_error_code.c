@@ -0,0 +1,18 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_set_error_code(
+	lkonf_context *		iLc,
+	const lkonf_error	iCode,
+	const char *		iString)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	if (! iString) {
+		iString = lkonf_error_to_string(iCode);
+	}
+
+	return lki_set_error(iLc, iCode, iString);
+}
@@ -0,0 +1,20 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_set_instruction_budget(lkonf_context * iLc, const long iBudget)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lki_reset_error(iLc);
+
+	if (iBudget < 0) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iBudget < 0");
+	}
+
+	iLc->instruction_budget = iBudget;
+	lki_update_hook(iLc);
+
+	return LK_OK;
+}
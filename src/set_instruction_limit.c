@@ -14,6 +14,7 @@ lkonf_set_instruction_limit(lkonf_context * iLc, const int iLimit)
 	}
 
 	iLc->instruction_limit = iLimit;
+	lki_update_hook(iLc);
 
 	return LK_OK;
 }
@@ -0,0 +1,20 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_set_time_limit(lkonf_context * iLc, const long iLimit)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lki_reset_error(iLc);
+
+	if (iLimit < 0) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iLimit < 0");
+	}
+
+	iLc->time_limit = iLimit;
+	lki_update_hook(iLc);
+
+	return LK_OK;
+}
@@ -0,0 +1,16 @@
+#include "internal.h"
+
+lkonf_error
+lkonf_set_value_cache(lkonf_context * iLc, const bool iEnable)
+{
+	if (! iLc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lki_reset_error(iLc);
+
+	iLc->value_cache = iEnable;
+	lki_cache_invalidate(iLc);
+
+	return LK_OK;
+}
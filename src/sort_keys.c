@@ -0,0 +1,160 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Key to sort.
+ */
+typedef struct
+{
+	int		rank;	/* 0 number, 1 string, 2 boolean, 3 other */
+	lua_Number	number;
+	const char *	string;
+	size_t		length;
+	int		index;	/* in unsorted keys array */
+} sort_key;
+
+static int
+compare_keys(const void * iA, const void * iB)
+{
+	const sort_key * a = iA;
+	const sort_key * b = iB;
+
+	if (a->rank != b->rank) {
+		return a->rank - b->rank;
+	}
+
+	switch (a->rank) {
+
+	case 0:
+	case 2:
+		if (a->number != b->number) {
+			return a->number < b->number ? -1 : 1;
+		}
+		break;
+
+	case 1: {
+		const size_t len = a->length < b->length ? a->length : b->length;
+		const int c = memcmp(a->string, b->string, len);
+		if (c) {
+			return c;
+		}
+		if (a->length != b->length) {
+			return a->length < b->length ? -1 : 1;
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+
+		/* Keep traversal order otherwise. */
+	return a->index - b->index;
+}
+
+
+/**
+ * Push the sort cache table, creating a new one if the
+ * Lua state may have been modified since it was created.
+ */
+static void
+push_sort_cache(lkonf_context * iLc)
+{
+	lua_State * ls = iLc->state;
+
+	if (LUA_NOREF != iLc->sort_cache &&
+	    iLc->sort_generation == iLc->generation) {
+		lua_rawgeti(ls, LUA_REGISTRYINDEX, iLc->sort_cache);
+		return;						/* S: c */
+	}
+
+	luaL_unref(ls, LUA_REGISTRYINDEX, iLc->sort_cache);
+
+	lua_newtable(ls);					/* S: c */
+	lua_createtable(ls, 0, 1);				/* S: c mt */
+	lua_pushliteral(ls, "k");
+	lua_setfield(ls, -2, "__mode");
+	lua_setmetatable(ls, -2);				/* S: c */
+	lua_pushvalue(ls, -1);					/* S: c c */
+	iLc->sort_cache = luaL_ref(ls, LUA_REGISTRYINDEX);	/* S: c */
+	iLc->sort_generation = iLc->generation;
+}
+
+
+lkonf_error
+lki_sorted_keys(lkonf_context * iLc)
+{
+	lua_State * ls = iLc->state;
+								/* S: t */
+	push_sort_cache(iLc);					/* S: t c */
+	lua_pushvalue(ls, -2);					/* S: t c t */
+	lua_rawget(ls, -2);					/* S: t c c[t] */
+	if (lua_istable(ls, -1)) {
+		lua_remove(ls, -2);				/* S: t c[t] */
+		return LK_OK;
+	}
+	lua_pop(ls, 1);						/* S: t c */
+
+		/* Collect keys, anchored in an array. */
+	lua_newtable(ls);					/* S: t c u */
+	int n = 0;
+	lua_pushnil(ls);					/* S: t c u nil */
+	while (lua_next(ls, -4)) {				/* S: t c u k v */
+		lua_pop(ls, 1);					/* S: t c u k */
+		lua_pushvalue(ls, -1);				/* S: t c u k k */
+		lua_rawseti(ls, -3, ++n);			/* S: t c u k */
+	}
+
+	sort_key * keys = n ? malloc(n * sizeof(*keys)) : 0;
+	if (n && ! keys) {
+		return lki_set_error(iLc,
+			LK_RESOURCE_EXHAUSTED, "Sorting keys");
+	}
+
+	int i;
+	for (i = 0; i < n; ++i) {
+		lua_rawgeti(ls, -1, i + 1);			/* S: t c u k */
+		sort_key * k = &keys[i];
+		memset(k, 0, sizeof(*k));
+		k->index = i + 1;
+		switch (lua_type(ls, -1)) {
+		case LUA_TNUMBER:
+			k->rank = 0;
+			k->number = lua_tonumber(ls, -1);
+			break;
+		case LUA_TSTRING:
+			k->rank = 1;
+			k->string = lua_tolstring(ls, -1, &k->length);
+			break;
+		case LUA_TBOOLEAN:
+			k->rank = 2;
+			k->number = lua_toboolean(ls, -1);
+			break;
+		default:
+			k->rank = 3;
+			break;
+		}
+		lua_pop(ls, 1);					/* S: t c u */
+	}
+
+	qsort(keys, n, sizeof(*keys), &compare_keys);
+
+		/* Build sorted array and cache it. */
+	lua_createtable(ls, n, 0);				/* S: t c u s */
+	for (i = 0; i < n; ++i) {
+		lua_rawgeti(ls, -2, keys[i].index);		/* S: t c u s k */
+		lua_rawseti(ls, -2, i + 1);			/* S: t c u s */
+	}
+	free(keys);
+
+	lua_remove(ls, -2);					/* S: t c s */
+	lua_pushvalue(ls, -3);					/* S: t c s t */
+	lua_pushvalue(ls, -2);					/* S: t c s t s */
+	lua_rawset(ls, -4);					/* S: t c s */
+	lua_remove(ls, -2);					/* S: t s */
+
+	return LK_OK;
+}
@@ -30,7 +30,7 @@ lki_state_exit(lkonf_context * iLc)
 	}
 
 	if (! iLc->state) {
-		if (! iLc->error_code) {
+		if (! iLc->error_code && ! iLc->baked) {
 			lki_set_error(iLc,
 				LK_INVALID_ARGUMENT, "Lua state NULL");
 		}
@@ -49,3 +49,33 @@ lki_state_exit(lkonf_context * iLc)
 
 	return iLc->error_code;
 }
+
+lkonf_error
+lki_lookup_entry(lkonf_context * iLc)
+{
+	if (iLc && iLc->baked) {
+		lki_reset_error(iLc);
+		iLc->depth = -1;
+		return LK_OK;
+	}
+
+	return lki_state_entry(iLc);
+}
+
+lkonf_error
+lki_lookup_exit(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	lkonf_keys	iKeys,
+	const char *	iType)
+{
+	(void)iPath;	/* UNUSED if ! LKONF_USDT */
+	(void)iKeys;	/* UNUSED if ! LKONF_USDT */
+	(void)iType;	/* UNUSED if ! LKONF_USDT */
+
+	const lkonf_error code = lki_state_exit(iLc);
+
+	LKI_PROBE_LOOKUP(iPath, iKeys, iType, code);
+
+	return code;
+}
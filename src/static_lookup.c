@@ -0,0 +1,280 @@
+#include "internal.h"
+
+#include <string.h>
+
+/**
+ * Compare iNode to the key iName[0..iLen), or iIndex if iName is 0,
+ * in the order of lkonf_static_node children.
+ * @return <0, 0 or >0 if iNode is before, at or after the key.
+ */
+static int
+compare(
+	const lkonf_static_node *	iNode,
+	const char *			iName,
+	const size_t			iLen,
+	const int			iIndex)
+{
+	if (! iNode->name) {
+		if (iName) {
+			return -1;
+		}
+		return iNode->index < iIndex ? -1 : iNode->index > iIndex;
+	}
+
+	if (! iName) {
+		return 1;
+	}
+
+	const int cmp = strncmp(iNode->name, iName, iLen);
+	if (cmp) {
+		return cmp;
+	}
+	return '\0' != iNode->name[iLen];
+}
+
+/**
+ * Find the child of iTable with key iName[0..iLen), or iIndex if iName is 0.
+ * @return Child, or 0 if iTable isn't a table or has no such child.
+ */
+static const lkonf_static_node *
+find_child(
+	const lkonf_static_node *	iTable,
+	const char *			iName,
+	const size_t			iLen,
+	const int			iIndex)
+{
+	if (! iTable || LK_TYPE_TABLE != iTable->value.type) {
+		return 0;
+	}
+
+	size_t lo = 0;
+	size_t hi = iTable->count;
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		const int cmp = compare(&iTable->children[mid],
+			iName, iLen, iIndex);
+		if (! cmp) {
+			return &iTable->children[mid];
+		}
+		if (cmp < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Whether iNode is a table.
+ */
+static bool
+is_table(const lkonf_static_node * iNode)
+{
+	return iNode && LK_TYPE_TABLE == iNode->value.type;
+}
+
+/**
+ * Fill oValue from iNode.
+ * @return Error code; LK_NOT_FOUND if iNode is 0.
+ */
+static lkonf_error
+to_value(
+	lkonf_context *			iLc,
+	const lkonf_static_node *	iNode,
+	lki_value *			oValue)
+{
+	if (! iNode) {
+		return lki_set_error(iLc, LK_NOT_FOUND, "");
+	}
+
+	memset(oValue, 0, sizeof(*oValue));
+
+	switch (iNode->value.type) {
+
+	case LK_TYPE_BOOLEAN:
+		oValue->type = LUA_TBOOLEAN;
+		oValue->boolean = iNode->value.boolean;
+		break;
+
+	case LK_TYPE_NUMBER:
+		oValue->type = LUA_TNUMBER;
+		oValue->number = iNode->value.number;
+		oValue->integer = iNode->value.integer;
+		oValue->integral =
+		    (lua_Number)iNode->value.integer == iNode->value.number;
+		break;
+
+	case LK_TYPE_STRING:
+		oValue->type = LUA_TSTRING;
+		oValue->string = iNode->value.string;
+		oValue->length = iNode->value.length;
+		break;
+
+	case LK_TYPE_TABLE:
+		oValue->type = LUA_TTABLE;
+		break;
+
+	case LK_TYPE_NIL:
+		return lki_set_error(iLc, LK_NOT_FOUND, "");
+
+	default:
+		oValue->type = LUA_TUSERDATA;
+		break;
+
+	}
+
+	return LK_OK;
+}
+
+lkonf_error
+lki_static_lookup_path(
+	lkonf_context *	iLc,
+	const char *	iPath,
+	lki_value *	oValue)
+{
+	if (! iPath) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iPath NULL");
+	}
+
+	if (! *iPath) {
+		return lki_set_error(iLc, LK_OUT_OF_RANGE, "Empty path");
+	}
+
+	if ('.' == *iPath) {
+		return lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Empty component in", iPath);
+	}
+
+	if ('[' == *iPath) {
+		return lki_set_error_item(iLc,
+			LK_OUT_OF_RANGE, "Invalid index in", iPath);
+	}
+
+		/* As per lki_walk_path(). */
+	const lkonf_static_node * node = iLc->baked;
+	const char * p = iPath;
+	while (*p) {
+		if (p != iPath && ! is_table(node)) {
+			return lki_set_error_litem(iLc,
+				LK_OUT_OF_RANGE, "Not a table", iPath, p - iPath);
+		}
+
+		int index;
+
+		if ('[' == *p) {
+			const char * end = strchr(p, ']');
+			if (! end
+			    || ! lki_parse_index(p + 1, end - p - 1, &index)
+			    || (end[1] && ! strchr(".[", end[1]))) {
+				return lki_set_error_item(iLc,
+					LK_OUT_OF_RANGE, "Invalid index in", iPath);
+			}
+			node = find_child(node, 0, 0, index);
+			p = end + 1;
+			continue;
+		}
+
+		if ('.' == *p) {
+			++p;
+		}
+
+		const size_t len = strcspn(p, ".[");
+		if (! len) {
+			return lki_set_error_item(iLc,
+				LK_OUT_OF_RANGE, "Empty component in", iPath);
+		}
+
+		const lkonf_static_node * child = 0;
+		if (lki_parse_index(p, len, &index)) {
+			child = find_child(node, 0, 0, index);
+		}
+		node = child ? child : find_child(node, p, len, 0);
+		p += len;
+	}
+
+	return to_value(iLc, node, oValue);
+}
+
+lkonf_error
+lki_static_lookup_keys(
+	lkonf_context *	iLc,
+	lkonf_keys	iKeys,
+	lki_value *	oValue)
+{
+	if (! iKeys) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iKeys NULL");
+	}
+
+	if (! iKeys[0]) {
+		return lki_set_error(iLc, LK_OUT_OF_RANGE, "Empty keys");
+	}
+
+	if (! iKeys[0][0]) {
+		return lki_set_error(iLc,
+			LK_OUT_OF_RANGE, "Empty top-level key");
+	}
+
+	const lkonf_static_node * node = iLc->baked;
+	size_t ki;
+	for (ki = 0; 0 != iKeys[ki]; ++ki) {
+		if (! is_table(node)) {
+			return lki_set_error_keys(iLc,
+				LK_OUT_OF_RANGE, "Not a table", iKeys, ki);
+		}
+		node = find_child(node, iKeys[ki], strlen(iKeys[ki]), 0);
+	}
+
+	return to_value(iLc, node, oValue);
+}
+
+lkonf_error
+lki_static_lookup_ikeys(
+	lkonf_context *	iLc,
+	lkonf_ikeys	iKeys,
+	lki_value *	oValue)
+{
+	if (! iKeys) {
+		return lki_set_error(iLc, LK_INVALID_ARGUMENT, "iKeys NULL");
+	}
+
+	if (LK_KEY_END == iKeys[0].type) {
+		return lki_set_error(iLc, LK_OUT_OF_RANGE, "Empty keys");
+	}
+
+	const lkonf_static_node * node = iLc->baked;
+	size_t ki;
+	for (ki = 0; LK_KEY_END != iKeys[ki].type; ++ki) {
+		if (! is_table(node)) {
+			return lki_set_error_ikeys(iLc,
+				LK_OUT_OF_RANGE, "Not a table", iKeys, ki);
+		}
+
+		switch (iKeys[ki].type) {
+
+		case LK_KEY_NAME:
+			if (! iKeys[ki].name) {
+				return lki_set_error(iLc,
+					LK_INVALID_ARGUMENT, "Key name NULL");
+			}
+			if (! ki && ! iKeys[ki].name[0]) {
+				return lki_set_error(iLc,
+					LK_OUT_OF_RANGE, "Empty top-level key");
+			}
+			node = find_child(node,
+				iKeys[ki].name, strlen(iKeys[ki].name), 0);
+			break;
+
+		case LK_KEY_INDEX:
+			node = find_child(node, 0, 0, iKeys[ki].index);
+			break;
+
+		default:
+			return lki_set_error(iLc,
+				LK_INVALID_ARGUMENT, "Invalid key type");
+		}
+	}
+
+	return to_value(iLc, node, oValue);
+}
@@ -0,0 +1,26 @@
+#include "internal.h"
+
+#include <limits.h>
+
+bool
+lki_to_integer(lua_State * iState, const int iIndex, lua_Integer * oValue)
+{
+#if LUA_VERSION_NUM >= 503
+		/* Exact for integer subtypes; fails for non-integral floats. */
+	int isnum = 0;
+	*oValue = lua_tointegerx(iState, iIndex, &isnum);
+	return isnum;
+#else
+	const lua_Number n = lua_tonumber(iState, iIndex);
+	const lua_Number limit =
+	    (lua_Number)(1ULL << (sizeof(lua_Integer) * CHAR_BIT - 1));
+
+		/* Within lua_Integer before converting; also rejects NaN. */
+	if (! (n >= -limit && n < limit)) {
+		*oValue = 0;
+		return false;
+	}
+	*oValue = (lua_Integer)n;
+	return (lua_Number)*oValue == n;
+#endif
+}
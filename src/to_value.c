@@ -0,0 +1,44 @@
+#include "internal.h"
+
+#include <string.h>
+
+void
+lki_to_value(lua_State * iState, const int iIndex, lkonf_value * oValue)
+{
+	memset(oValue, 0, sizeof(*oValue));
+
+	switch (lua_type(iState, iIndex)) {
+
+	case LUA_TNIL:
+		oValue->type = LK_TYPE_NIL;
+		break;
+
+	case LUA_TBOOLEAN:
+		oValue->type = LK_TYPE_BOOLEAN;
+		oValue->boolean = lua_toboolean(iState, iIndex);
+		break;
+
+	case LUA_TNUMBER:
+		oValue->type = LK_TYPE_NUMBER;
+		oValue->number = lua_tonumber(iState, iIndex);
+		lki_to_integer(iState, iIndex, &oValue->integer);
+		break;
+
+	case LUA_TSTRING:
+		oValue->type = LK_TYPE_STRING;
+		oValue->string = lua_tolstring(iState, iIndex, &oValue->length);
+		break;
+
+	case LUA_TTABLE:
+		oValue->type = LK_TYPE_TABLE;
+		break;
+
+	case LUA_TFUNCTION:
+		oValue->type = LK_TYPE_FUNCTION;
+		break;
+
+	default:
+		oValue->type = LK_TYPE_OTHER;
+		break;
+	}
+}
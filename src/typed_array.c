@@ -0,0 +1,244 @@
+#include "internal.h"
+
+#include <lauxlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Size of an element of iType.
+ */
+static size_t
+element_size(const lkonf_array_type iType)
+{
+	switch (iType) {
+	case LK_ARRAY_U8:	return sizeof(uint8_t);
+	case LK_ARRAY_I16:	return sizeof(int16_t);
+	case LK_ARRAY_I32:	return sizeof(int32_t);
+	case LK_ARRAY_I64:	return sizeof(int64_t);
+	case LK_ARRAY_F32:	return sizeof(float);
+	case LK_ARRAY_F64:	return sizeof(double);
+	}
+	return 0;
+}
+
+/**
+ * Store iValue as element iIndex of iArray.
+ * @return False if not representable.
+ */
+static bool
+store_element(lki_typed_array * iArray, const size_t iIndex, lua_Number iValue)
+{
+	void * data = iArray->data;
+
+	if (LK_ARRAY_F64 == iArray->type) {
+		((double *)data)[iIndex] = iValue;
+		return true;
+	}
+	if (LK_ARRAY_F32 == iArray->type) {
+		((float *)data)[iIndex] = (float)iValue;
+		return true;
+	}
+
+		/* Integral and within int64_t; also rejects NaN. */
+	if (! (iValue >= -9223372036854775808.0 &&
+	       iValue < 9223372036854775808.0) ||
+	    iValue != (lua_Number)(int64_t)iValue) {
+		return false;
+	}
+	const int64_t v = (int64_t)iValue;
+
+	switch (iArray->type) {
+	case LK_ARRAY_U8:
+		if (v < 0 || v > UINT8_MAX) {
+			return false;
+		}
+		((uint8_t *)data)[iIndex] = (uint8_t)v;
+		return true;
+	case LK_ARRAY_I16:
+		if (v < INT16_MIN || v > INT16_MAX) {
+			return false;
+		}
+		((int16_t *)data)[iIndex] = (int16_t)v;
+		return true;
+	case LK_ARRAY_I32:
+		if (v < INT32_MIN || v > INT32_MAX) {
+			return false;
+		}
+		((int32_t *)data)[iIndex] = (int32_t)v;
+		return true;
+	case LK_ARRAY_I64:
+		((int64_t *)data)[iIndex] = v;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Constructor; upvalue 1 is the lkonf_array_type, argument 1 a table.
+ */
+static int
+construct(lua_State * iState)
+{
+	const lkonf_array_type type =
+	    (lkonf_array_type)lua_tointeger(iState, lua_upvalueindex(1));
+	luaL_checktype(iState, 1, LUA_TTABLE);
+
+#if LUA_VERSION_NUM >= 502
+	const size_t length = lua_rawlen(iState, 1);
+#else
+	const size_t length = lua_objlen(iState, 1);
+#endif
+
+	lki_typed_array * ta = lua_newuserdata(iState,
+		offsetof(lki_typed_array, data) + length * element_size(type));
+	ta->type = type;
+	ta->length = length;
+	luaL_getmetatable(iState, LKI_TYPED_ARRAY);
+	lua_setmetatable(iState, -2);
+
+	size_t i;
+	for (i = 0; i < length; ++i) {
+		lua_rawgeti(iState, 1, (int)(i + 1));
+#if LUA_VERSION_NUM >= 503
+			/* Exact, beyond the 2^53 of a lua_Number. */
+		if (LK_ARRAY_I64 == type && lua_isinteger(iState, -1)) {
+			((int64_t *)ta->data)[i] =
+			    (int64_t)lua_tointeger(iState, -1);
+			lua_pop(iState, 1);
+			continue;
+		}
+#endif
+		if (LUA_TNUMBER != lua_type(iState, -1) ||
+		    ! store_element(ta, i, lua_tonumber(iState, -1))) {
+			lua_pushfstring(iState,
+				"Invalid typed array element %d",
+				(int)(i + 1));
+			return lua_error(iState);
+		}
+		lua_pop(iState, 1);
+	}
+
+	return 1;
+}
+
+/**
+ * __index metamethod; element at a 1-based integer index, or nil.
+ */
+static int
+get_element(lua_State * iState)
+{
+	const lki_typed_array * ta = lua_touserdata(iState, 1);
+	lua_Integer n;
+	if (LUA_TNUMBER != lua_type(iState, 2) ||
+	    ! lki_to_integer(iState, 2, &n) ||
+	    n < 1 || (size_t)n > ta->length) {
+		lua_pushnil(iState);
+		return 1;
+	}
+
+	const void * data = ta->data;
+	const size_t i = (size_t)n - 1;
+	switch (ta->type) {
+	case LK_ARRAY_U8:
+		lua_pushinteger(iState, ((const uint8_t *)data)[i]);
+		break;
+	case LK_ARRAY_I16:
+		lua_pushinteger(iState, ((const int16_t *)data)[i]);
+		break;
+	case LK_ARRAY_I32:
+		lua_pushinteger(iState, (lua_Integer)((const int32_t *)data)[i]);
+		break;
+	case LK_ARRAY_I64:
+#if LUA_VERSION_NUM >= 503
+		lua_pushinteger(iState, (lua_Integer)((const int64_t *)data)[i]);
+#else
+		lua_pushnumber(iState, (lua_Number)((const int64_t *)data)[i]);
+#endif
+		break;
+	case LK_ARRAY_F32:
+		lua_pushnumber(iState, ((const float *)data)[i]);
+		break;
+	case LK_ARRAY_F64:
+		lua_pushnumber(iState, ((const double *)data)[i]);
+		break;
+	default:
+		lua_pushnil(iState);
+		break;
+	}
+	return 1;
+}
+
+/**
+ * __len metamethod.
+ */
+static int
+get_length(lua_State * iState)
+{
+	const lki_typed_array * ta = lua_touserdata(iState, 1);
+	lua_pushinteger(iState, (lua_Integer)ta->length);
+	return 1;
+}
+
+/**
+ * __newindex metamethod; typed arrays are read-only.
+ * Errors are raised with lua_error() rather than luaL_error(),
+ * so the message isn't prefixed with the location.
+ */
+static int
+set_element(lua_State * iState)
+{
+	lua_pushliteral(iState, "Typed array is read-only");
+	return lua_error(iState);
+}
+
+
+void
+lki_open_typed_arrays(lua_State * iState, const int iIndex)
+{
+	static const struct {
+		const char *		name;
+		lkonf_array_type	type;
+	} constructors[] = {
+		{ "u8",		LK_ARRAY_U8 },
+		{ "i16",	LK_ARRAY_I16 },
+		{ "i32",	LK_ARRAY_I32 },
+		{ "i64",	LK_ARRAY_I64 },
+		{ "f32",	LK_ARRAY_F32 },
+		{ "f64",	LK_ARRAY_F64 },
+	};
+
+	if (luaL_newmetatable(iState, LKI_TYPED_ARRAY)) {	/* S: mt */
+		lua_pushcfunction(iState, &get_element);
+		lua_setfield(iState, -2, "__index");
+		lua_pushcfunction(iState, &set_element);
+		lua_setfield(iState, -2, "__newindex");
+		lua_pushcfunction(iState, &get_length);
+		lua_setfield(iState, -2, "__len");
+		lua_pushliteral(iState, "typed array");
+		lua_setfield(iState, -2, "__metatable");
+	}
+	lua_pop(iState, 1);					/* S: */
+
+	size_t i;
+	for (i = 0; i < sizeof(constructors) / sizeof(constructors[0]); ++i) {
+		lua_pushinteger(iState, constructors[i].type);
+		lua_pushcclosure(iState, &construct, 1);	/* S: f */
+		lua_setfield(iState, iIndex, constructors[i].name);
+	}
+}
+
+lki_typed_array *
+lki_to_typed_array(lua_State * iState, const int iIndex)
+{
+	void * ud = lua_touserdata(iState, iIndex);
+	if (! ud || ! lua_getmetatable(iState, iIndex)) {
+		return 0;
+	}
+								/* S: mt */
+	luaL_getmetatable(iState, LKI_TYPED_ARRAY);		/* S: mt tmt */
+	const bool is_array = lua_rawequal(iState, -1, -2);
+	lua_pop(iState, 2);					/* S: */
+
+	return is_array ? ud : 0;
+}
@@ -0,0 +1,363 @@
+#include "internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Maximum depth of tables validated.
+ */
+#define VALIDATE_DEPTH_MAX	64
+
+/**
+ * State of lkonf_validate().
+ */
+typedef struct
+{
+	lkonf_context *		lc;		/** Context. */
+	int			matchers;	/** Index of matchers table. */
+	const char *		root;		/** Path of root table. */
+	lkonf_validate_report	report;		/** Callback, or NULL. */
+	void *			arg;		/** Argument for report. */
+	lkonf_error		code;		/** First error code. */
+	char			string[128];	/** First error string. */
+	size_t			depth;		/** Number of keys. */
+	int			keys[VALIDATE_DEPTH_MAX + 1];
+						/** Stack indices of keys,
+						 *  and one for a violation. */
+} validate_state;
+
+/**
+ * Format the path of the current value into oPath,
+ * from the root and the keys on the stack.
+ * Paths are only formatted for violations.
+ */
+static void
+format_path(validate_state * iVs, char * oPath, const size_t iLen)
+{
+	lua_State * L = iVs->lc->state;
+	size_t len = snprintf(oPath, iLen, "%s", iVs->root);
+
+	size_t i;
+	for (i = 0; i < iVs->depth && len < iLen; ++i) {
+		const int k = iVs->keys[i];
+		switch (lua_type(L, k)) {
+		case LUA_TSTRING:
+			len += snprintf(oPath + len, iLen - len, "%s%s",
+				len ? "." : "", lua_tostring(L, k));
+			break;
+		case LUA_TNUMBER:
+			len += snprintf(oPath + len, iLen - len, "[%.14g]",
+				(double)lua_tonumber(L, k));
+			break;
+		default:
+			len += snprintf(oPath + len, iLen - len, "[%s]",
+				lua_typename(L, lua_type(L, k)));
+			break;
+		}
+	}
+}
+
+/**
+ * Report a violation at the current path, remember it if it's the first,
+ * and reset the error so that validation can continue.
+ */
+static void
+violation(
+	validate_state *	iVs,
+	const lkonf_error	iCode,
+	const char *		iString)
+{
+	char path[256];
+	format_path(iVs, path, sizeof(path));
+
+	lki_set_error_item(iVs->lc, iCode, iString, path);
+	const char * string = lkonf_get_error_string(iVs->lc);
+
+	if (iVs->report) {
+		iVs->report(iVs->arg, path, iCode, string);
+	}
+
+	if (LK_OK == iVs->code) {
+		iVs->code = iCode;
+		snprintf(iVs->string, sizeof(iVs->string), "%s", string);
+	}
+
+	lki_reset_error(iVs->lc);
+}
+
+/**
+ * Check iValue is within the range of iSchema, if any.
+ */
+static void
+check_range(
+	validate_state *	iVs,
+	const lkonf_schema *	iSchema,
+	const double		iValue)
+{
+	if ((iSchema->flags & LK_SCHEMA_RANGE)
+	    && ! (iValue >= iSchema->minimum && iValue <= iSchema->maximum)) {
+		violation(iVs, LK_OUT_OF_RANGE, "Out of range");
+	}
+}
+
+static void
+check_value(validate_state * iVs, const lkonf_schema * iSchema);
+
+/**
+ * Push key iKey on the path and check the value at the top of the stack,
+ * leaving the key and value on the stack.
+ */
+static void
+check_key(validate_state * iVs, const int iKey, const lkonf_schema * iSchema)
+{
+	if (iVs->depth >= VALIDATE_DEPTH_MAX
+	    || ! lua_checkstack(iVs->lc->state, 8)) {
+		violation(iVs, LK_RESOURCE_EXHAUSTED, "Too deep");
+		return;
+	}
+
+	iVs->keys[iVs->depth++] = iKey;
+	check_value(iVs, iSchema);
+	--iVs->depth;
+}
+
+/**
+ * Check the table at iTable against the fields of iSchema.
+ */
+static void
+check_table(validate_state * iVs, const int iTable, const lkonf_schema * iSchema)
+{
+	lua_State * L = iVs->lc->state;
+
+#if LUA_VERSION_NUM >= 502
+	lua_rawgetp(L, iVs->matchers, iSchema->fields);		/* S: m */
+#else
+	lua_pushlightuserdata(L, (void *)iSchema->fields);
+	lua_rawget(L, iVs->matchers);				/* S: m */
+#endif
+	const int matcher = lua_gettop(L);
+	lua_rawgeti(L, matcher, 1);				/* S: m n */
+	const int required = (int)lua_tointeger(L, -1);
+	lua_pop(L, 1);						/* S: m */
+
+	lki_push_storage(L, iTable);				/* S: m s */
+	const int storage = lua_gettop(L);
+
+	int found = 0;
+	lua_pushnil(L);						/* S: m s nil */
+	while (lua_next(L, storage)) {				/* S: m s k v */
+		const int key = lua_gettop(L) - 1;
+		const lkonf_schema * field = 0;
+		if (LUA_TSTRING == lua_type(L, key)) {
+			lua_pushvalue(L, key);			/* S: m s k v k */
+			lua_rawget(L, matcher);			/* S: m s k v f */
+			field = (const lkonf_schema *)lua_touserdata(L, -1);
+			lua_pop(L, 1);				/* S: m s k v */
+		}
+
+		if (field) {
+			if (field->flags & LK_SCHEMA_REQUIRED) {
+				++found;
+			}
+			check_key(iVs, key, field);
+		} else if (! (iSchema->flags & LK_SCHEMA_OPEN)) {
+			iVs->keys[iVs->depth++] = key;
+			violation(iVs, LK_OUT_OF_RANGE, "Unknown key");
+			--iVs->depth;
+		}
+		lua_settop(L, key);				/* S: m s k */
+	}							/* S: m s */
+
+		/* Only look for missing keys if there are any. */
+	if (found < required) {
+		size_t i;
+		for (i = 0; i < iSchema->count; ++i) {
+			const lkonf_schema * field = &iSchema->fields[i];
+			if (! (field->flags & LK_SCHEMA_REQUIRED)) {
+				continue;
+			}
+			lua_pushstring(L, field->name);		/* S: m s k */
+			lua_pushvalue(L, -1);			/* S: m s k k */
+			lua_rawget(L, storage);			/* S: m s k v */
+			if (lua_isnil(L, -1)) {
+				iVs->keys[iVs->depth++] = storage + 1;
+				violation(iVs, LK_NOT_FOUND, "Missing");
+				--iVs->depth;
+			}
+			lua_pop(L, 2);				/* S: m s */
+		}
+	}
+
+	lua_pop(L, 2);						/* S: */
+}
+
+/**
+ * Check the table at iTable against the element of iSchema.
+ */
+static void
+check_array(validate_state * iVs, const int iTable, const lkonf_schema * iSchema)
+{
+	lua_State * L = iVs->lc->state;
+
+	lki_push_storage(L, iTable);				/* S: s */
+	const int storage = lua_gettop(L);
+#if LUA_VERSION_NUM >= 502
+	const size_t len = lua_rawlen(L, storage);
+#else
+	const size_t len = lua_objlen(L, storage);
+#endif
+	check_range(iVs, iSchema, (double)len);
+
+	lua_pushnil(L);						/* S: s nil */
+	while (lua_next(L, storage)) {				/* S: s k v */
+		const int key = lua_gettop(L) - 1;
+		bool element = false;
+		lua_Integer n;
+		if (LUA_TNUMBER == lua_type(L, key) && lki_to_integer(L, key, &n)) {
+			element = n >= 1 && (size_t)n <= len;
+		}
+
+		if (element) {
+			check_key(iVs, key, iSchema->fields);
+		} else if (! (iSchema->flags & LK_SCHEMA_OPEN)) {
+			iVs->keys[iVs->depth++] = key;
+			violation(iVs, LK_OUT_OF_RANGE, "Unknown key");
+			--iVs->depth;
+		}
+		lua_settop(L, key);				/* S: s k */
+	}							/* S: s */
+
+	lua_pop(L, 1);						/* S: */
+}
+
+/**
+ * Check the value at the top of the stack against iSchema.
+ */
+static void
+check_value(validate_state * iVs, const lkonf_schema * iSchema)
+{
+	lua_State * L = iVs->lc->state;
+	const int type = lua_type(L, -1);
+	lua_Integer integer;
+
+		/* Functions are resolved by the getters, not here. */
+	if (LUA_TFUNCTION == type
+	    && LK_SCHEMA_TABLE != iSchema->type
+	    && LK_SCHEMA_ARRAY != iSchema->type) {
+		return;
+	}
+
+	switch (iSchema->type) {
+
+	case LK_SCHEMA_ANY:
+		break;
+
+	case LK_SCHEMA_BOOLEAN:
+		if (LUA_TBOOLEAN != type) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not a boolean");
+		}
+		break;
+
+	case LK_SCHEMA_NUMBER:
+		if (LUA_TNUMBER != type) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not a number");
+			break;
+		}
+		check_range(iVs, iSchema, lua_tonumber(L, -1));
+		break;
+
+	case LK_SCHEMA_INTEGER:
+		if (LUA_TNUMBER != type || ! lki_to_integer(L, -1, &integer)) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not an integer");
+			break;
+		}
+		check_range(iVs, iSchema, lua_tonumber(L, -1));
+		break;
+
+	case LK_SCHEMA_STRING:
+		if (LUA_TSTRING != type) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not a string");
+			break;
+		}
+#if LUA_VERSION_NUM >= 502
+		check_range(iVs, iSchema, (double)lua_rawlen(L, -1));
+#else
+		check_range(iVs, iSchema, (double)lua_objlen(L, -1));
+#endif
+		break;
+
+	case LK_SCHEMA_TABLE:
+		if (LUA_TTABLE != type) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not a table");
+			break;
+		}
+		check_table(iVs, lua_gettop(L), iSchema);
+		break;
+
+	case LK_SCHEMA_ARRAY:
+		if (LUA_TTABLE != type) {
+			violation(iVs, LK_OUT_OF_RANGE, "Not a table");
+			break;
+		}
+		check_array(iVs, lua_gettop(L), iSchema);
+		break;
+
+	case LK_SCHEMA_FUNCTION:
+		violation(iVs, LK_OUT_OF_RANGE, "Not a function");
+		break;
+
+	}
+}
+
+lkonf_error
+lkonf_validate(
+	lkonf_validator *	iValidator,
+	const char *		iPath,
+	lkonf_validate_report	iReport,
+	void *			iArg)
+{
+	if (! iValidator || ! iValidator->lc) {
+		return LK_INVALID_ARGUMENT;
+	}
+
+	lkonf_context * lc = iValidator->lc;
+
+	if (LK_OK != lki_state_entry(lc)) {
+		return lki_state_exit(lc);
+	}
+
+	if (! iPath) {
+		lki_set_error(lc, LK_INVALID_ARGUMENT, "iPath NULL");
+		return lki_state_exit(lc);
+	}
+
+	lua_rawgeti(lc->state, LUA_REGISTRYINDEX, iValidator->ref); /* S: M */
+
+	if (! *iPath) {
+		lki_push_globals(lc->state);			/* S: M t */
+	} else if (LK_OK != lki_find_table_by_path(lc, iPath)) {
+		return lki_state_exit(lc);
+	} else if (! lua_istable(lc->state, -1)) {
+		lki_set_error_item(lc, LK_OUT_OF_RANGE, "Not a table", iPath);
+		return lki_state_exit(lc);
+	}
+
+	validate_state vs;
+	memset(&vs, 0, sizeof(vs));
+	vs.lc = lc;
+	vs.matchers = lua_gettop(lc->state) - 1;
+	vs.root = iPath;
+	vs.report = iReport;
+	vs.arg = iArg;
+	vs.code = LK_OK;
+
+	check_value(&vs, iValidator->schema);
+
+		/* The first violation is the result. */
+	if (LK_OK != vs.code) {
+		lki_set_error_litem(lc, vs.code, 0,
+			vs.string, strlen(vs.string));
+	}
+
+	return lki_state_exit(lc);
+}
@@ -0,0 +1,429 @@
+#include <lkonf.h>
+
+#if defined(LKONF_LUAJIT)
+#include <luajit.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char * bench_luastr = "\
+server = { name = 'web', port = 8080, ratio = 0.5, debug = true, \
+  backends = { { host = 'a', port = 80 }, { host = 'b', port = 81 } } } \
+limits = { connections = function (path) return 100 end } \
+rules = { { min = 0, max = 9, weight = 1 }, { min = 10, max = 99, weight = 2 }, \
+  { min = 100, max = 999, weight = 3 } } \
+balance = { weight = function (path) \
+  local w = 0 \
+  for i = 1, 200 do \
+    for j = 1, #rules do \
+      local r = rules[j] \
+      if i >= r.min and i <= r.max then w = w + r.weight end \
+    end \
+  end \
+  return w \
+end } \
+";
+
+/**
+ * Name of the Lua implementation.
+ */
+#if defined(LKONF_LUAJIT)
+static const char * engine = LUAJIT_VERSION;
+#else
+static const char * engine = LUA_RELEASE;
+#endif
+
+/**
+ * Monotonic time in nanoseconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Benchmark of one getter.
+ */
+typedef struct
+{
+	const char *	name;		/** Name printed. */
+	lkonf_error	(*run)(lkonf_context *);	/** One call. */
+	long		divisor;	/** Divides iterations for slow calls. */
+	long		elements;	/** Elements per call, for batches. */
+} bench;
+
+/**
+ * Elements per lkonf_call_batch().
+ */
+#define BENCH_BATCH	1000
+
+/**
+ * limits.connections, for the call benchmarks.
+ */
+static lkonf_function_ref * connections_ref;
+
+static lkonf_error
+get_integer(lkonf_context * iLc)
+{
+	lua_Integer v;
+	return lkonf_get_integer(iLc, "server.port", &v);
+}
+
+static lkonf_error
+get_integer_index(lkonf_context * iLc)
+{
+	lua_Integer v;
+	return lkonf_get_integer(iLc, "server.backends[2].port", &v);
+}
+
+static lkonf_error
+getkey_integer(lkonf_context * iLc)
+{
+	static const char * keys[] = { "server", "port", 0 };
+	lua_Integer v;
+	return lkonf_getkey_integer(iLc, keys, &v);
+}
+
+static lkonf_error
+getikey_integer(lkonf_context * iLc)
+{
+	static const lkonf_ikey keys[] = {
+		LK_NAME("server"), LK_NAME("backends"), LK_INDEX(2),
+		LK_NAME("port"), LK_END };
+	lua_Integer v;
+	return lkonf_getikey_integer(iLc, keys, &v);
+}
+
+static lkonf_error
+get_boolean(lkonf_context * iLc)
+{
+	bool v;
+	return lkonf_get_boolean(iLc, "server.debug", &v);
+}
+
+static lkonf_error
+get_double(lkonf_context * iLc)
+{
+	double v;
+	return lkonf_get_double(iLc, "server.ratio", &v);
+}
+
+static lkonf_error
+get_string(lkonf_context * iLc)
+{
+	char * v = 0;
+	const lkonf_error res = lkonf_get_string(iLc, "server.name", &v, 0);
+	free(v);
+	return res;
+}
+
+static lkonf_error
+get_string_ref(lkonf_context * iLc)
+{
+	const char * v;
+	return lkonf_get_string_ref(iLc, "server.name", &v, 0);
+}
+
+static lkonf_error
+get_missing(lkonf_context * iLc)
+{
+	lua_Integer v;
+	const lkonf_error res = lkonf_get_integer(iLc, "server.missing", &v);
+	return LK_NOT_FOUND == res ? LK_OK : res;
+}
+
+static lkonf_error
+get_function(lkonf_context * iLc)
+{
+	lua_Integer v;
+	return lkonf_get_integer(iLc, "limits.connections", &v);
+}
+
+static lkonf_error
+get_compute(lkonf_context * iLc)
+{
+	lua_Integer v;
+	return lkonf_get_integer(iLc, "balance.weight", &v);
+}
+
+static lkonf_error
+call(lkonf_context * iLc)
+{
+	lkonf_value v;
+	return lkonf_call(iLc, connections_ref, 0, 0, &v, 1);
+}
+
+static lkonf_error
+call_batch(lkonf_context * iLc)
+{
+	static lkonf_value inputs[BENCH_BATCH];
+	static lkonf_value outputs[BENCH_BATCH];
+	return lkonf_call_batch(iLc,
+		connections_ref, inputs, BENCH_BATCH, outputs, 0);
+}
+
+static const bench benches[] = {
+	{ "get_integer",	get_integer,		1,	1 },
+	{ "get_integer[n]",	get_integer_index,	1,	1 },
+	{ "getkey_integer",	getkey_integer,		1,	1 },
+	{ "getikey_integer",	getikey_integer,	1,	1 },
+	{ "get_boolean",	get_boolean,		1,	1 },
+	{ "get_double",		get_double,		1,	1 },
+	{ "get_string",		get_string,		1,	1 },
+	{ "get_string_ref",	get_string_ref,		1,	1 },
+	{ "get_missing",	get_missing,		1,	1 },
+	{ "get_function",	get_function,		1,	1 },
+	{ "get_compute",	get_compute,		100,	1 },
+	{ "call",		call,			1,	1 },
+	{ "call_batch",		call_batch,	BENCH_BATCH,	BENCH_BATCH },
+	{ 0,			0,			0,	0 },
+};
+
+/**
+ * Records for the validation benchmark.
+ */
+#define BENCH_RECORDS	200000
+
+/**
+ * Chunk creating BENCH_RECORDS records, formatted with the count.
+ */
+static const char * records_luastr = "\
+records = {} \
+for i = 1, %d do \
+  records[i] = { host = 'h', port = i %% 60000 + 1, weight = i / 2, up = true } \
+end \
+";
+
+static const lkonf_schema record_fields[] = {
+	{ .name = "host", .type = LK_SCHEMA_STRING,
+	  .flags = LK_SCHEMA_REQUIRED },
+	{ .name = "port", .type = LK_SCHEMA_INTEGER,
+	  .flags = LK_SCHEMA_REQUIRED | LK_SCHEMA_RANGE,
+	  .minimum = 1, .maximum = 65535 },
+	{ .name = "weight", .type = LK_SCHEMA_NUMBER,
+	  .flags = LK_SCHEMA_REQUIRED },
+	{ .name = "up", .type = LK_SCHEMA_BOOLEAN,
+	  .flags = LK_SCHEMA_REQUIRED },
+};
+
+static const lkonf_schema record = {
+	.type = LK_SCHEMA_TABLE, .fields = record_fields, .count = 4 };
+
+static const lkonf_schema records = {
+	.type = LK_SCHEMA_ARRAY, .fields = &record, .count = 1 };
+
+/**
+ * Check the records one getter at a time,
+ * as lkonf_validate() does in one call.
+ */
+static lkonf_error
+check_records(lkonf_context * iLc)
+{
+	lkonf_ikey keys[] = {
+		LK_NAME("records"), LK_INDEX(0), LK_NAME(0), LK_END };
+	lkonf_error res = LK_OK;
+	int i;
+	for (i = 1; LK_OK == res && i <= BENCH_RECORDS; ++i) {
+		char *		host;
+		lua_Integer	port;
+		double		weight;
+		bool		up;
+
+		keys[1].index = i;
+		keys[2].name = "host";
+		res = lkonf_getikey_string(iLc, keys, &host, 0);
+		if (LK_OK != res) {
+			break;
+		}
+		free(host);
+		keys[2].name = "port";
+		res = lkonf_getikey_integer(iLc, keys, &port);
+		if (LK_OK == res && (port < 1 || port > 65535)) {
+			res = LK_OUT_OF_RANGE;
+		}
+		keys[2].name = "weight";
+		if (LK_OK == res) {
+			res = lkonf_getikey_double(iLc, keys, &weight);
+		}
+		keys[2].name = "up";
+		if (LK_OK == res) {
+			res = lkonf_getikey_boolean(iLc, keys, &up);
+		}
+	}
+	return res;
+}
+
+/**
+ * Time lkonf_validate() of BENCH_RECORDS records,
+ * against the same checks with getters.
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if a step failed.
+ */
+static int
+validate_bench(const char * iProgname, const int iLimit)
+{
+	lkonf_context * lc = lkonf_construct();
+	if (! lc) {
+		fprintf(stderr, "%s: Can't construct lkonf_context\n",
+			iProgname);
+		return EXIT_FAILURE;
+	}
+
+	char chunk[256];
+	snprintf(chunk, sizeof(chunk), records_luastr, BENCH_RECORDS);
+
+	lkonf_validator * v = 0;
+	if (LK_OK != lkonf_load_string(lc, chunk)
+	    || LK_OK != lkonf_set_instruction_limit(lc, iLimit)
+	    || LK_OK != lkonf_compile_schema(lc, &records, &v)) {
+		fprintf(stderr, "%s: %s\n", iProgname,
+			lkonf_get_error_string(lc));
+		lkonf_destruct(lc);
+		return EXIT_FAILURE;
+	}
+
+	const double values = (double)BENCH_RECORDS * record.count;
+	int rv = EXIT_SUCCESS;
+
+	double start = now();
+	if (LK_OK != lkonf_validate(v, "records", 0, 0)) {
+		fprintf(stderr, "%s: validate: %s\n", iProgname,
+			lkonf_get_error_string(lc));
+		rv = EXIT_FAILURE;
+	} else {
+		printf("%-16s %8.1f ns/value\n",
+			"validate", (now() - start) / values);
+	}
+
+	start = now();
+	if (LK_OK != check_records(lc)) {
+		fprintf(stderr, "%s: validate_getters: %s\n", iProgname,
+			lkonf_get_error_string(lc));
+		rv = EXIT_FAILURE;
+	} else {
+		printf("%-16s %8.1f ns/value\n",
+			"validate_getters", (now() - start) / values);
+	}
+
+	lkonf_free_validator(v);
+	lkonf_destruct(lc);
+
+	return rv;
+}
+
+/**
+ * Print a usage.
+ */
+int
+usage(const char * progname)
+{
+	fprintf(stderr, "Usage: %s [-l <limit>] [-n <iterations>] [-v]\n",
+		progname);
+	fprintf(stderr, "    -l <limit>       Instruction limit per call. [0]\n");
+	fprintf(stderr, "    -n <iterations>  Calls per getter. [1000000]\n");
+	fprintf(stderr, "    -v               Enable the value cache.\n");
+	return EXIT_FAILURE;
+}
+
+/**
+ * Main entry.
+ */
+int
+main(int argc, char * argv[])
+{
+		/* determine progname */
+	char * progname = strrchr(argv[0], '/');
+	if (progname) {
+		++progname;
+	} else {
+		progname = argv[0];
+	}
+
+	long iterations = 1000000;
+	int limit = 0;
+	bool value_cache = false;
+	int ch;
+	while (-1 != (ch = getopt(argc, argv, "l:n:v"))) {
+		switch (ch) {
+			case 'l':
+				limit = (int)strtol(optarg, 0, 10);
+				if (limit < 0) {
+					return usage(progname);
+				}
+				break;
+			case 'n':
+				iterations = strtol(optarg, 0, 10);
+				if (iterations <= 0) {
+					return usage(progname);
+				}
+				break;
+			case 'v':
+				value_cache = true;
+				break;
+			default:
+				return usage(progname);
+		}
+	}
+
+	lkonf_context * lc = lkonf_construct();
+	if (! lc) {
+		fprintf(stderr, "%s: Can't construct lkonf_context\n", progname);
+		return EXIT_FAILURE;
+	}
+
+	if (LK_OK != lkonf_set_value_cache(lc, value_cache)
+	    || LK_OK != lkonf_load_string(lc, bench_luastr)
+	    || LK_OK != lkonf_set_instruction_limit(lc, limit)
+	    || LK_OK != lkonf_get_function_ref(lc,
+			"limits.connections", &connections_ref)) {
+		fprintf(stderr, "%s: %s\n", progname,
+			lkonf_get_error_string(lc));
+		lkonf_destruct(lc);
+		return EXIT_FAILURE;
+	}
+
+		/* With LuaJIT, a limit also turns off the JIT compiler. */
+	printf("%s, instruction limit %d\n", engine, limit);
+
+	int rv = EXIT_SUCCESS;
+	size_t bi;
+	for (bi = 0; benches[bi].name; ++bi) {
+		long calls = iterations / benches[bi].divisor;
+		if (calls < 1) {
+			calls = 1;
+		}
+		const double start = now();
+		long i;
+		for (i = 0; i < calls; ++i) {
+			if (LK_OK != benches[bi].run(lc)) {
+				break;
+			}
+		}
+		const double elapsed = now() - start;
+
+		if (i < calls) {
+			fprintf(stderr, "%s: %s: %s\n", progname,
+				benches[bi].name, lkonf_get_error_string(lc));
+			rv = EXIT_FAILURE;
+			continue;
+		}
+		printf("%-16s %8.1f ns/call\n",
+			benches[bi].name,
+			elapsed / ((double)calls * benches[bi].elements));
+	}
+
+	lkonf_free_function_ref(connections_ref);
+	lkonf_destruct(lc);
+
+	if (EXIT_SUCCESS != validate_bench(progname, limit)) {
+		rv = EXIT_FAILURE;
+	}
+
+	return rv;
+}
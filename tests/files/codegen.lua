@@ -0,0 +1,9 @@
+http = {
+	timeout = 30,
+	name = "web",
+	keepalive = true,
+}
+
+ratio = 0.5
+
+ports = { 80, 443 }
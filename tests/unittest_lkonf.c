@@ -1,10 +1,15 @@
 #include <lkonf.h>
+#include <lauxlib.h>
+#include <lualib.h>
 
 #include <assert.h>
 #include <inttypes.h>
+#include <signal.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 
 
@@ -39,11 +44,27 @@ badrun = function (x) print() end \
 local hidden = 1 \
 ";
 
+/**
+ * Function-valued key with a loop that LuaJIT compiles once hot.
+ */
+static const char * test_hotstr = "\
+rounds = 1000 \
+spin = function (x) local n = 0 for i = 1, rounds do n = n + 1 end return n end \
+";
+
+/* Lua 5.3 and later name the value after the error. */
+#if LUA_VERSION_NUM >= 503
+#define NIL_CALL(name)	"attempt to call a nil value (global '" name "')"
+#else
+#define NIL_CALL(name)	"attempt to call global '" name "' (a nil value)"
+#endif
+
 static const char * badrun_error =
-#if LUA_VERSION_NUM >= 502
-"[string \"b1 = true d1 = 1.01 i1 = 1 s1 = \"1\" t2 = { b ...\"]:1: attempt to call global 'print' (a nil value)"
+	/* LuaJIT truncates chunk names as per Lua 5.2. */
+#if LUA_VERSION_NUM >= 502 || defined(LKONF_LUAJIT)
+"[string \"b1 = true d1 = 1.01 i1 = 1 s1 = \"1\" t2 = { b ...\"]:1: " NIL_CALL("print")
 #else
-"[string \"b1 = true d1 = 1.01 i1 = 1 s1 = \"1\" t2 = { ...\"]:1: attempt to call global 'print' (a nil value)"
+"[string \"b1 = true d1 = 1.01 i1 = 1 s1 = \"1\" t2 = { ...\"]:1: " NIL_CALL("print")
 #endif
 ;
 
@@ -66,6 +87,24 @@ enum TestFlags
 	TF_getkey_double	= 1<<10,
 	TF_getkey_integer	= 1<<11,
 	TF_getkey_string	= 1<<12,
+	TF_instruction_budget	= 1<<13,
+	TF_time_limit		= 1<<14,
+	TF_interrupt		= 1<<15,
+	TF_lookup_cache		= 1<<16,
+	TF_value_cache		= 1<<17,
+	TF_seal			= 1<<18,
+	TF_integer_keys		= 1<<19,
+	TF_iter			= 1<<20,
+	TF_array		= 1<<21,
+	TF_typed_array		= 1<<22,
+	TF_columns		= 1<<23,
+	TF_bind			= 1<<24,
+	TF_validate		= 1<<25,
+	TF_static		= 1<<26,
+	TF_load_embedded	= 1<<27,
+	TF_string_ref		= 1<<28,
+	TF_integer_exact	= 1<<29,
+	TF_function_ref		= 1<<30,
 };
 
 
@@ -116,239 +155,2503 @@ ensure_result(
 
 
 int
-test_construct(void)
+test_construct(void)
+{
+	printf("lkonf_construct()\n");
+
+	/* construct lkonf_context, confirm initial state */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error errcode = lkonf_get_error_code(lc);
+		assert(LK_OK == errcode && "errcode != LK_OK");
+
+		const char * errstr = lkonf_get_error_string(lc);
+		assert(0 != errstr && "errstr == 0");
+		assert(0 == errstr[0] && "errstr[0] not empty");
+
+		lua_State * ls = lkonf_get_lua_State(lc);
+		assert(0 != ls && "lua_State == 0");
+
+		lkonf_destruct(lc);
+	}
+
+	/* set the error, as wrappers do */
+	{
+		assert(LK_INVALID_ARGUMENT
+		    == lkonf_set_error_code(0, LK_OUT_OF_RANGE, 0));
+
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		lkonf_error res = lkonf_set_error_code(lc,
+			LK_OUT_OF_RANGE, "Too big");
+		ensure_result(lc, res, "set_error_code(\"Too big\")",
+			LK_OUT_OF_RANGE, "Too big");
+		res = lkonf_set_error_code(lc, LK_NOT_FOUND, 0);
+		ensure_result(lc, res, "set_error_code(0)",
+			LK_NOT_FOUND, lkonf_error_to_string(LK_NOT_FOUND));
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+int
+test_destruct(void)
+{
+	printf("lkonf_destruct()\n");
+
+	/* destruct a default lkonf_context */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		lkonf_destruct(lc);
+	}
+
+	/* destruct a NULL pointer (should be a no-op) */
+	{
+		lkonf_destruct(0);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+int
+test_load_file(void)
+{
+	printf("lkonf_load_file()\n");
+
+	/* fail: load null lkonf_context */
+	{
+		const lkonf_error res = lkonf_load_file(0, 0);
+		assert(LK_INVALID_ARGUMENT == res);
+	}
+
+/* TODO: fail: load lkonf_context with null state */
+
+	/* fail: load with filename null pointer */
+	{
+		lkonf_context * lc = lkonf_construct();
+
+		assert(lc && "lkonf_construct returned 0");
+		const lkonf_error res = lkonf_load_file(lc, 0);
+		ensure_result(lc, res,
+			"load_file(lc, 0)", LK_INVALID_ARGUMENT, "iFile NULL");
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+int
+test_load_string(void)
+{
+	printf("lkonf_load_string()\n");
+
+	/* fail: load null lkonf_context */
+	{
+		assert(LK_INVALID_ARGUMENT == lkonf_load_string(0, 0));
+	}
+
+/* TODO: fail: load lkonf_context with null state */
+
+	/* fail: load with string null pointer */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_load_string(lc, 0);
+		ensure_result(lc, res,
+			"load_string(lc, 0)",
+			LK_INVALID_ARGUMENT, "iString NULL");
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: LK_LUA_ERROR syntax error in string */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_load_string(lc, "junk");
+		ensure_result(lc, res,
+			"load_string(lc, \"junk\")",
+			LK_LUA_ERROR,
+#if LUA_VERSION_NUM >= 502
+			"[string \"junk\"]:1: syntax error near <eof>"
+#else
+			"[string \"junk\"]:1: '=' expected near '<eof>'"
+#endif
+			);
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: LK_LUA_ERROR run-time error in string */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_load_string(lc, "junk()");
+		ensure_result(lc, res,
+			"load_string(lc, \"junk()\")",
+			LK_LUA_ERROR,
+			"[string \"junk()\"]:1: " NIL_CALL("junk"));
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: "t=1" */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_load_string(lc, "t=1");
+		ensure_result(lc, res, "load_string(lc, \"t=1\")", LK_OK, "");
+
+		lkonf_destruct(lc);
+	}
+
+/* TODO: sandbox tests */
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_instruction_limit(void)
+{
+	printf("lkonf_set_instruction_limit()\n");
+
+	/* fail: load null lkonf_context */
+	{
+		assert(-1 == lkonf_get_instruction_limit(0));
+		assert(LK_INVALID_ARGUMENT == lkonf_set_instruction_limit(0, 0));
+	}
+
+	/* fail: set_instruction_limit < 0 */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_set_instruction_limit(lc, -2);
+		ensure_result(lc, res,
+			"set_instruction_limit(lc, -2)",
+			LK_INVALID_ARGUMENT, "iLimit < 0");
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: set & get */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const int	limit = 10;
+
+		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
+		ensure_result(lc, sil,
+			"set_instruction_limit(lc, 10)", LK_OK, "");
+
+		const int gil = lkonf_get_instruction_limit(lc);
+		assert(limit == gil);
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: long loop, no limit */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const int	limit = 0;
+		const char *	expr = "for i=1, 1000 do end";
+
+		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
+		assert(LK_OK == sil);
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr,
+			LK_OK, "");
+
+		const int gil = lkonf_get_instruction_limit(lc);
+		assert(limit == gil);
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: long loop, limited and terminated */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const int	limit = 100;
+		const char *	expr = "for i=1, 1000 do end";
+
+		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
+		assert(LK_OK == sil);
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr,
+			LK_LUA_ERROR, "Instruction count exceeded");
+
+		const int gil = lkonf_get_instruction_limit(lc);
+		assert(limit == gil);
+
+		lkonf_destruct(lc);
+	}
+
+	/*
+	 * fail: hot function limited after running without a limit.
+	 * With LuaJIT, its loop is compiled first,
+	 * and the limit must still apply.
+	 */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		lkonf_error res = lkonf_load_string(lc, test_hotstr);
+		ensure_result(lc, res, "load_string", LK_OK, "");
+
+		lua_Integer	v = 0;
+		int		calls;
+		for (calls = 0; calls < 100; ++calls) {
+			res = lkonf_get_integer(lc, "spin", &v);
+			ensure_result(lc, res, "get_integer(\"spin\")", LK_OK, "");
+			assert(1000 == v);
+		}
+
+		res = lkonf_load_string(lc, "rounds = 100000000");
+		ensure_result(lc, res, "load_string", LK_OK, "");
+		assert(LK_OK == lkonf_set_instruction_limit(lc, 10000));
+
+		res = lkonf_get_integer(lc, "spin", &v);
+		ensure_result(lc, res, "get_integer(\"spin\") limited",
+			LK_LUA_ERROR, "Instruction count exceeded");
+
+			/* no limit */
+		assert(LK_OK == lkonf_set_instruction_limit(lc, 0));
+		res = lkonf_load_string(lc, "rounds = 1000");
+		ensure_result(lc, res, "load_string", LK_OK, "");
+		res = lkonf_get_integer(lc, "spin", &v);
+		ensure_result(lc, res, "get_integer(\"spin\")", LK_OK, "");
+		assert(1000 == v);
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_instruction_budget(void)
+{
+	printf("lkonf_set_instruction_budget()\n");
+
+	/* fail: null lkonf_context */
+	{
+		assert(-1 == lkonf_get_instruction_budget(0));
+		assert(-1 == lkonf_get_instruction_count(0));
+		assert(LK_INVALID_ARGUMENT == lkonf_set_instruction_budget(0, 0));
+		assert(LK_INVALID_ARGUMENT == lkonf_reset_instruction_count(0));
+	}
+
+	/* fail: set_instruction_budget < 0 */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_set_instruction_budget(lc, -2);
+		ensure_result(lc, res,
+			"set_instruction_budget(lc, -2)",
+			LK_INVALID_ARGUMENT, "iBudget < 0");
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: set & get */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const long	budget = 10000;
+
+		const lkonf_error sib = lkonf_set_instruction_budget(lc, budget);
+		ensure_result(lc, sib,
+			"set_instruction_budget(lc, 10000)", LK_OK, "");
+
+		assert(budget == lkonf_get_instruction_budget(lc));
+		assert(0 == lkonf_get_instruction_count(lc));
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: many cheap calls within limit, stopped by budget */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error rls = lkonf_load_string(lc, test_luastr);
+		ensure_result(lc, rls, "load_string", LK_OK, "");
+
+		assert(LK_OK == lkonf_set_instruction_limit(lc, 100));
+		assert(LK_OK == lkonf_set_instruction_budget(lc, 2000));
+
+		lkonf_error	res = LK_OK;
+		lua_Integer	v = 0;
+		int		calls;
+		for (calls = 0; calls < 10000; ++calls) {
+			res = lkonf_get_integer(lc, "jri", &v);
+			if (LK_OK != res) {
+				break;
+			}
+		}
+		ensure_result(lc, res, "get_integer(lc, \"jri\") budget",
+			LK_LUA_ERROR, "Instruction budget exceeded");
+		assert(calls > 0 && calls < 10000);
+		assert(lkonf_get_instruction_count(lc) > 2000);
+
+			/* new budget */
+		const lkonf_error ric = lkonf_reset_instruction_count(lc);
+		ensure_result(lc, ric, "reset_instruction_count", LK_OK, "");
+		assert(0 == lkonf_get_instruction_count(lc));
+
+		res = lkonf_get_integer(lc, "jri", &v);
+		ensure_result(lc, res, "get_integer(lc, \"jri\") reset",
+			LK_OK, "");
+		assert(5 == v);
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: long loop, budget and terminated */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const char *	expr = "for i=1, 1000 do end";
+
+		assert(LK_OK == lkonf_set_instruction_budget(lc, 100));
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr,
+			LK_LUA_ERROR, "Instruction budget exceeded");
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_time_limit(void)
+{
+	printf("lkonf_set_time_limit()\n");
+
+	/* fail: null lkonf_context */
+	{
+		assert(-1 == lkonf_get_time_limit(0));
+		assert(0 == lkonf_get_deadline(0));
+		assert(LK_INVALID_ARGUMENT == lkonf_set_time_limit(0, 0));
+		assert(LK_INVALID_ARGUMENT == lkonf_set_deadline(0, 0));
+	}
+
+	/* fail: set_time_limit < 0 */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error res = lkonf_set_time_limit(lc, -2);
+		ensure_result(lc, res,
+			"set_time_limit(lc, -2)",
+			LK_INVALID_ARGUMENT, "iLimit < 0");
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: set & get */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const lkonf_error stl = lkonf_set_time_limit(lc, 1000);
+		ensure_result(lc, stl, "set_time_limit(lc, 1000)", LK_OK, "");
+		assert(1000 == lkonf_get_time_limit(lc));
+
+		const lkonf_error sdl = lkonf_set_deadline(lc, 12345);
+		ensure_result(lc, sdl, "set_deadline(lc, 12345)", LK_OK, "");
+		assert(12345 == lkonf_get_deadline(lc));
+
+		lkonf_destruct(lc);
+	}
+
+	/* pass: within time limit */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		assert(LK_OK == lkonf_set_time_limit(lc, 10000000));
+
+		const lkonf_error rls = lkonf_load_string(lc, test_luastr);
+		ensure_result(lc, rls, "load_string", LK_OK, "");
+
+		lua_Integer v = 0;
+		const lkonf_error res = lkonf_get_integer(lc, "jri", &v);
+		ensure_result(lc, res, "get_integer(lc, \"jri\")", LK_OK, "");
+		assert(5 == v);
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: endless loop, time limit exceeded */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const char *	expr = "while true do end";
+
+		assert(LK_OK == lkonf_set_time_limit(lc, 1000));
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr,
+			LK_DEADLINE_EXCEEDED, "Deadline exceeded");
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: hot function, time limit set after it ran */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		lkonf_error res = lkonf_load_string(lc, test_hotstr);
+		ensure_result(lc, res, "load_string", LK_OK, "");
+
+		lua_Integer	v = 0;
+		int		calls;
+		for (calls = 0; calls < 100; ++calls) {
+			res = lkonf_get_integer(lc, "spin", &v);
+			ensure_result(lc, res, "get_integer(\"spin\")", LK_OK, "");
+		}
+
+		res = lkonf_load_string(lc, "rounds = 1000000000");
+		ensure_result(lc, res, "load_string", LK_OK, "");
+		assert(LK_OK == lkonf_set_time_limit(lc, 1000));
+
+		res = lkonf_get_integer(lc, "spin", &v);
+		ensure_result(lc, res, "get_integer(\"spin\") limited",
+			LK_DEADLINE_EXCEEDED, "Deadline exceeded");
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: deadline already passed */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const char *	expr = "t=1";
+
+		assert(LK_OK == lkonf_set_deadline(lc, 1));
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr,
+			LK_DEADLINE_EXCEEDED, "Deadline exceeded");
+
+			/* no deadline */
+		assert(LK_OK == lkonf_set_deadline(lc, 0));
+
+		const lkonf_error res2 = lkonf_load_string(lc, expr);
+		ensure_result(lc, res2, expr, LK_OK, "");
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * lkonf_context for interrupt_handler().
+ */
+static lkonf_context * interrupt_lc;
+
+/**
+ * Signal handler to call lkonf_interrupt().
+ */
+static void
+interrupt_handler(int sig)
+{
+	(void)sig;	/* UNUSED */
+
+	lkonf_interrupt(interrupt_lc);
+}
+
+/**
+ * Lua function to call lkonf_interrupt().
+ */
+static int
+interrupt_function(lua_State * iState)
+{
+	(void)iState;	/* UNUSED */
+
+	lkonf_interrupt(interrupt_lc);
+	return 0;
+}
+
+/**
+ * Lua function like pcall(), as the base library isn't opened.
+ */
+static int
+pcall_function(lua_State * iState)
+{
+	lua_pushboolean(iState,
+		0 == lua_pcall(iState, lua_gettop(iState) - 1, 0, 0));
+	return 1;
+}
+
+int
+test_interrupt(void)
+{
+	printf("lkonf_interrupt()\n");
+
+	/* fail: null lkonf_context */
+	{
+		assert(LK_INVALID_ARGUMENT == lkonf_interrupt(0));
+	}
+
+	/* fail: pending interrupt is delivered to the next call, once */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const char *	expr = "t=1";
+
+		const lkonf_error lir = lkonf_interrupt(lc);
+		assert(LK_OK == lir);
+		ensure_result(lc, lir, "interrupt(lc)", LK_OK, "");
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr, LK_INTERRUPTED, "Interrupted");
+
+		const lkonf_error res2 = lkonf_load_string(lc, expr);
+		ensure_result(lc, res2, expr, LK_OK, "");
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: endless loop, interrupted from a signal handler */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		const char *	expr = "while true do end";
+
+		interrupt_lc = lc;
+		signal(SIGALRM, interrupt_handler);
+		alarm(1);
+
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr, LK_INTERRUPTED, "Interrupted");
+
+		signal(SIGALRM, SIG_DFL);
+		interrupt_lc = 0;
+
+		lkonf_destruct(lc);
+	}
+
+	/* fail: interrupt caught by pcall is raised again */
+	{
+		lkonf_context * lc = lkonf_construct();
+		assert(lc && "lkonf_construct returned 0");
+
+		lua_State * ls = lkonf_get_lua_State(lc);
+		assert(ls);
+		lua_pushcfunction(ls, &interrupt_function);
+		lua_setglobal(ls, "interrupt");
+		lua_pushcfunction(ls, &pcall_function);
+		lua_setglobal(ls, "pcall");
+		interrupt_lc = lc;
+
+		const char *	expr =
+		    "ok = pcall(function () interrupt() while true do end end)"
+		    " for i = 1, 10000 do end";
+		const lkonf_error res = lkonf_load_string(lc, expr);
+		ensure_result(lc, res, expr, LK_INTERRUPTED, "Interrupted");
+
+		interrupt_lc = 0;
+
+		/* fail: later Lua error isn't reported as interrupted */
+		const char *	expr2 = "x = nil + 1";
+		const lkonf_error res2 = lkonf_load_string(lc, expr2);
+		assert(LK_LUA_ERROR == res2);
+
+		lkonf_destruct(lc);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_lookup_cache(void)
+{
+	printf("lookup cache\n");
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"late = {}\n"
+		"setter = function (x) late.i = 7 return true end\n"
+		"n = 0\n"
+		"dyn = {}\n"
+		"dynmeta = { __index = function (t, k)"
+		" n = n + 1 if n > 1 then return n end end }");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lua_Integer	v = 0;
+	bool		b = false;
+	lkonf_error	res;
+
+	/* fail: missing, twice (second from cache) */
+	res = lkonf_get_integer(lc, "late.i", &v);
+	ensure_result(lc, res, "get_integer(\"late.i\")", LK_NOT_FOUND, "");
+	res = lkonf_get_integer(lc, "late.i", &v);
+	ensure_result(lc, res, "get_integer(\"late.i\")", LK_NOT_FOUND, "");
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"late", "i", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(late i)", LK_NOT_FOUND, "");
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"late", "i", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(late i)", LK_NOT_FOUND, "");
+
+	/* pass: function-valued key modifies state, invalidating cache */
+	res = lkonf_get_boolean(lc, "setter", &b);
+	ensure_result(lc, res, "get_boolean(\"setter\")", LK_OK, "");
+	assert(b);
+
+	res = lkonf_get_integer(lc, "late.i", &v);
+	ensure_result(lc, res, "get_integer(\"late.i\")", LK_OK, "");
+	assert(7 == v);
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"late", "i", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(late i)", LK_OK, "");
+	assert(7 == v);
+
+	/* fail: cache missing "loaded" */
+	res = lkonf_get_boolean(lc, "loaded", &b);
+	ensure_result(lc, res, "get_boolean(\"loaded\")", LK_NOT_FOUND, "");
+
+	/* pass: load invalidates cache */
+	const lkonf_error rls2 = lkonf_load_string(lc, "loaded = true");
+	ensure_result(lc, rls2, "load_string", LK_OK, "");
+	b = false;
+	res = lkonf_get_boolean(lc, "loaded", &b);
+	ensure_result(lc, res, "get_boolean(\"loaded\")", LK_OK, "");
+	assert(b);
+
+	/* fail: cache missing "direct" */
+	res = lkonf_get_boolean(lc, "direct", &b);
+	ensure_result(lc, res, "get_boolean(\"direct\")", LK_NOT_FOUND, "");
+
+	/* pass: lkonf_get_lua_State() invalidates cache */
+	lua_State * ls = lkonf_get_lua_State(lc);
+	assert(ls);
+	lua_pushboolean(ls, 1);
+	lua_setglobal(ls, "direct");
+	b = false;
+	res = lkonf_get_boolean(lc, "direct", &b);
+	ensure_result(lc, res, "get_boolean(\"direct\")", LK_OK, "");
+	assert(b);
+
+	/* fail: missing from a table with an __index function, not cached */
+	lua_getglobal(ls, "dyn");
+	lua_getglobal(ls, "dynmeta");
+	lua_setmetatable(ls, -2);
+	lua_pop(ls, 1);
+	res = lkonf_get_integer(lc, "dyn.x", &v);
+	ensure_result(lc, res, "get_integer(\"dyn.x\")", LK_NOT_FOUND, "");
+
+	/* pass: __index function supplies it the second time */
+	res = lkonf_get_integer(lc, "dyn.x", &v);
+	ensure_result(lc, res, "get_integer(\"dyn.x\")", LK_OK, "");
+	assert(2 == v);
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_value_cache(void)
+{
+	printf("value cache\n");
+
+	/* fail: null context */
+	assert(! lkonf_get_value_cache(0));
+	assert(LK_INVALID_ARGUMENT == lkonf_set_value_cache(0, true));
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	/* pass: disabled by default */
+	assert(! lkonf_get_value_cache(lc));
+
+	lkonf_error	res;
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+	assert(lkonf_get_value_cache(lc));
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"t = { i = 1, d = 2.5, b = true, s = 'str' }\n"
+		"bump = function (x) t.i = t.i + 1 return true end");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lua_Integer	v = 0;
+	double		d = 0;
+	bool		b = false;
+
+	/* pass: get twice (second from cache) */
+	res = lkonf_get_integer(lc, "t.i", &v);
+	ensure_result(lc, res, "get_integer(\"t.i\")", LK_OK, "");
+	assert(1 == v);
+	v = 0;
+	res = lkonf_get_integer(lc, "t.i", &v);
+	ensure_result(lc, res, "get_integer(\"t.i\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"t", "i", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(t i)", LK_OK, "");
+	assert(1 == v);
+
+	res = lkonf_get_double(lc, "t.d", &d);
+	ensure_result(lc, res, "get_double(\"t.d\")", LK_OK, "");
+	assert(2.5 == d);
+	res = lkonf_getkey_double(lc, (lkonf_keys){"t", "d", 0}, &d);
+	ensure_result(lc, res, "getkey_double(t d)", LK_OK, "");
+	assert(2.5 == d);
+
+	/* fail: cached value type mismatch */
+	res = lkonf_get_integer(lc, "t.s", &v);
+	ensure_result(lc, res, "get_integer(\"t.s\")", LK_OUT_OF_RANGE,
+		"Not an integer: t.s");
+	res = lkonf_get_boolean(lc, "t.i", &b);
+	ensure_result(lc, res, "get_boolean(\"t.i\")", LK_OUT_OF_RANGE,
+		"Not a boolean: t.i");
+
+	/* pass: strings are copied from the cache */
+	char *	s1 = 0;
+	char *	s2 = 0;
+	size_t	len = 0;
+	res = lkonf_get_string(lc, "t.s", &s1, &len);
+	ensure_result(lc, res, "get_string(\"t.s\")", LK_OK, "");
+	res = lkonf_getkey_string(lc, (lkonf_keys){"t", "s", 0}, &s2, 0);
+	ensure_result(lc, res, "getkey_string(t s)", LK_OK, "");
+	assert(s1 && s2 && s1 != s2);
+	assert(3 == len);
+	assert(0 == strcmp(s1, "str"));
+	assert(0 == strcmp(s2, "str"));
+	free(s1);
+	free(s2);
+
+	/* pass: function-valued key modifies state, invalidating cache */
+	res = lkonf_get_boolean(lc, "bump", &b);
+	ensure_result(lc, res, "get_boolean(\"bump\")", LK_OK, "");
+	assert(b);
+	res = lkonf_get_integer(lc, "t.i", &v);
+	ensure_result(lc, res, "get_integer(\"t.i\")", LK_OK, "");
+	assert(2 == v);
+
+	/* pass: load invalidates cache */
+	const lkonf_error rls2 = lkonf_load_string(lc, "t.b = false");
+	ensure_result(lc, rls2, "load_string", LK_OK, "");
+	b = true;
+	res = lkonf_get_boolean(lc, "t.b", &b);
+	ensure_result(lc, res, "get_boolean(\"t.b\")", LK_OK, "");
+	assert(! b);
+
+	/* pass: disabling still returns current values */
+	res = lkonf_set_value_cache(lc, false);
+	ensure_result(lc, res, "set_value_cache(false)", LK_OK, "");
+	assert(! lkonf_get_value_cache(lc));
+	res = lkonf_get_integer(lc, "t.i", &v);
+	ensure_result(lc, res, "get_integer(\"t.i\")", LK_OK, "");
+	assert(2 == v);
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_seal(void)
+{
+	printf("lkonf_seal()\n");
+
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_seal(0, "t"));
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"t = { a = { b = 1 }, s = 'x' }\n"
+		"t.a.up = t\n"
+		"alias = t.a\n"
+		"u = { v = 1 }\n"
+		"setb = function (x) t.a.b = 2 return true end\n"
+		"addn = function (x) alias.n = 1 return true end\n"
+		"incv = function (x) u.v = u.v + 1 return true end\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lua_Integer	v = 0;
+	bool		b = false;
+	lkonf_error	res;
+
+	/* fail: invalid paths */
+	res = lkonf_seal(lc, 0);
+	ensure_result(lc, res, "seal(0)", LK_INVALID_ARGUMENT, "iPath NULL");
+	res = lkonf_seal(lc, "t.s");
+	ensure_result(lc, res, "seal(\"t.s\")",
+		LK_OUT_OF_RANGE, "Not a table: t.s");
+	res = lkonf_seal(lc, "missing");
+	ensure_result(lc, res, "seal(\"missing\")",
+		LK_OUT_OF_RANGE, "Not a table: missing");
+
+	/* pass: seal t, including cycle */
+	res = lkonf_seal(lc, "t");
+	ensure_result(lc, res, "seal(\"t\")", LK_OK, "");
+	res = lkonf_seal(lc, "t");
+	ensure_result(lc, res, "seal(\"t\")", LK_OK, "");
+
+	/* pass: values still readable */
+	res = lkonf_get_integer(lc, "t.a.b", &v);
+	ensure_result(lc, res, "get_integer(\"t.a.b\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_get_integer(lc, "t.a.up.a.b", &v);
+	ensure_result(lc, res, "get_integer(\"t.a.up.a.b\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"alias", "b", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(alias b)", LK_OK, "");
+	assert(1 == v);
+
+	/* fail: modifying existing and new keys, via alias too */
+	res = lkonf_get_boolean(lc, "setb", &b);
+	ensure_result(lc, res, "get_boolean(\"setb\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'b'");
+	res = lkonf_get_boolean(lc, "addn", &b);
+	ensure_result(lc, res, "get_boolean(\"addn\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'n'");
+	res = lkonf_load_string(lc, "t.s = 'y'");
+	ensure_result(lc, res, "load_string(\"t.s = 'y'\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 's'");
+	res = lkonf_get_integer(lc, "t.a.b", &v);
+	ensure_result(lc, res, "get_integer(\"t.a.b\")", LK_OK, "");
+	assert(1 == v);
+
+	/* pass: unsealed table still modifiable */
+	res = lkonf_get_boolean(lc, "incv", &b);
+	ensure_result(lc, res, "get_boolean(\"incv\")", LK_OK, "");
+	res = lkonf_get_integer(lc, "u.v", &v);
+	ensure_result(lc, res, "get_integer(\"u.v\")", LK_OK, "");
+	assert(2 == v);
+
+	/* pass: seal globals */
+	res = lkonf_seal(lc, "");
+	ensure_result(lc, res, "seal(\"\")", LK_OK, "");
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+	res = lkonf_get_integer(lc, "u.v", &v);
+	ensure_result(lc, res, "get_integer(\"u.v\")", LK_OK, "");
+	assert(2 == v);
+
+	/* fail: globals and previously unsealed table now sealed */
+	res = lkonf_get_boolean(lc, "incv", &b);
+	ensure_result(lc, res, "get_boolean(\"incv\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'v'");
+	res = lkonf_load_string(lc, "g = 1");
+	ensure_result(lc, res, "load_string(\"g = 1\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'g'");
+
+	/* pass: cached value unchanged after function call */
+	res = lkonf_get_integer(lc, "u.v", &v);
+	ensure_result(lc, res, "get_integer(\"u.v\")", LK_OK, "");
+	assert(2 == v);
+
+	/* fail: copy to sealed table */
+	lua_State * ls = lkonf_get_lua_State(lc);
+	assert(ls);
+	lua_newtable(ls);
+	lua_getglobal(ls, "u");
+	res = lkonf_copy_table_keys(lc, -2, -1, (lkonf_keys){"v", 0});
+	ensure_result(lc, res, "copy_table_keys(u)",
+		LK_OUT_OF_RANGE, "iDstIdx sealed");
+	lua_pop(ls, 2);
+
+	lkonf_destruct(lc);
+
+	lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls2 = lkonf_load_string(lc,
+		"base = { k = 1 }\n"
+		"d = {}\n"
+		"dmeta = { __index = base }\n"
+		"setk = function (x) base.k = 2 return true end\n"
+		"f = {}\n"
+		"do\n"
+		" local c = 0\n"
+		" fmeta = { __index = function (t, k) return c end }\n"
+		" bump = function (x) c = c + 1 return true end\n"
+		"end\n");
+	ensure_result(lc, rls2, "load_string", LK_OK, "");
+
+	ls = lkonf_get_lua_State(lc);
+	assert(ls);
+	lua_getglobal(ls, "d");
+	lua_getglobal(ls, "dmeta");
+	lua_setmetatable(ls, -2);
+	lua_getglobal(ls, "f");
+	lua_getglobal(ls, "fmeta");
+	lua_setmetatable(ls, -2);
+	lua_pop(ls, 2);
+
+	res = lkonf_seal(lc, "");
+	ensure_result(lc, res, "seal(\"\")", LK_OK, "");
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+
+	/* fail: __index table of a metatable is sealed */
+	res = lkonf_get_integer(lc, "d.k", &v);
+	ensure_result(lc, res, "get_integer(\"d.k\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_get_boolean(lc, "setk", &b);
+	ensure_result(lc, res, "get_boolean(\"setk\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'k'");
+
+	/* pass: __index function; cache invalidated by function call */
+	res = lkonf_get_integer(lc, "f.x", &v);
+	ensure_result(lc, res, "get_integer(\"f.x\")", LK_OK, "");
+	assert(0 == v);
+	res = lkonf_get_boolean(lc, "bump", &b);
+	ensure_result(lc, res, "get_boolean(\"bump\")", LK_OK, "");
+	res = lkonf_get_integer(lc, "f.x", &v);
+	ensure_result(lc, res, "get_integer(\"f.x\")", LK_OK, "");
+	assert(1 == v);
+
+	lkonf_destruct(lc);
+
+	/* Standard libraries, which can write tables raw. */
+	lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+	luaL_openlibs(lkonf_get_lua_State(lc));
+
+	const lkonf_error rls3 = lkonf_load_string(lc,
+		"cfg = { a = 1, list = { 10, 20, 30 } }\n"
+		"poke = function (x) rawset(cfg, 'a', 99) return true end\n"
+		"insert = function (x) table.insert(cfg.list, 40) return true end\n"
+		"unmeta = function (x) debug.setmetatable(cfg, nil) return true end\n"
+		"meta = function (x) return debug.getmetatable(cfg) end\n"
+		"npairs = function (x)\n"
+		" local n = 0 for k, v in pairs(cfg) do n = n + 1 end return n\n"
+		"end\n"
+		"sum = function (x)\n"
+		" local s = 0 for i, v in ipairs(cfg.list) do s = s + v end return s\n"
+		"end\n");
+	ensure_result(lc, rls3, "load_string", LK_OK, "");
+
+	res = lkonf_seal(lc, "");
+	ensure_result(lc, res, "seal(\"\")", LK_OK, "");
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+
+	/* fail: raw writes to sealed table */
+	res = lkonf_get_integer(lc, "cfg.a", &v);
+	ensure_result(lc, res, "get_integer(\"cfg.a\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_get_boolean(lc, "poke", &b);
+	ensure_result(lc, res, "get_boolean(\"poke\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign 'a'");
+	res = lkonf_get_integer(lc, "cfg.a", &v);
+	ensure_result(lc, res, "get_integer(\"cfg.a\")", LK_OK, "");
+	assert(1 == v);
+	res = lkonf_get_boolean(lc, "insert", &b);
+	ensure_result(lc, res, "get_boolean(\"insert\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign");
+	res = lkonf_get_boolean(lc, "unmeta", &b);
+	ensure_result(lc, res, "get_boolean(\"unmeta\")",
+		LK_LUA_ERROR, "Sealed table: cannot assign");
+
+	/* pass: storage not exposed */
+	char * str = 0;
+	res = lkonf_get_string(lc, "meta", &str, 0);
+	ensure_result(lc, res, "get_string(\"meta\")", LK_OK, "");
+	assert(0 == strcmp("sealed", str));
+	free(str);
+
+	/* pass: iteration from Lua */
+	res = lkonf_get_integer(lc, "npairs", &v);
+	ensure_result(lc, res, "get_integer(\"npairs\")", LK_OK, "");
+	lua_Integer v2 = 0;
+	res = lkonf_get_integer(lc, "sum", &v2);
+	ensure_result(lc, res, "get_integer(\"sum\")", LK_OK, "");
+#if LUA_VERSION_NUM >= 502
+	assert(2 == v);
+	assert(60 == v2);
+#elif ! defined(LKONF_LUAJIT)
+	assert(0 == v);
+	assert(0 == v2);
+#endif
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_integer_keys(void)
+{
+	printf("integer keys\n");
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"servers = {\n"
+		"  { host = 'a', port = 80, up = true, load = 0.5 },\n"
+		"  { host = 'b', port = 81, up = false, load = 1.5 },\n"
+		"  { host = 'c', port = function (x) return #x end },\n"
+		"}\n"
+		"grid = { { 11, 12 }, { 21, 22 } }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lua_Integer	v = 0;
+	double		d = 0;
+	bool		b = true;
+	lkonf_error	res;
+
+	/* pass: path forms */
+	res = lkonf_get_integer(lc, "servers[2].port", &v);
+	ensure_result(lc, res, "get_integer(\"servers[2].port\")", LK_OK, "");
+	assert(81 == v);
+	res = lkonf_get_integer(lc, "servers.1.port", &v);
+	ensure_result(lc, res, "get_integer(\"servers.1.port\")", LK_OK, "");
+	assert(80 == v);
+	res = lkonf_get_integer(lc, "grid[2][1]", &v);
+	ensure_result(lc, res, "get_integer(\"grid[2][1]\")", LK_OK, "");
+	assert(21 == v);
+
+	/* pass: function called with path */
+	res = lkonf_get_integer(lc, "servers[3].port", &v);
+	ensure_result(lc, res, "get_integer(\"servers[3].port\")", LK_OK, "");
+	assert(15 == v);
+
+	/* fail: invalid and missing indexes */
+	res = lkonf_get_integer(lc, "servers[x].port", &v);
+	ensure_result(lc, res, "get_integer(\"servers[x].port\")",
+		LK_OUT_OF_RANGE, "Invalid index in: servers[x].port");
+	res = lkonf_get_integer(lc, "servers[1]port", &v);
+	ensure_result(lc, res, "get_integer(\"servers[1]port\")",
+		LK_OUT_OF_RANGE, "Invalid index in: servers[1]port");
+	res = lkonf_get_integer(lc, "servers[1", &v);
+	ensure_result(lc, res, "get_integer(\"servers[1\")",
+		LK_OUT_OF_RANGE, "Invalid index in: servers[1");
+	res = lkonf_get_integer(lc, "[1]", &v);
+	ensure_result(lc, res, "get_integer(\"[1]\")",
+		LK_OUT_OF_RANGE, "Invalid index in: [1]");
+	res = lkonf_get_integer(lc, "servers[4].port", &v);
+	ensure_result(lc, res, "get_integer(\"servers[4].port\")",
+		LK_OUT_OF_RANGE, "Not a table: servers[4]");
+	res = lkonf_get_integer(lc, "servers[2].port[1]", &v);
+	ensure_result(lc, res, "get_integer(\"servers[2].port[1]\")",
+		LK_OUT_OF_RANGE, "Not a table: servers[2].port");
+
+	/* pass: lkonf_ikeys */
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(2), LK_NAME("port"),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(servers[2].port)", LK_OK, "");
+	assert(81 == v);
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("grid"), LK_INDEX(1), LK_INDEX(2),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(grid[1][2])", LK_OK, "");
+	assert(12 == v);
+	res = lkonf_getikey_boolean(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(2), LK_NAME("up"),
+		    LK_END }, &b);
+	ensure_result(lc, res, "getikey_boolean(servers[2].up)", LK_OK, "");
+	assert(! b);
+	res = lkonf_getikey_double(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(2), LK_NAME("load"),
+		    LK_END }, &d);
+	ensure_result(lc, res, "getikey_double(servers[2].load)", LK_OK, "");
+	assert(1.5 == d);
+	char *	str = 0;
+	size_t	len = 0;
+	res = lkonf_getikey_string(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(1), LK_NAME("host"),
+		    LK_END }, &str, &len);
+	ensure_result(lc, res, "getikey_string(servers[1].host)", LK_OK, "");
+	assert(str && 1 == len && 0 == strcmp(str, "a"));
+	free(str);
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(3), LK_NAME("port"),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(servers[3].port)", LK_OK, "");
+	assert(15 == v);
+
+	/* fail: lkonf_ikeys */
+	res = lkonf_getikey_integer(lc, (lkonf_ikeys){ LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer()",
+		LK_OUT_OF_RANGE, "Empty keys");
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(9), LK_NAME("port"),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(servers[9].port)",
+		LK_OUT_OF_RANGE, "Not a table: servers[9]");
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("servers"), LK_INDEX(1), LK_NAME("host"),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(servers[1].host)",
+		LK_OUT_OF_RANGE, "Not an integer: servers[1].host");
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("grid"), LK_INDEX(3), LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(grid[3])", LK_NOT_FOUND, "");
+
+	/* pass: sealed arrays */
+	res = lkonf_seal(lc, "grid");
+	ensure_result(lc, res, "seal(\"grid\")", LK_OK, "");
+	res = lkonf_get_integer(lc, "grid[2][2]", &v);
+	ensure_result(lc, res, "get_integer(\"grid[2][2]\")", LK_OK, "");
+	assert(22 == v);
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("grid"), LK_INDEX(1), LK_INDEX(1),
+		    LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(grid[1][1])", LK_OK, "");
+	assert(11 == v);
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Iterate path with mode, and format "key=value " pairs into buf.
+ */
+void
+iterate(
+	lkonf_context *	lc,
+	const char *	path,
+	const int	mode,
+	char *		buf,
+	size_t		buflen)
+{
+	lkonf_iter * it = 0;
+	lkonf_error res = lkonf_iter_begin(lc, path, mode, &it);
+	ensure_result(lc, res, "iter_begin", LK_OK, "");
+	assert(it);
+
+	buf[0] = '\0';
+	lkonf_value	k, v;
+	while (LK_OK == (res = lkonf_iter_next(it, &k, &v))) {
+		char kv[64];
+		const size_t used = strlen(buf);
+		if (LK_TYPE_STRING == k.type) {
+			snprintf(kv, sizeof(kv), "%s=", k.string);
+		} else {
+			assert(LK_TYPE_NUMBER == k.type);
+			snprintf(kv, sizeof(kv), "%ld=", (long)k.integer);
+		}
+		snprintf(buf + used, buflen - used, "%s", kv);
+		const size_t used2 = strlen(buf);
+		switch (v.type) {
+		case LK_TYPE_STRING:
+			snprintf(buf + used2, buflen - used2, "%s ", v.string);
+			break;
+		case LK_TYPE_NUMBER:
+			snprintf(buf + used2, buflen - used2, "%g ", v.number);
+			break;
+		case LK_TYPE_BOOLEAN:
+			snprintf(buf + used2, buflen - used2, "%s ",
+				v.boolean ? "true" : "false");
+			break;
+		case LK_TYPE_FUNCTION:
+			snprintf(buf + used2, buflen - used2, "function ");
+			break;
+		default:
+			snprintf(buf + used2, buflen - used2, "? ");
+			break;
+		}
+	}
+	ensure_result(lc, res, "iter_next", LK_NOT_FOUND, "");
+
+		/* still at the end */
+	res = lkonf_iter_next(it, &k, &v);
+	ensure_result(lc, res, "iter_next", LK_NOT_FOUND, "");
+
+	lkonf_iter_end(it);
+}
+
+int
+test_iter(void)
+{
+	printf("lkonf_iter_*()\n");
+
+	/* fail: null arguments */
+	assert(LK_INVALID_ARGUMENT == lkonf_iter_begin(0, "t", 0, 0));
+	assert(LK_INVALID_ARGUMENT == lkonf_iter_next(0, 0, 0));
+	lkonf_iter_end(0);
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"t = { 'a', 'b', 'c', z = 'zed', y = true, x = 1,"
+		" [10] = 10, f = function (x) return 1 end }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lkonf_iter *	it = 0;
+	lkonf_error	res;
+	char		buf[256];
+
+	/* fail: invalid arguments */
+	res = lkonf_iter_begin(lc, "t", 0, 0);
+	ensure_result(lc, res, "iter_begin(oIter NULL)",
+		LK_INVALID_ARGUMENT, "oIter NULL");
+	res = lkonf_iter_begin(lc, "t", 1<<8, &it);
+	ensure_result(lc, res, "iter_begin(1<<8)",
+		LK_INVALID_ARGUMENT, "iMode invalid");
+	res = lkonf_iter_begin(lc, "t.z", 0, &it);
+	ensure_result(lc, res, "iter_begin(\"t.z\")",
+		LK_OUT_OF_RANGE, "Not a table: t.z");
+	assert(! it);
+
+	/* pass: array */
+	iterate(lc, "t", LK_ITER_ARRAY, buf, sizeof(buf));
+	assert(0 == strcmp(buf, "1=a 2=b 3=c "));
+
+	/* pass: sorted hash, twice (cached) */
+	iterate(lc, "t", LK_ITER_HASH | LK_ITER_SORTED, buf, sizeof(buf));
+	assert(0 == strcmp(buf, "10=10 f=function x=1 y=true z=zed "));
+	iterate(lc, "t", LK_ITER_HASH | LK_ITER_SORTED, buf, sizeof(buf));
+	assert(0 == strcmp(buf, "10=10 f=function x=1 y=true z=zed "));
+
+	/* pass: sorted all */
+	iterate(lc, "t", LK_ITER_SORTED, buf, sizeof(buf));
+	assert(0 == strcmp(buf,
+		"1=a 2=b 3=c 10=10 f=function x=1 y=true z=zed "));
+
+	/* pass: unsorted all; array first */
+	iterate(lc, "t", 0, buf, sizeof(buf));
+	assert(0 == strncmp(buf, "1=a 2=b 3=c ", 12));
+	assert(strlen(buf) == strlen(
+		"1=a 2=b 3=c 10=10 f=function x=1 y=true z=zed "));
+
+	/* pass: sealed */
+	res = lkonf_seal(lc, "t");
+	ensure_result(lc, res, "seal(\"t\")", LK_OK, "");
+	iterate(lc, "t", LK_ITER_SORTED, buf, sizeof(buf));
+	assert(0 == strcmp(buf,
+		"1=a 2=b 3=c 10=10 f=function x=1 y=true z=zed "));
+
+	/* pass: globals */
+	iterate(lc, "", LK_ITER_SORTED, buf, sizeof(buf));
+	assert(0 == strcmp(buf, "t=? "));
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_array(void)
+{
+	printf("lkonf_get_*_array()\n");
+
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_get_integer_array(0, "a", 0, 0));
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	const lkonf_error rls = lkonf_load_string(lc,
+		"ai = { 1, 2, 3, 4 }\n"
+		"ad = { 0.5, 1.5, 2 }\n"
+		"ab = { true, false, true }\n"
+		"am = { 1, 2, 'three', 4 }\n"
+		"ae = {}\n"
+		"af = function (x) return { 7, 8 } end\n"
+		"s = 'str'\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	lua_Integer	vi[4];
+	double		vd[4];
+	bool		vb[4];
+	size_t		len;
+	lkonf_error	res;
+
+	/* fail: null ioLen */
+	res = lkonf_get_integer_array(lc, "ai", vi, 0);
+	ensure_result(lc, res, "get_integer_array(\"ai\")",
+		LK_INVALID_ARGUMENT, "ioLen NULL");
+
+	/* pass: length only */
+	len = 0;
+	res = lkonf_get_integer_array(lc, "ai", 0, &len);
+	ensure_result(lc, res, "get_integer_array(\"ai\")", LK_OK, "");
+	assert(4 == len);
+
+	/* pass: integers */
+	len = 4;
+	res = lkonf_get_integer_array(lc, "ai", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"ai\")", LK_OK, "");
+	assert(4 == len);
+	assert(1 == vi[0] && 2 == vi[1] && 3 == vi[2] && 4 == vi[3]);
+
+	/* pass: doubles */
+	len = 4;
+	res = lkonf_get_double_array(lc, "ad", vd, &len);
+	ensure_result(lc, res, "get_double_array(\"ad\")", LK_OK, "");
+	assert(3 == len);
+	assert(0.5 == vd[0] && 1.5 == vd[1] && 2 == vd[2]);
+
+	/* pass: booleans */
+	len = 4;
+	res = lkonf_get_boolean_array(lc, "ab", vb, &len);
+	ensure_result(lc, res, "get_boolean_array(\"ab\")", LK_OK, "");
+	assert(3 == len);
+	assert(vb[0] && ! vb[1] && vb[2]);
+
+	/* pass: empty */
+	len = 4;
+	res = lkonf_get_integer_array(lc, "ae", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"ae\")", LK_OK, "");
+	assert(0 == len);
+
+	/* pass: function result */
+	len = 4;
+	res = lkonf_get_integer_array(lc, "af", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"af\")", LK_OK, "");
+	assert(2 == len && 7 == vi[0] && 8 == vi[1]);
+
+	/* fail: type mismatch gives index */
+	len = 4;
+	res = lkonf_get_integer_array(lc, "am", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"am\")",
+		LK_OUT_OF_RANGE, "Not an integer: am[3]");
+	assert(3 == len);
+	len = 4;
+	res = lkonf_get_boolean_array(lc, "ai", vb, &len);
+	ensure_result(lc, res, "get_boolean_array(\"ai\")",
+		LK_OUT_OF_RANGE, "Not a boolean: ai[1]");
+	assert(1 == len);
+
+	/* fail: buffer too small */
+	len = 3;
+	res = lkonf_get_integer_array(lc, "ai", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"ai\")",
+		LK_OUT_OF_RANGE, "Array longer than buffer: ai");
+	assert(4 == len);
+
+	/* fail: not a table, missing */
+	len = 4;
+	res = lkonf_get_double_array(lc, "s", vd, &len);
+	ensure_result(lc, res, "get_double_array(\"s\")",
+		LK_OUT_OF_RANGE, "Not a table: s");
+	res = lkonf_get_double_array(lc, "missing", vd, &len);
+	ensure_result(lc, res, "get_double_array(\"missing\")",
+		LK_NOT_FOUND, "");
+
+	/* pass: sealed */
+	res = lkonf_seal(lc, "ai");
+	ensure_result(lc, res, "seal(\"ai\")", LK_OK, "");
+	len = 4;
+	res = lkonf_get_integer_array(lc, "ai", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"ai\")", LK_OK, "");
+	assert(4 == len && 4 == vi[3]);
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_typed_array(void)
+{
+	printf("typed arrays\n");
+
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_open_typed_arrays(0));
+	assert(LK_INVALID_ARGUMENT == lkonf_get_typed_array(0, "a", 0, 0, 0));
+
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
+
+	lkonf_error res;
+
+	/* fail: constructors not available by default */
+	res = lkonf_load_string(lc, "x = f64{ 1 }");
+	ensure_result(lc, res, "load_string(\"x = f64{ 1 }\")",
+		LK_LUA_ERROR,
+		"[string \"x = f64{ 1 }\"]:1: " NIL_CALL("f64"));
+
+	res = lkonf_open_typed_arrays(lc);
+	ensure_result(lc, res, "open_typed_arrays", LK_OK, "");
+
+	res = lkonf_load_string(lc,
+		"bounds = f64{ 0.5, 1, 2.25 }\n"
+		"small = u8{ 0, 255, 7 }\n"
+		"wide = i32{ -2147483648, 2147483647 }\n"
+		"half = f32{ 0.5 }\n"
+		"short = i16{ -3 }\n"
+		"big = i64{ 4294967296 }\n"
+		"empty = i32{}\n"
+		"n = #bounds\n"
+		"second = small[2]\n"
+		"fn = function (x) return bounds end\n"
+		"t = {}\n");
+	ensure_result(lc, res, "load_string", LK_OK, "");
+
+	lkonf_array_type	type;
+	const void *		data = 0;
+	size_t			len = 0;
+	lua_Integer		v = 0;
+
+	/* pass: types */
+	res = lkonf_get_typed_array(lc, "bounds", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"bounds\")", LK_OK, "");
+	assert(LK_ARRAY_F64 == type && 3 == len);
+	assert(0.5 == ((const double *)data)[0]);
+	assert(2.25 == ((const double *)data)[2]);
+	const double * bounds = data;
+
+	res = lkonf_get_typed_array(lc, "small", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"small\")", LK_OK, "");
+	assert(LK_ARRAY_U8 == type && 3 == len);
+	assert(255 == ((const uint8_t *)data)[1]);
+
+	res = lkonf_get_typed_array(lc, "wide", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"wide\")", LK_OK, "");
+	assert(LK_ARRAY_I32 == type && 2 == len);
+	assert(INT32_MIN == ((const int32_t *)data)[0]);
+
+	res = lkonf_get_typed_array(lc, "half", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"half\")", LK_OK, "");
+	assert(LK_ARRAY_F32 == type && 1 == len);
+	assert(0.5f == ((const float *)data)[0]);
+
+	res = lkonf_get_typed_array(lc, "short", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"short\")", LK_OK, "");
+	assert(LK_ARRAY_I16 == type && -3 == ((const int16_t *)data)[0]);
+
+	res = lkonf_get_typed_array(lc, "big", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"big\")", LK_OK, "");
+	assert(LK_ARRAY_I64 == type);
+	assert(INT64_C(4294967296) == ((const int64_t *)data)[0]);
+
+	res = lkonf_get_typed_array(lc, "empty", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"empty\")", LK_OK, "");
+	assert(LK_ARRAY_I32 == type && 0 == len);
+
+	/* pass: function result */
+	res = lkonf_get_typed_array(lc, "fn", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"fn\")", LK_OK, "");
+	assert(data == bounds);
+
+	/* pass: length and index from Lua */
+	res = lkonf_get_integer(lc, "n", &v);
+	ensure_result(lc, res, "get_integer(\"n\")", LK_OK, "");
+	assert(3 == v);
+	res = lkonf_get_integer(lc, "second", &v);
+	ensure_result(lc, res, "get_integer(\"second\")", LK_OK, "");
+	assert(255 == v);
+
+	/* fail: not a typed array */
+	res = lkonf_get_typed_array(lc, "t", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"t\")",
+		LK_OUT_OF_RANGE, "Not a typed array: t");
+	res = lkonf_get_typed_array(lc, "missing", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"missing\")",
+		LK_NOT_FOUND, "");
+	res = lkonf_get_typed_array(lc, "bounds", 0, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"bounds\")",
+		LK_INVALID_ARGUMENT, "oType NULL");
+
+	/* fail: out of range elements, writes */
+	res = lkonf_load_string(lc, "x = u8{ 256 }");
+	ensure_result(lc, res, "load_string(\"x = u8{ 256 }\")",
+		LK_LUA_ERROR, "Invalid typed array element 1");
+	res = lkonf_load_string(lc, "x = i32{ 1, 2.5 }");
+	ensure_result(lc, res, "load_string(\"x = i32{ 1, 2.5 }\")",
+		LK_LUA_ERROR, "Invalid typed array element 2");
+	res = lkonf_load_string(lc, "x = f64{ 'a' }");
+	ensure_result(lc, res, "load_string(\"x = f64{ 'a' }\")",
+		LK_LUA_ERROR, "Invalid typed array element 1");
+	res = lkonf_load_string(lc, "bounds[1] = 3");
+	ensure_result(lc, res, "load_string(\"bounds[1] = 3\")",
+		LK_LUA_ERROR, "Typed array is read-only");
+
+#if LUA_VERSION_NUM >= 503
+	/* pass: 64-bit integers beyond 2^53 are exact */
+	res = lkonf_load_string(lc,
+		"huge = i64{ 9007199254740993 } h = huge[1]");
+	ensure_result(lc, res, "load_string(\"huge\")", LK_OK, "");
+	res = lkonf_get_typed_array(lc, "huge", &type, &data, &len);
+	ensure_result(lc, res, "get_typed_array(\"huge\")", LK_OK, "");
+	assert(INT64_C(9007199254740993) == ((const int64_t *)data)[0]);
+	res = lkonf_get_integer(lc, "h", &v);
+	ensure_result(lc, res, "get_integer(\"h\")", LK_OK, "");
+	assert(INT64_C(9007199254740993) == v);
+#endif
+
+	lkonf_destruct(lc);
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_columns(void)
 {
-	printf("lkonf_construct()\n");
+	printf("lkonf_get_columns()\n");
 
-	/* construct lkonf_context, confirm initial state */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT ==
+		lkonf_get_columns(0, "b", 0, 0, 0, 0, 0));
 
-		const lkonf_error errcode = lkonf_get_error_code(lc);
-		assert(LK_OK == errcode && "errcode != LK_OK");
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-		const char * errstr = lkonf_get_error_string(lc);
-		assert(0 != errstr && "errstr == 0");
-		assert(0 == errstr[0] && "errstr[0] not empty");
+	const lkonf_error rls = lkonf_load_string(lc,
+		"backends = {\n"
+		"  { host = 'a', port = 80, weight = 0.5, up = true },\n"
+		"  { host = 'b', port = 81 },\n"
+		"  { host = 'c', port = 'x', weight = 'y', up = true },\n"
+		"  7,\n"
+		"}\n"
+		"good = { { host = 'a', port = 1 }, { host = 'b', port = 2 } }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
 
-		lua_State * ls = lkonf_get_lua_State(lc);
-		assert(0 != ls && "lua_State == 0");
+	const lkonf_column_spec cols[] = {
+		{ "host",	LK_COLUMN_STRING,	true,	{ .string = 0 } },
+		{ "port",	LK_COLUMN_INTEGER,	true,	{ .integer = 0 } },
+		{ "weight",	LK_COLUMN_DOUBLE,	false,	{ .number = 1 } },
+		{ "up",		LK_COLUMN_BOOLEAN,	false,	{ .boolean = false } },
+	};
+	const char *	host[4];
+	lua_Integer	port[4];
+	double		weight[4];
+	bool		up[4];
+	void * const	columns[] = { host, port, weight, up };
+	lkonf_error	errors[4];
+	size_t		rows;
+	lkonf_error	res;
+
+	/* pass: number of rows */
+	rows = 0;
+	res = lkonf_get_columns(lc, "backends", cols, 4, 0, &rows, 0);
+	ensure_result(lc, res, "get_columns(\"backends\")", LK_OK, "");
+	assert(4 == rows);
+
+	/* pass: all good */
+	rows = 4;
+	res = lkonf_get_columns(lc, "good", cols, 4, columns, &rows, 0);
+	ensure_result(lc, res, "get_columns(\"good\")", LK_OK, "");
+	assert(2 == rows);
+	assert(0 == strcmp(host[1], "b") && 2 == port[1]);
+	assert(1 == weight[0] && ! up[0]);
+
+	/* pass: per-row errors */
+	rows = 4;
+	res = lkonf_get_columns(lc, "backends", cols, 4, columns, &rows, errors);
+	ensure_result(lc, res, "get_columns(\"backends\")", LK_OK, "");
+	assert(4 == rows);
+	assert(LK_OK == errors[0] && LK_OK == errors[1]);
+	assert(LK_OUT_OF_RANGE == errors[2] && LK_OUT_OF_RANGE == errors[3]);
+	assert(0 == strcmp(host[0], "a") && 80 == port[0]);
+	assert(0.5 == weight[0] && up[0]);
+	assert(81 == port[1] && 1 == weight[1] && ! up[1]);
+	assert(0 == host[2] && 0 == port[2]);
+	assert(1 == weight[2] && ! up[2]);
+	assert(0 == host[3]);
+
+	/* fail: first error */
+	rows = 4;
+	res = lkonf_get_columns(lc, "backends", cols, 4, columns, &rows, 0);
+	ensure_result(lc, res, "get_columns(\"backends\")",
+		LK_OUT_OF_RANGE, "Wrong type: backends[3].port");
+	assert(3 == rows);
+
+	/* fail: required field missing */
+	const lkonf_column_spec need[] = {
+		{ "up",	LK_COLUMN_BOOLEAN,	true,	{ .boolean = false } },
+	};
+	rows = 4;
+	res = lkonf_get_columns(lc, "backends", need, 1, columns + 3, &rows, 0);
+	ensure_result(lc, res, "get_columns(\"backends\")",
+		LK_NOT_FOUND, "Missing: backends[2].up");
+	assert(2 == rows);
+
+	/* fail: buffer too small */
+	rows = 3;
+	res = lkonf_get_columns(lc, "backends", cols, 4, columns, &rows, 0);
+	ensure_result(lc, res, "get_columns(\"backends\")",
+		LK_OUT_OF_RANGE, "Array longer than buffer: backends");
+	assert(4 == rows);
+
+	/* fail: null ioRows */
+	res = lkonf_get_columns(lc, "backends", cols, 4, columns, 0, 0);
+	ensure_result(lc, res, "get_columns(\"backends\")",
+		LK_INVALID_ARGUMENT, "ioRows NULL");
 
-		lkonf_destruct(lc);
-	}
+	lkonf_destruct(lc);
 
 	return EXIT_SUCCESS;
 }
 
+struct bind_http
+{
+	lua_Integer	timeout;
+	char *		name;
+	bool		keepalive;
+};
+
+struct bind_config
+{
+	struct bind_http	http;
+	double			ratio;
+	lua_Integer		ports[4];
+	size_t			num_ports;
+	lua_Integer		retries;
+};
+
+/**
+ * Count errors reported by lkonf_bind(), remembering the last path.
+ */
+static void
+bind_report(
+	void *			iArg,
+	const char *		iPath,
+	const lkonf_error	iCode,
+	const char *		iString)
+{
+	printf("bind error %d at %s: %s\n", iCode, iPath, iString);
+	++*(int *)iArg;
+}
 
 int
-test_destruct(void)
+test_bind(void)
 {
-	printf("lkonf_destruct()\n");
+	printf("lkonf_bind()\n");
 
-	/* destruct a default lkonf_context */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_bind(0, "", 0, 0, 0, 0, 0));
 
-		lkonf_destruct(lc);
-	}
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-	/* destruct a NULL pointer (should be a no-op) */
-	{
-		lkonf_destruct(0);
-	}
+	const lkonf_error rls = lkonf_load_string(lc,
+		"app = {\n"
+		"  http = { timeout = 30, name = 'web' },\n"
+		"  ratio = function (path) return #path end,\n"
+		"  ports = { 80, 443 },\n"
+		"}\n"
+		"bad = { http = { timeout = 'x' }, ports = { 1, 2, 3, 4, 5 } }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+
+	const lkonf_binding http[] = {
+		{ "timeout", LK_BIND_INTEGER,
+		  offsetof(struct bind_http, timeout), true,
+		  { .integer = 10 }, 0, 0, 0 },
+		{ "name", LK_BIND_STRING,
+		  offsetof(struct bind_http, name), false,
+		  { .string = "none" }, 0, 0, 0 },
+		{ "keepalive", LK_BIND_BOOLEAN,
+		  offsetof(struct bind_http, keepalive), false,
+		  { .boolean = true }, 0, 0, 0 },
+	};
+	const lkonf_binding bindings[] = {
+		{ "http", LK_BIND_STRUCT,
+		  offsetof(struct bind_config, http), false,
+		  { .integer = 0 }, http, 3, 0 },
+		{ "ratio", LK_BIND_DOUBLE,
+		  offsetof(struct bind_config, ratio), false,
+		  { .number = 0 }, 0, 0, 0 },
+		{ "ports", LK_BIND_INTEGER_ARRAY,
+		  offsetof(struct bind_config, ports), false,
+		  { .integer = 0 }, 0, 4,
+		  offsetof(struct bind_config, num_ports) },
+		{ "retries", LK_BIND_INTEGER,
+		  offsetof(struct bind_config, retries), false,
+		  { .integer = 3 }, 0, 0, 0 },
+	};
+	struct bind_config	cfg;
+	int			errors;
+	lkonf_error		res;
+
+	/* pass: nested struct, function, array and fallbacks */
+	memset(&cfg, 0, sizeof(cfg));
+	errors = 0;
+	res = lkonf_bind(lc, "app", bindings, 4, &cfg, bind_report, &errors);
+	ensure_result(lc, res, "bind(\"app\")", LK_OK, "");
+	assert(0 == errors);
+	assert(30 == cfg.http.timeout && cfg.http.keepalive);
+	assert(0 == strcmp(cfg.http.name, "web"));
+	assert(9 == cfg.ratio);
+	assert(2 == cfg.num_ports && 443 == cfg.ports[1]);
+	assert(3 == cfg.retries);
+	free(cfg.http.name);
+
+	/* fail: every error reported, first one returned */
+	memset(&cfg, 0, sizeof(cfg));
+	errors = 0;
+	res = lkonf_bind(lc, "bad", bindings, 4, &cfg, bind_report, &errors);
+	ensure_result(lc, res, "bind(\"bad\")",
+		LK_OUT_OF_RANGE, "Not an integer: bad.http.timeout");
+	assert(2 == errors);
+	assert(10 == cfg.http.timeout && 0 == strcmp(cfg.http.name, "none"));
+	assert(0 == cfg.num_ports);
+	free(cfg.http.name);
+
+	/* fail: required field of optional struct */
+	memset(&cfg, 0, sizeof(cfg));
+	errors = 0;
+	res = lkonf_bind(lc, "", http, 3, &cfg.http, bind_report, &errors);
+	ensure_result(lc, res, "bind(\"\")", LK_NOT_FOUND, "Missing: timeout");
+	assert(1 == errors);
+	assert(10 == cfg.http.timeout);
+	free(cfg.http.name);
+
+	/* pass: missing optional struct uses fallbacks */
+	memset(&cfg, 0, sizeof(cfg));
+	res = lkonf_bind(lc, "bad.ports", bindings, 1, &cfg, 0, 0);
+	ensure_result(lc, res, "bind(\"bad.ports\")", LK_OK, "");
+	assert(10 == cfg.http.timeout && cfg.http.keepalive);
+	free(cfg.http.name);
+
+	/* fail: root not a table */
+	res = lkonf_bind(lc, "app.http.timeout", bindings, 4, &cfg, 0, 0);
+	ensure_result(lc, res, "bind(\"app.http.timeout\")",
+		LK_OUT_OF_RANGE, "Not a table: app.http.timeout");
+
+	/* fail: null oStruct */
+	res = lkonf_bind(lc, "app", bindings, 4, 0, 0, 0);
+	ensure_result(lc, res, "bind(\"app\")",
+		LK_INVALID_ARGUMENT, "oStruct NULL");
+
+	lkonf_destruct(lc);
 
 	return EXIT_SUCCESS;
 }
 
+/**
+ * Count violations reported by lkonf_validate().
+ */
+static void
+validate_report(
+	void *			iArg,
+	const char *		iPath,
+	const lkonf_error	iCode,
+	const char *		iString)
+{
+	printf("violation %d at %s: %s\n", iCode, iPath, iString);
+	++*(int *)iArg;
+}
 
 int
-test_load_file(void)
+test_validate(void)
 {
-	printf("lkonf_load_file()\n");
+	printf("lkonf_validate()\n");
 
-	/* fail: load null lkonf_context */
-	{
-		const lkonf_error res = lkonf_load_file(0, 0);
-		assert(LK_INVALID_ARGUMENT == res);
-	}
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_compile_schema(0, 0, 0));
+	assert(LK_INVALID_ARGUMENT == lkonf_validate(0, "", 0, 0));
 
-/* TODO: fail: load lkonf_context with null state */
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-	/* fail: load with filename null pointer */
-	{
-		lkonf_context * lc = lkonf_construct();
+	const lkonf_error rls = lkonf_load_string(lc,
+		"server = {\n"
+		"  name = 'web', port = 8080, ratio = 0.5, debug = true,\n"
+		"  backends = { { host = 'a', port = 80 }, { host = 'b', port = 81 } },\n"
+		"  workers = function (path) return 4 end,\n"
+		"}\n"
+		"bad = { name = 7, port = 70000, extra = 1,\n"
+		"  backends = { { host = 'a' } } }\n"
+		"bad2 = { name = 'x', port = 1,\n"
+		"  backends = { { host = 'a', port = 1 }, { host = 'b', port = 0.5 } } }\n"
+		"nests = { ok = { {}, { {}, {} } }, bad = { { {} }, { 1 } } }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
 
-		assert(lc && "lkonf_construct returned 0");
-		const lkonf_error res = lkonf_load_file(lc, 0);
-		ensure_result(lc, res,
-			"load_file(lc, 0)", LK_INVALID_ARGUMENT, "iFile NULL");
+	const lkonf_schema backend[] = {
+		{ .name = "host", .type = LK_SCHEMA_STRING,
+		  .flags = LK_SCHEMA_REQUIRED },
+		{ .name = "port", .type = LK_SCHEMA_INTEGER,
+		  .flags = LK_SCHEMA_REQUIRED | LK_SCHEMA_RANGE,
+		  .minimum = 1, .maximum = 65535 },
+	};
+	const lkonf_schema element = {
+		.type = LK_SCHEMA_TABLE, .fields = backend, .count = 2 };
+	const lkonf_schema server[] = {
+		{ .name = "name", .type = LK_SCHEMA_STRING,
+		  .flags = LK_SCHEMA_REQUIRED },
+		{ .name = "port", .type = LK_SCHEMA_INTEGER,
+		  .flags = LK_SCHEMA_REQUIRED | LK_SCHEMA_RANGE,
+		  .minimum = 1, .maximum = 65535 },
+		{ .name = "ratio", .type = LK_SCHEMA_NUMBER,
+		  .flags = LK_SCHEMA_RANGE, .minimum = 0, .maximum = 1 },
+		{ .name = "debug", .type = LK_SCHEMA_BOOLEAN },
+		{ .name = "backends", .type = LK_SCHEMA_ARRAY,
+		  .fields = &element, .count = 1 },
+		{ .name = "workers", .type = LK_SCHEMA_INTEGER },
+	};
+	const lkonf_schema root = {
+		.type = LK_SCHEMA_TABLE, .fields = server, .count = 6 };
+
+	lkonf_validator *	v = 0;
+	int			violations;
+	lkonf_error		res;
+
+	/* pass: compile */
+	res = lkonf_compile_schema(lc, &root, &v);
+	ensure_result(lc, res, "compile_schema(root)", LK_OK, "");
+	assert(v);
+
+	/* pass: valid, function values not called */
+	violations = 0;
+	res = lkonf_validate(v, "server", validate_report, &violations);
+	ensure_result(lc, res, "validate(\"server\")", LK_OK, "");
+	assert(0 == violations);
+
+	/* fail: all violations reported */
+	violations = 0;
+	res = lkonf_validate(v, "bad", validate_report, &violations);
+	assert(LK_OK != res);
+	assert(4 == violations);
+
+	/* fail: array element */
+	violations = 0;
+	res = lkonf_validate(v, "bad2", validate_report, &violations);
+	ensure_result(lc, res, "validate(\"bad2\")",
+		LK_OUT_OF_RANGE, "Not an integer: bad2.backends[2].port");
+	assert(1 == violations);
+
+	/* fail: globals have unknown keys and missing name */
+	violations = 0;
+	res = lkonf_validate(v, "", validate_report, &violations);
+	assert(LK_OK != res);
+	assert(6 == violations);
+
+	/* fail: not a table */
+	res = lkonf_validate(v, "server.name", 0, 0);
+	ensure_result(lc, res, "validate(\"server.name\")",
+		LK_OUT_OF_RANGE, "Not a table: server.name");
+
+	lkonf_free_validator(v);
+
+	/* pass: array whose element is itself */
+	const lkonf_schema nested = {
+		.type = LK_SCHEMA_ARRAY, .fields = &nested, .count = 1 };
+	res = lkonf_compile_schema(lc, &nested, &v);
+	ensure_result(lc, res, "compile_schema(nested)", LK_OK, "");
+	assert(v);
+
+	violations = 0;
+	res = lkonf_validate(v, "nests.ok", validate_report, &violations);
+	ensure_result(lc, res, "validate(\"nests.ok\")", LK_OK, "");
+	assert(0 == violations);
+
+	violations = 0;
+	res = lkonf_validate(v, "nests.bad", validate_report, &violations);
+	assert(LK_OK != res);
+	assert(1 == violations);
+
+	lkonf_free_validator(v);
+
+	/* fail: duplicate name */
+	const lkonf_schema dup[] = {
+		{ .name = "a", .type = LK_SCHEMA_ANY },
+		{ .name = "a", .type = LK_SCHEMA_BOOLEAN },
+	};
+	const lkonf_schema duproot = {
+		.type = LK_SCHEMA_TABLE, .fields = dup, .count = 2 };
+	res = lkonf_compile_schema(lc, &duproot, &v);
+	ensure_result(lc, res, "compile_schema(duproot)",
+		LK_INVALID_ARGUMENT, "Duplicate schema name: a");
+	assert(0 == v);
+
+	/* fail: root not a table */
+	res = lkonf_compile_schema(lc, &dup[0], &v);
+	ensure_result(lc, res, "compile_schema(dup[0])",
+		LK_INVALID_ARGUMENT, "iSchema not a table");
 
-		lkonf_destruct(lc);
-	}
+	lkonf_destruct(lc);
 
 	return EXIT_SUCCESS;
 }
 
-
 int
-test_load_string(void)
+test_static(void)
 {
-	printf("lkonf_load_string()\n");
+	printf("lkonf_construct_static()\n");
+
+	/* fail: null or non-table root */
+	assert(0 == lkonf_construct_static(0));
+
+	/*
+	 * As generated by lkonf-bake from:
+	 *	name = 'web'
+	 *	server = { port = 8080, ratio = 0.5, debug = true,
+	 *	  backends = { { host = 'a' }, { host = 'b' } } }
+	 */
+	static const lkonf_static_node backend1[] = {
+		{ "host", 0, { LK_TYPE_STRING, false, 0, 0, "a", 1 }, 0, 0 },
+	};
+	static const lkonf_static_node backend2[] = {
+		{ "host", 0, { LK_TYPE_STRING, false, 0, 0, "b", 1 }, 0, 0 },
+	};
+	static const lkonf_static_node backends[] = {
+		{ 0, 1, { LK_TYPE_TABLE, false, 0, 0, 0, 0 }, backend1, 1 },
+		{ 0, 2, { LK_TYPE_TABLE, false, 0, 0, 0, 0 }, backend2, 1 },
+	};
+	static const lkonf_static_node server[] = {
+		{ "backends", 0, { LK_TYPE_TABLE, false, 0, 0, 0, 0 },
+		  backends, 2 },
+		{ "debug", 0, { LK_TYPE_BOOLEAN, true, 0, 0, 0, 0 }, 0, 0 },
+		{ "port", 0, { LK_TYPE_NUMBER, false, 8080, 8080, 0, 0 }, 0, 0 },
+		{ "ratio", 0, { LK_TYPE_NUMBER, false, 0.5, 0, 0, 0 }, 0, 0 },
+	};
+	static const lkonf_static_node globals[] = {
+		{ "name", 0, { LK_TYPE_STRING, false, 0, 0, "web", 3 }, 0, 0 },
+		{ "server", 0, { LK_TYPE_TABLE, false, 0, 0, 0, 0 },
+		  server, 4 },
+	};
+	static const lkonf_static_node root = {
+		0, 0, { LK_TYPE_TABLE, false, 0, 0, 0, 0 }, globals, 2
+	};
+
+	assert(0 == lkonf_construct_static(&globals[0]));
+
+	lkonf_context * lc = lkonf_construct_static(&root);
+	assert(lc && "lkonf_construct_static returned 0");
+	assert(0 == lkonf_get_lua_State(lc));
+
+	bool		b = false;
+	double		d = 0;
+	lua_Integer	i = 0;
+	char *		s = 0;
+	size_t		len = 0;
+	lkonf_error	res;
+
+	/* pass: paths */
+	res = lkonf_get_string(lc, "name", &s, &len);
+	ensure_result(lc, res, "get_string(\"name\")", LK_OK, "");
+	assert(streq("web", s) && 3 == len);
+	free(s);
+
+	res = lkonf_get_boolean(lc, "server.debug", &b);
+	ensure_result(lc, res, "get_boolean(\"server.debug\")", LK_OK, "");
+	assert(b);
+
+	res = lkonf_get_integer(lc, "server.port", &i);
+	ensure_result(lc, res, "get_integer(\"server.port\")", LK_OK, "");
+	assert(8080 == i);
+
+	res = lkonf_get_double(lc, "server.ratio", &d);
+	ensure_result(lc, res, "get_double(\"server.ratio\")", LK_OK, "");
+	assert(0.5 == d);
+
+	res = lkonf_get_string(lc, "server.backends[2].host", &s, 0);
+	ensure_result(lc, res, "get_string(\"server.backends[2].host\")",
+		LK_OK, "");
+	assert(streq("b", s));
+	free(s);
 
-	/* fail: load null lkonf_context */
-	{
-		assert(LK_INVALID_ARGUMENT == lkonf_load_string(0, 0));
-	}
+	res = lkonf_get_string(lc, "server.backends.1.host", &s, 0);
+	ensure_result(lc, res, "get_string(\"server.backends.1.host\")",
+		LK_OK, "");
+	assert(streq("a", s));
+	free(s);
+
+	/* pass: keys and ikeys */
+	const char * keys[] = { "server", "port", 0 };
+	res = lkonf_getkey_integer(lc, keys, &i);
+	ensure_result(lc, res, "getkey_integer(server port)", LK_OK, "");
+	assert(8080 == i);
+
+	const lkonf_ikey ikeys[] = {
+		LK_NAME("server"), LK_NAME("backends"),
+		LK_INDEX(1), LK_NAME("host"), LK_END };
+	res = lkonf_getikey_string(lc, ikeys, &s, 0);
+	ensure_result(lc, res, "getikey_string(server backends 1 host)",
+		LK_OK, "");
+	assert(streq("a", s));
+	free(s);
 
-/* TODO: fail: load lkonf_context with null state */
+	/* fail: missing, wrong type, not a table */
+	res = lkonf_get_integer(lc, "server.missing", &i);
+	ensure_result(lc, res, "get_integer(\"server.missing\")",
+		LK_NOT_FOUND, "");
+	res = lkonf_get_integer(lc, "name", &i);
+	ensure_result(lc, res, "get_integer(\"name\")",
+		LK_OUT_OF_RANGE, "Not an integer: name");
+	res = lkonf_get_integer(lc, "server.backends[3].host", &i);
+	ensure_result(lc, res, "get_integer(\"server.backends[3].host\")",
+		LK_OUT_OF_RANGE, "Not a table: server.backends[3]");
+	res = lkonf_get_integer(lc, "server[1", &i);
+	ensure_result(lc, res, "get_integer(\"server[1\")",
+		LK_OUT_OF_RANGE, "Invalid index in: server[1");
+	res = lkonf_get_integer(lc, "server", &i);
+	ensure_result(lc, res, "get_integer(\"server\")",
+		LK_OUT_OF_RANGE, "Not an integer: server");
+
+	/* fail: no Lua state */
+	res = lkonf_load_string(lc, "x = 1");
+	ensure_result(lc, res, "load_string", LK_INVALID_ARGUMENT,
+		"Lua state NULL");
 
-	/* fail: load with string null pointer */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	lkonf_destruct(lc);
 
-		const lkonf_error res = lkonf_load_string(lc, 0);
-		ensure_result(lc, res,
-			"load_string(lc, 0)",
-			LK_INVALID_ARGUMENT, "iString NULL");
+	return EXIT_SUCCESS;
+}
 
-		lkonf_destruct(lc);
+/**
+ * lua_Writer appending to a dump_buffer.
+ */
+typedef struct
+{
+	unsigned char	data[4096];
+	size_t		len;
+} dump_buffer;
+
+static int
+dump_writer(lua_State * iState, const void * iData, size_t iSize, void * iUd)
+{
+	(void)iState;
+
+	dump_buffer * buf = iUd;
+	if (iSize > sizeof(buf->data) - buf->len) {
+		return 1;
 	}
+	memcpy(buf->data + buf->len, iData, iSize);
+	buf->len += iSize;
+	return 0;
+}
 
-	/* fail: LK_LUA_ERROR syntax error in string */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+int
+test_load_embedded(void)
+{
+	printf("lkonf_load_embedded()\n");
 
-		const lkonf_error res = lkonf_load_string(lc, "junk");
-		ensure_result(lc, res,
-			"load_string(lc, \"junk\")",
-			LK_LUA_ERROR,
-#if LUA_VERSION_NUM >= 502
-			"[string \"junk\"]:1: syntax error near <eof>"
-#else
-			"[string \"junk\"]:1: '=' expected near '<eof>'"
-#endif
-			);
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_load_embedded(0, 0, 0, 0));
 
-		lkonf_destruct(lc);
-	}
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-	/* fail: LK_LUA_ERROR run-time error in string */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	lkonf_error	res;
+	lua_Integer	i = 0;
 
-		const lkonf_error res = lkonf_load_string(lc, "junk()");
-		ensure_result(lc, res,
-			"load_string(lc, \"junk()\")",
-			LK_LUA_ERROR,
-			"[string \"junk()\"]:1: attempt to call global 'junk' (a nil value)");
+	/* compile a chunk as lkonf-embed does */
+	lua_State * L = lkonf_get_lua_State(lc);
+	assert(0 == luaL_loadstring(L, "x = 42 t = { y = x + 1 }"));
+	dump_buffer buf;
+	buf.len = 0;
+#if LUA_VERSION_NUM >= 503
+	assert(0 == lua_dump(L, dump_writer, &buf, 1));
+#else
+	assert(0 == lua_dump(L, dump_writer, &buf));
+#endif
+	lua_pop(L, 1);
 
-		lkonf_destruct(lc);
-	}
+	/* fail: null chunk */
+	res = lkonf_load_embedded(lc, 0, 0, "=test");
+	ensure_result(lc, res, "load_embedded(0)",
+		LK_INVALID_ARGUMENT, "iChunk NULL");
 
-	/* pass: "t=1" */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	/* fail: source isn't loaded */
+	const char src[] = "x = 1";
+	res = lkonf_load_embedded(lc, src, sizeof(src) - 1, "=test");
+	ensure_result(lc, res, "load_embedded(src)",
+		LK_INVALID_ARGUMENT, "Not a binary chunk: =test");
 
-		const lkonf_error res = lkonf_load_string(lc, "t=1");
-		ensure_result(lc, res, "load_string(lc, \"t=1\")", LK_OK, "");
+	/* fail: truncated chunk */
+	res = lkonf_load_embedded(lc, buf.data, buf.len / 2, "=test");
+	assert(LK_LUA_ERROR == res);
 
-		lkonf_destruct(lc);
-	}
+	/* pass: chunk executed */
+	res = lkonf_load_embedded(lc, buf.data, buf.len, 0);
+	ensure_result(lc, res, "load_embedded(buf)", LK_OK, "");
 
-/* TODO: sandbox tests */
+	res = lkonf_get_integer(lc, "t.y", &i);
+	ensure_result(lc, res, "get_integer(\"t.y\")", LK_OK, "");
+	assert(43 == i);
+
+	lkonf_destruct(lc);
 
 	return EXIT_SUCCESS;
 }
 
 int
-test_instruction_limit(void)
+test_string_ref(void)
 {
-	printf("lkonf_set_instruction_limit()\n");
-
-	/* fail: load null lkonf_context */
-	{
-		assert(-1 == lkonf_get_instruction_limit(0));
-		assert(LK_INVALID_ARGUMENT == lkonf_set_instruction_limit(0, 0));
-	}
+	printf("lkonf_get_string_ref()\n");
 
-	/* fail: set_instruction_limit < 0 */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_get_string_ref(0, "s", 0, 0));
+	assert(LK_INVALID_ARGUMENT == lkonf_getikey_string_ref(0, 0, 0, 0));
 
-		const lkonf_error res = lkonf_set_instruction_limit(lc, -2);
-		ensure_result(lc, res,
-			"set_instruction_limit(lc, -2)",
-			LK_INVALID_ARGUMENT, "iLimit < 0");
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-		lkonf_destruct(lc);
+	const lkonf_error rls = lkonf_load_string(lc,
+		"t = { s = 'abc', n = 1, f = function (p) return p .. '!' end }"
+		" c = 0 t.g = function (p) c = c + 1 return p .. c end"
+		" u = {} for i = 1, 1000 do u[i] = 'v' .. i end");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
+	lua_State * ls = lkonf_get_lua_State(lc);
+
+	const char *	s = 0;
+	const char *	f = 0;
+	size_t		len = 0;
+	lkonf_error	res;
+
+	/* pass: not copied */
+	res = lkonf_get_string_ref(lc, "t.s", &s, &len);
+	ensure_result(lc, res, "get_string_ref(\"t.s\")", LK_OK, "");
+	assert(streq("abc", s) && 3 == len);
+
+	const lkonf_ikey keys[] = { LK_NAME("t"), LK_NAME("s"), LK_END };
+	const char * s2 = 0;
+	res = lkonf_getikey_string_ref(lc, keys, &s2, 0);
+	ensure_result(lc, res, "getikey_string_ref(t s)", LK_OK, "");
+	assert(s == s2);
+
+	/* pass: function result anchored until the next load */
+	res = lkonf_get_string_ref(lc, "t.f", &f, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.f\")", LK_OK, "");
+	lua_gc(lkonf_get_lua_State(lc), LUA_GCCOLLECT, 0);
+	assert(streq("t.f!", f));
+
+	/* pass: polling a function keeps one anchor per path */
+	res = lkonf_get_string_ref(lc, "t.g", &f, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.g\")", LK_OK, "");
+	assert(streq("t.g1", f));
+	lua_gc(ls, LUA_GCCOLLECT, 0);
+	const int kb = lua_gc(ls, LUA_GCCOUNT, 0);
+	int i;
+	for (i = 0; i < 10000; ++i) {
+		res = lkonf_get_string_ref(lc, "t.g", &f, 0);
+		assert(LK_OK == res);
 	}
+	lua_gc(ls, LUA_GCCOLLECT, 0);
+	assert(streq("t.g10001", f));
+	assert(lua_gc(ls, LUA_GCCOUNT, 0) - kb < 64);
+
+	/* pass: and one anchor per keys */
+	const lkonf_ikey gkeys[] = { LK_NAME("t"), LK_NAME("g"), LK_END };
+	for (i = 0; i < 10000; ++i) {
+		res = lkonf_getikey_string_ref(lc, gkeys, &s2, 0);
+		assert(LK_OK == res);
+	}
+	lua_gc(ls, LUA_GCCOLLECT, 0);
+	assert(streq("t.g20001", s2));
+	assert(streq("t.g10001", f));
+	assert(lua_gc(ls, LUA_GCCOUNT, 0) - kb < 64);
+
+	/* pass: cached string anchored past eviction from the cache */
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+	res = lkonf_get_string_ref(lc, "t.s", &s, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.s\")", LK_OK, "");
+	res = lkonf_get_string_ref(lc, "t.s", &s, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.s\") cached", LK_OK, "");
+	ls = lkonf_get_lua_State(lc);
+	lua_getglobal(ls, "t");
+	lua_pushnil(ls);
+	lua_setfield(ls, -2, "s");
+	lua_pop(ls, 1);
+	for (i = 1; i <= 1000; ++i) {
+		const lkonf_ikey ukeys[] = { LK_NAME("u"), LK_INDEX(i), LK_END };
+		res = lkonf_getikey_string_ref(lc, ukeys, &s2, 0);
+		assert(LK_OK == res);
+	}
+	lua_gc(ls, LUA_GCCOLLECT, 0);
+	assert(streq("abc", s));
 
-	/* pass: set & get */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
-
-		const int	limit = 10;
-
-		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
-		ensure_result(lc, sil,
-			"set_instruction_limit(lc, 10)", LK_OK, "");
+	/* fail: not a string */
+	res = lkonf_get_string_ref(lc, "t.n", &s, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.n\")",
+		LK_OUT_OF_RANGE, "Not a string: t.n");
+	res = lkonf_get_string_ref(lc, "t.s", 0, 0);
+	ensure_result(lc, res, "get_string_ref(\"t.s\", 0)",
+		LK_INVALID_ARGUMENT, "oValue NULL");
 
-		const int gil = lkonf_get_instruction_limit(lc);
-		assert(limit == gil);
+	lkonf_destruct(lc);
 
-		lkonf_destruct(lc);
-	}
+	return EXIT_SUCCESS;
+}
 
-	/* pass: long loop, no limit */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+int
+test_integer_exact(void)
+{
+	printf("integer conversion without truncation\n");
 
-		const int	limit = 0;
-		const char *	expr = "for i=1, 1000 do end";
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
-		assert(LK_OK == sil);
+	const lkonf_error rls = lkonf_load_string(lc,
+		"t = { i = 3, f = 3.0, d = 2.5, n = -7.5, big = 1e30,"
+		" nan = 0/0, fd = function () return 0.5 end }\n"
+		"a = { 1, 2.0, 3.25 }\n");
+	ensure_result(lc, rls, "load_string", LK_OK, "");
 
-		const lkonf_error res = lkonf_load_string(lc, expr);
-		ensure_result(lc, res, expr,
-			LK_OK, "");
+	lua_Integer	v = 0;
+	lkonf_error	res;
+
+	/* pass: integer, and float with an integral value */
+	res = lkonf_get_integer(lc, "t.i", &v);
+	ensure_result(lc, res, "get_integer(\"t.i\")", LK_OK, "");
+	assert(3 == v);
+	res = lkonf_get_integer(lc, "t.f", &v);
+	ensure_result(lc, res, "get_integer(\"t.f\")", LK_OK, "");
+	assert(3 == v);
+
+	/* fail: not truncated */
+	v = 42;
+	res = lkonf_get_integer(lc, "t.d", &v);
+	ensure_result(lc, res, "get_integer(\"t.d\")",
+		LK_OUT_OF_RANGE, "Not an integer: t.d");
+	assert(42 == v);
+	res = lkonf_getkey_integer(lc, (lkonf_keys){"t", "n", 0}, &v);
+	ensure_result(lc, res, "getkey_integer(t n)",
+		LK_OUT_OF_RANGE, "Not an integer: \"t\".\"n\"");
+	res = lkonf_getikey_integer(lc,
+		(lkonf_ikeys){ LK_NAME("t"), LK_NAME("fd"), LK_END }, &v);
+	ensure_result(lc, res, "getikey_integer(t fd)",
+		LK_OUT_OF_RANGE, "Not an integer: t.fd");
+
+	/* fail: out of range or not a number */
+	res = lkonf_get_integer(lc, "t.big", &v);
+	ensure_result(lc, res, "get_integer(\"t.big\")",
+		LK_OUT_OF_RANGE, "Not an integer: t.big");
+	res = lkonf_get_integer(lc, "t.nan", &v);
+	ensure_result(lc, res, "get_integer(\"t.nan\")",
+		LK_OUT_OF_RANGE, "Not an integer: t.nan");
+
+	/* pass: as a double */
+	double d = 0;
+	res = lkonf_get_double(lc, "t.d", &d);
+	ensure_result(lc, res, "get_double(\"t.d\")", LK_OK, "");
+	assert(2.5 == d);
+
+	/* fail: not truncated from the value cache */
+	res = lkonf_set_value_cache(lc, true);
+	ensure_result(lc, res, "set_value_cache(true)", LK_OK, "");
+	res = lkonf_get_double(lc, "t.d", &d);
+	ensure_result(lc, res, "get_double(\"t.d\")", LK_OK, "");
+	res = lkonf_get_integer(lc, "t.d", &v);
+	ensure_result(lc, res, "get_integer(\"t.d\") cached",
+		LK_OUT_OF_RANGE, "Not an integer: t.d");
+	res = lkonf_set_value_cache(lc, false);
+	ensure_result(lc, res, "set_value_cache(false)", LK_OK, "");
+
+	/* fail: array element with a fractional part */
+	lua_Integer vi[3];
+	size_t len = 3;
+	res = lkonf_get_integer_array(lc, "a", vi, &len);
+	ensure_result(lc, res, "get_integer_array(\"a\")",
+		LK_OUT_OF_RANGE, "Not an integer: a[3]");
+	assert(3 == len && 1 == vi[0] && 2 == vi[1]);
 
-		const int gil = lkonf_get_instruction_limit(lc);
-		assert(limit == gil);
+	lkonf_destruct(lc);
 
-		lkonf_destruct(lc);
-	}
+	return EXIT_SUCCESS;
+}
 
-	/* pass: long loop, limited and terminated */
-	{
-		lkonf_context * lc = lkonf_construct();
-		assert(lc && "lkonf_construct returned 0");
+int
+test_function_ref(void)
+{
+	printf("lkonf_call(), lkonf_call_batch()\n");
 
-		const int	limit = 100;
-		const char *	expr = "for i=1, 1000 do end";
+	/* fail: null context */
+	assert(LK_INVALID_ARGUMENT == lkonf_get_function_ref(0, "f", 0));
+	assert(LK_INVALID_ARGUMENT == lkonf_call(0, 0, 0, 0, 0, 0));
+	assert(LK_INVALID_ARGUMENT == lkonf_call_batch(0, 0, 0, 0, 0, 0));
+	lkonf_free_function_ref(0);
 
-		const lkonf_error sil = lkonf_set_instruction_limit(lc, limit);
-		assert(LK_OK == sil);
+	lkonf_context * lc = lkonf_construct();
+	assert(lc && "lkonf_construct returned 0");
 
-		const lkonf_error res = lkonf_load_string(lc, expr);
-		ensure_result(lc, res, expr,
-			LK_LUA_ERROR, "Instruction count exceeded");
+	lkonf_error res = lkonf_load_string(lc,
+		"policy = { allow = function (user, n)\n"
+		"  if user == 'root' then return false, 'denied' end\n"
+		"  return n < 10, 'ok:' .. user, n * 2\n"
+		"end }\n"
+		"notfn = 1\n");
+	ensure_result(lc, res, "load_string", LK_OK, "");
+
+	lkonf_function_ref * fr = 0;
+
+	/* fail: not a function, or missing */
+	res = lkonf_get_function_ref(lc, "notfn", &fr);
+	ensure_result(lc, res, "get_function_ref(\"notfn\")",
+		LK_OUT_OF_RANGE, "Not a function: notfn");
+	assert(! fr);
+	res = lkonf_get_function_ref(lc, "policy.deny", &fr);
+	ensure_result(lc, res, "get_function_ref(\"policy.deny\")",
+		LK_NOT_FOUND, "");
+	res = lkonf_get_function_ref(lc, "policy.allow", 0);
+	ensure_result(lc, res, "get_function_ref(\"policy.allow\", 0)",
+		LK_INVALID_ARGUMENT, "oRef NULL");
 
-		const int gil = lkonf_get_instruction_limit(lc);
-		assert(limit == gil);
+	/* pass: resolve once */
+	res = lkonf_get_function_ref(lc, "policy.allow", &fr);
+	ensure_result(lc, res, "get_function_ref(\"policy.allow\")",
+		LK_OK, "");
+	assert(fr);
+
+	/* pass: typed arguments and multiple results */
+	lkonf_value args[2] = {
+		{ .type = LK_TYPE_STRING, .string = "bob", .length = 3 },
+		{ .type = LK_TYPE_NUMBER, .number = 3, .integer = 3 },
+	};
+	lkonf_value results[4];
+	res = lkonf_call(lc, fr, args, 2, results, 4);
+	ensure_result(lc, res, "call(bob, 3)", LK_OK, "");
+	assert(LK_TYPE_BOOLEAN == results[0].type && results[0].boolean);
+	assert(LK_TYPE_STRING == results[1].type);
+	assert(streq("ok:bob", results[1].string) && 6 == results[1].length);
+	assert(LK_TYPE_NUMBER == results[2].type && 6 == results[2].integer);
+	assert(LK_TYPE_NIL == results[3].type);
+
+	args[0].string = "root";
+	args[0].length = 4;
+	res = lkonf_call(lc, fr, args, 2, results, 2);
+	ensure_result(lc, res, "call(root, 3)", LK_OK, "");
+	assert(LK_TYPE_BOOLEAN == results[0].type && ! results[0].boolean);
+	assert(streq("denied", results[1].string));
+
+	/* fail: Lua error, nil compared with a number */
+	args[0].string = "eve";
+	args[0].length = 3;
+	res = lkonf_call(lc, fr, args, 1, results, 1);
+	assert(LK_LUA_ERROR == res);
+
+	/* fail: invalid arguments */
+	const lkonf_value table = { .type = LK_TYPE_TABLE };
+	res = lkonf_call(lc, fr, &table, 1, results, 1);
+	ensure_result(lc, res, "call(table)",
+		LK_INVALID_ARGUMENT, "Invalid argument: policy.allow[1]");
+	res = lkonf_call(lc, fr, 0, 1, results, 1);
+	ensure_result(lc, res, "call(0, 1)",
+		LK_INVALID_ARGUMENT, "iArgs NULL");
+	res = lkonf_call(lc, fr, args, 2, 0, 1);
+	ensure_result(lc, res, "call(args, 2, 0, 1)",
+		LK_INVALID_ARGUMENT, "oResults NULL");
+	res = lkonf_call(lc, 0, args, 2, results, 1);
+	ensure_result(lc, res, "call(0)",
+		LK_INVALID_ARGUMENT, "iRef NULL");
+
+	/* pass: the reference outlives a load replacing the key */
+	res = lkonf_load_string(lc, "policy = nil");
+	ensure_result(lc, res, "load_string(\"policy = nil\")", LK_OK, "");
+	args[0].string = "bob";
+	res = lkonf_call(lc, fr, args, 2, results, 1);
+	ensure_result(lc, res, "call(bob, 3) after load", LK_OK, "");
+	assert(LK_TYPE_BOOLEAN == results[0].type && results[0].boolean);
+
+	/* fail: reference from another context */
+	lkonf_context * lc2 = lkonf_construct();
+	assert(lc2 && "lkonf_construct returned 0");
+	res = lkonf_call(lc2, fr, args, 2, results, 1);
+	ensure_result(lc2, res, "call(lc2)",
+		LK_INVALID_ARGUMENT, "iRef not from iLc");
+	lkonf_destruct(lc2);
+
+	lkonf_free_function_ref(fr);
+
+	res = lkonf_load_string(lc,
+		"square = function (n)\n"
+		"  if n == 3 then local x = nil + n end\n"
+		"  return n * n\n"
+		"end\n"
+		"name = function (n) return 'n' .. n end\n"
+		"slow = function (n)\n"
+		"  local x = 0 for i = 1, 100 do x = x + i end return x\n"
+		"end\n");
+	ensure_result(lc, res, "load_string", LK_OK, "");
+
+	lkonf_value	in[4];
+	lkonf_value	out[4];
+	lkonf_error	err[4];
+	size_t		i;
+	for (i = 0; i < 4; ++i) {
+		memset(&in[i], 0, sizeof(in[i]));
+		in[i].type = LK_TYPE_NUMBER;
+		in[i].number = (double)(i + 1);
+		in[i].integer = (lua_Integer)(i + 1);
+	}
 
-		lkonf_destruct(lc);
+	/* pass: batch, with one failed element */
+	res = lkonf_get_function_ref(lc, "square", &fr);
+	ensure_result(lc, res, "get_function_ref(\"square\")", LK_OK, "");
+	res = lkonf_call_batch(lc, fr, in, 4, out, err);
+	assert(LK_LUA_ERROR == res);
+	assert(strstr(lkonf_get_error_string(lc),
+		"attempt to perform arithmetic on a nil value"));
+	assert(LK_OK == err[0] && 1 == out[0].integer);
+	assert(LK_OK == err[1] && 4 == out[1].integer);
+	assert(LK_LUA_ERROR == err[2] && LK_TYPE_NIL == out[2].type);
+	assert(LK_OK == err[3] && 16 == out[3].integer);
+
+	/* fail: invalid element is the first failure */
+	in[1].type = LK_TYPE_TABLE;
+	res = lkonf_call_batch(lc, fr, in, 4, out, 0);
+	ensure_result(lc, res, "call_batch(square)",
+		LK_INVALID_ARGUMENT, "Invalid argument: square[2]");
+	assert(LK_TYPE_NIL == out[1].type && 16 == out[3].integer);
+	in[1].type = LK_TYPE_NUMBER;
+
+	/* fail: batch arguments */
+	res = lkonf_call_batch(lc, fr, 0, 4, out, err);
+	ensure_result(lc, res, "call_batch(0, 4)",
+		LK_INVALID_ARGUMENT, "iInputs NULL");
+	res = lkonf_call_batch(lc, fr, in, 4, 0, err);
+	ensure_result(lc, res, "call_batch(in, 4, 0)",
+		LK_INVALID_ARGUMENT, "oOutputs NULL");
+	lkonf_free_function_ref(fr);
+
+	/* pass: string outputs */
+	res = lkonf_get_function_ref(lc, "name", &fr);
+	ensure_result(lc, res, "get_function_ref(\"name\")", LK_OK, "");
+	res = lkonf_call_batch(lc, fr, in, 4, out, err);
+	ensure_result(lc, res, "call_batch(name)", LK_OK, "");
+	lua_gc(lkonf_get_lua_State(lc), LUA_GCCOLLECT, 0);
+	assert(streq("n1", out[0].string) && streq("n4", out[3].string));
+	lkonf_free_function_ref(fr);
+
+	/* fail: one instruction limit covers the batch */
+	res = lkonf_get_function_ref(lc, "slow", &fr);
+	ensure_result(lc, res, "get_function_ref(\"slow\")", LK_OK, "");
+	assert(LK_OK == lkonf_set_instruction_limit(lc, 1000));
+	res = lkonf_call(lc, fr, in, 1, out, 1);
+	ensure_result(lc, res, "call(slow)", LK_OK, "");
+	assert(5050 == out[0].integer);
+
+	lkonf_value many[100];
+	lkonf_value many_out[100];
+	for (i = 0; i < 100; ++i) {
+		many[i] = in[0];
 	}
+	res = lkonf_call_batch(lc, fr, many, 100, many_out, 0);
+	ensure_result(lc, res, "call_batch(slow)",
+		LK_LUA_ERROR, "Instruction count exceeded");
+	lkonf_free_function_ref(fr);
+
+	lkonf_destruct(lc);
 
 	return EXIT_SUCCESS;
 }
@@ -573,10 +2876,19 @@ test_get_boolean(void)
 		".t8", NULL,
 		LK_OUT_OF_RANGE, "Empty component in: .t8");
 
-	/* fail: t9n.1 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* pass: t9n.1 */
 	exercise_get_boolean(true,
 		"t9n.1", NULL,
+		LK_OK, "");
+
+	/* pass: t9n[1] */
+	exercise_get_boolean(true,
+		"t9n[1]", NULL,
+		LK_OK, "");
+
+	/* fail: t9s[1] */
+	exercise_get_boolean(true,
+		"t9s[1]", NULL,
 		LK_NOT_FOUND, "");
 
 	/* pass: t9s.1 */
@@ -798,8 +3110,7 @@ test_getkey_boolean(void)
 		"\"\" t8", (lkonf_keys){"", "t8", 0},
 		LK_OUT_OF_RANGE, "Empty top-level key");
 
-	/* fail: t9n 1 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* fail: t9n 1; string key "1" isn't integer key 1 */
 	exercise_get_boolean(true,
 		"t9n 1", (lkonf_keys){"t9n", "1", 0},
 		LK_NOT_FOUND, "");
@@ -1050,10 +3361,19 @@ test_get_double(void)
 		".t8", NULL,
 		LK_OUT_OF_RANGE, "Empty component in: .t8");
 
-	/* fail: t9n.2 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* pass: t9n.2 */
 	exercise_get_double(6.1,
 		"t9n.2", NULL,
+		LK_OK, "");
+
+	/* pass: t9n[2] */
+	exercise_get_double(6.1,
+		"t9n[2]", NULL,
+		LK_OK, "");
+
+	/* fail: t9s[2] */
+	exercise_get_double(6.1,
+		"t9s[2]", NULL,
 		LK_NOT_FOUND, "");
 
 	/* pass: t9s.2 */
@@ -1267,8 +3587,7 @@ test_getkey_double(void)
 		"\"\" t8", (lkonf_keys){"", "t8", 0},
 		LK_OUT_OF_RANGE, "Empty top-level key");
 
-	/* fail: t9n 2 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* fail: t9n 2; string key "2" isn't integer key 2 */
 	exercise_get_double(6.1,
 		"t9n 2", (lkonf_keys){"t9n", "2", 0},
 		LK_NOT_FOUND, "");
@@ -1519,10 +3838,19 @@ test_get_integer(void)
 		".t8", NULL,
 		LK_OUT_OF_RANGE, "Empty component in: .t8");
 
-	/* fail: t9n.3 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* pass: t9n.3 */
 	exercise_get_integer(6,
 		"t9n.3", NULL,
+		LK_OK, "");
+
+	/* pass: t9n[3] */
+	exercise_get_integer(6,
+		"t9n[3]", NULL,
+		LK_OK, "");
+
+	/* fail: t9s[3] */
+	exercise_get_integer(6,
+		"t9s[3]", NULL,
 		LK_NOT_FOUND, "");
 
 	/* pass: t9s.3 */
@@ -1722,8 +4050,7 @@ test_getkey_integer(void)
 		"\"\" t8", (lkonf_keys){"", "t8", 0},
 		LK_OUT_OF_RANGE, "Empty top-level key");
 
-	/* fail: t9n 3 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* fail: t9n 3; string key "3" isn't integer key 3 */
 	exercise_get_integer(6,
 		"t9n 3", (lkonf_keys){"t9n", "3", 0},
 		LK_NOT_FOUND, "");
@@ -1982,10 +4309,19 @@ test_get_string(void)
 		".t8", NULL,
 		LK_OUT_OF_RANGE, "Empty component in: .t8");
 
-	/* fail: t9n.4 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* pass: t9n.4 */
 	exercise_get_string("six", 3,
 		"t9n.4", NULL,
+		LK_OK, "");
+
+	/* pass: t9n[4] */
+	exercise_get_string("six", 3,
+		"t9n[4]", NULL,
+		LK_OK, "");
+
+	/* fail: t9s[4] */
+	exercise_get_string("six", 3,
+		"t9s[4]", NULL,
 		LK_NOT_FOUND, "");
 
 	/* pass: t9s.4 */
@@ -2185,8 +4521,7 @@ test_getkey_string(void)
 		"\"\" t8", (lkonf_keys){"", "t8", 0},
 		LK_OUT_OF_RANGE, "Empty top-level key");
 
-	/* fail: t9n 4 */
-/* TODO: fix path lookup to support integer lookup? */
+	/* fail: t9n 4; string key "4" isn't integer key 4 */
 	exercise_get_string("six", 3,
 		"t9n.4", (lkonf_keys){"t9n", "4", 0},
 		LK_NOT_FOUND, "");
@@ -2247,7 +4582,22 @@ const struct
 	{ "destruct",		TF_destruct,		test_destruct },
 	{ "load_file",		TF_load_file,		test_load_file },
 	{ "load_string",	TF_load_string,		test_load_string },
+	{ "load_embedded",	TF_load_embedded,	test_load_embedded },
 	{ "instruction_limit",	TF_instruction_limit,	test_instruction_limit },
+	{ "instruction_budget",	TF_instruction_budget,	test_instruction_budget },
+	{ "time_limit",		TF_time_limit,		test_time_limit },
+	{ "interrupt",		TF_interrupt,		test_interrupt },
+	{ "lookup_cache",	TF_lookup_cache,	test_lookup_cache },
+	{ "value_cache",	TF_value_cache,		test_value_cache },
+	{ "seal",		TF_seal,		test_seal },
+	{ "integer_keys",	TF_integer_keys,	test_integer_keys },
+	{ "iter",		TF_iter,		test_iter },
+	{ "array",		TF_array,		test_array },
+	{ "typed_array",	TF_typed_array,		test_typed_array },
+	{ "columns",		TF_columns,		test_columns },
+	{ "bind",		TF_bind,		test_bind },
+	{ "validate",		TF_validate,		test_validate },
+	{ "static",		TF_static,		test_static },
 	{ "get_boolean",	TF_get_boolean,		test_get_boolean },
 	{ "getkey_boolean",	TF_getkey_boolean,	test_getkey_boolean },
 	{ "get_double",		TF_get_double,		test_get_double },
@@ -2256,6 +4606,9 @@ const struct
 	{ "getkey_integer",	TF_getkey_integer,	test_getkey_integer },
 	{ "get_string",		TF_get_string,		test_get_string },
 	{ "getkey_string",	TF_getkey_string,	test_getkey_string },
+	{ "string_ref",		TF_string_ref,		test_string_ref },
+	{ "integer_exact",	TF_integer_exact,	test_integer_exact },
+	{ "function_ref",	TF_function_ref,	test_function_ref },
 	{ 0,			0,			0 },
 };
 
@@ -0,0 +1,130 @@
+#include <lkonf.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char * test_luastr = "\
+server = { name = 'web', port = 8080, ratio = 0.5, debug = true, \
+  backends = { { host = 'a' }, { host = 'b' } }, \
+  big = 5000000000, neg = -1, \
+  tag = function (path) return 'tag:' .. path end } \
+";
+
+	/* Split at compile time. */
+constexpr lkonf::path name_path("server.name");
+constexpr lkonf::path port_path("server.port");
+constexpr lkonf::path host_path("server.backends[2].host");
+constexpr lkonf::path missing_path("server.missing");
+constexpr lkonf::path tag_path("server.tag");
+
+static_assert(name_path.valid(), "name_path");
+static_assert(host_path.valid(), "host_path");
+static_assert(! lkonf::path("").valid(), "empty");
+static_assert(! lkonf::path("a.").valid(), "trailing dot");
+static_assert(! lkonf::path("a..b").valid(), "empty component");
+static_assert(! lkonf::path("[1]").valid(), "leading index");
+static_assert(! lkonf::path("a[1]b").valid(), "name after index");
+static_assert(! lkonf::path("a[x]").valid(), "invalid index");
+static_assert(! lkonf::path("a[2147483648]").valid(), "index overflow");
+static_assert(lkonf::path("a[-2147483648]").valid(), "index minimum");
+
+	/* lkonf_ikeys are constant expressions. */
+constexpr lkonf::path<24>::ikeys_type host_keys = host_path.ikeys();
+static_assert(LK_KEY_NAME == host_keys[0].type, "host_keys[0]");
+static_assert(LK_KEY_INDEX == host_keys[2].type
+    && 2 == host_keys[2].index, "host_keys[2]");
+static_assert(LK_KEY_END == host_keys[4].type, "host_keys[4]");
+
+int
+test_context()
+{
+	std::printf("lkonf::context\n");
+
+	lkonf::context lc;
+	assert(lc.handle());
+	assert(LK_OK == lc.load_string(test_luastr));
+
+	/* pass: moved */
+	lkonf::context moved(std::move(lc));
+	assert(! lc.handle());
+	assert(moved.handle());
+	lc = std::move(moved);
+	assert(lc.handle() && ! moved.handle());
+
+	/* fail: load error */
+	assert(LK_LUA_ERROR == lc.load_string("junk"));
+	assert(LK_LUA_ERROR == lc.error_code());
+	assert(lc.error_string() && *lc.error_string());
+
+	return EXIT_SUCCESS;
+}
+
+int
+test_get()
+{
+	std::printf("lkonf::context::get\n");
+
+	lkonf::context lc;
+	assert(LK_OK == lc.load_string(test_luastr));
+
+	/* pass: compile-time paths */
+	const std::optional<std::string_view> name =
+	    lc.get<std::string_view>(name_path);
+	assert(name && "web" == *name);
+	assert(8080 == lc.get<int>(port_path).value_or(0));
+	assert("b" == lc.get<std::string_view>(host_path).value_or(""));
+
+	/* pass: runtime paths */
+	assert(0.5 == lc.get<double>("server.ratio").value_or(0));
+	assert(lc.get<bool>("server.debug").value_or(false));
+	assert(8080 == lc.get<lua_Integer>("server.port").value_or(0));
+	assert("web" == lc.get<std::string>("server.name").value_or(""));
+
+	/* pass: function result stays valid */
+	const std::string_view tag =
+	    lc.get<std::string_view>(tag_path).value_or("");
+	assert("tag:server.tag" == tag);
+	assert(lc.get<std::string_view>("server.name"));
+	assert("tag:server.tag" == tag);
+
+	/* fail: missing, wrong type */
+	assert(! lc.get<int>(missing_path));
+	assert(LK_NOT_FOUND == lc.error_code());
+	assert(! lc.get<int>("server.name"));
+	assert(LK_OUT_OF_RANGE == lc.error_code());
+	assert(42 == lc.get_or<int>(missing_path, 42));
+	assert(42 == lc.get_or<int>("server.missing", 42));
+
+	/* fail: out of range of T */
+	assert(! lc.get<int32_t>("server.big"));
+	assert(LK_OUT_OF_RANGE == lc.error_code());
+	assert(! lc.get<unsigned>("server.neg"));
+	assert(LK_OUT_OF_RANGE == lc.error_code());
+	assert(-1 == lc.get<signed char>("server.neg").value_or(0));
+
+	return EXIT_SUCCESS;
+}
+
+} /* namespace */
+
+int
+main()
+{
+	int result = EXIT_SUCCESS;
+
+	const int res[] = {
+		test_context(),
+		test_get(),
+	};
+	for (int r : res) {
+		if (r > result) {
+			result = r;
+		}
+	}
+
+	return result;
+}
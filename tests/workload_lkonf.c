@@ -0,0 +1,256 @@
+#include <lkonf.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Representative workload for profile-guided optimisation ("make pgo"):
+ * load a large generated configuration, then perform a mix of lookups.
+ * The configuration is generated, so the workload is reproducible.
+ */
+
+/**
+ * Monotonic time in nanoseconds.
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Growable string.
+ */
+typedef struct
+{
+	char *	data;
+	size_t	len;
+	size_t	size;
+} buffer;
+
+/**
+ * Append a formatted string to ioBuf.
+ */
+static void
+append(buffer * ioBuf, const char * iFormat, ...)
+{
+	for (;;) {
+		va_list ap;
+		va_start(ap, iFormat);
+		const int n = vsnprintf(ioBuf->data + ioBuf->len,
+			ioBuf->size - ioBuf->len, iFormat, ap);
+		va_end(ap);
+		if (n >= 0 && (size_t)n < ioBuf->size - ioBuf->len) {
+			ioBuf->len += n;
+			return;
+		}
+		ioBuf->size = ioBuf->size * 2 + n + 1;
+		ioBuf->data = realloc(ioBuf->data, ioBuf->size);
+		if (! ioBuf->data) {
+			fprintf(stderr, "Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/**
+ * Generate a configuration with iServers servers.
+ */
+static char *
+generate(const int iServers)
+{
+	buffer buf = { 0, 0, 0 };
+	append(&buf, "defaults = { timeout = 30, retries = 3,"
+		" ratio = 0.75, verbose = false, region = 'eu-west' }\n");
+	append(&buf, "limits = {\n"
+		"  connections = function (path)"
+		" return defaults.retries * 100 end,\n"
+		"  label = function (path) return 'limit:' .. path end,\n"
+		"}\n");
+	append(&buf, "servers = {\n");
+	int i;
+	for (i = 0; i < iServers; ++i) {
+		append(&buf, "  { name = 'server%d', host = '10.%d.%d.%d',"
+			" port = %d, weight = %d.%d, enabled = %s,"
+			" tags = { 'web', 'zone%d' } },\n",
+			i, i / 65536 % 256, i / 256 % 256, i % 256,
+			8000 + i % 1000, i % 10, i % 7,
+			i % 3 ? "true" : "false", i % 4);
+	}
+	append(&buf, "}\n");
+	return buf.data;
+}
+
+/**
+ * Perform lookups on every server, and of the defaults and limits.
+ * @return Number of lookups, or -1 on error.
+ */
+static long
+lookups(lkonf_context * iLc, const int iServers)
+{
+	static const char * timeout[] = { "defaults", "timeout", 0 };
+	static const char * region[] = { "defaults", "region", 0 };
+	long n = 0;
+	int i;
+	for (i = 1; i <= iServers; ++i) {
+		char path[64];
+		lua_Integer port;
+		double weight;
+		bool enabled;
+		const char * name;
+		char * host;
+		lua_Integer t;
+
+		const lkonf_ikey keys[] = {
+			LK_NAME("servers"), LK_INDEX(i), LK_NAME("port"), LK_END };
+		if (LK_OK != lkonf_getikey_integer(iLc, keys, &port)) {
+			return -1;
+		}
+
+		snprintf(path, sizeof(path), "servers[%d].weight", i);
+		if (LK_OK != lkonf_get_double(iLc, path, &weight)) {
+			return -1;
+		}
+
+		snprintf(path, sizeof(path), "servers[%d].enabled", i);
+		if (LK_OK != lkonf_get_boolean(iLc, path, &enabled)) {
+			return -1;
+		}
+
+		snprintf(path, sizeof(path), "servers[%d].name", i);
+		if (LK_OK != lkonf_get_string_ref(iLc, path, &name, 0)) {
+			return -1;
+		}
+
+		snprintf(path, sizeof(path), "servers[%d].host", i);
+		if (LK_OK != lkonf_get_string(iLc, path, &host, 0)) {
+			return -1;
+		}
+		free(host);
+
+		snprintf(path, sizeof(path), "servers[%d].missing", i);
+		if (LK_NOT_FOUND != lkonf_get_integer(iLc, path, &t)) {
+			return -1;
+		}
+
+		if (LK_OK != lkonf_getkey_integer(iLc, timeout, &t)) {
+			return -1;
+		}
+
+		n += 7;
+
+		if (0 == i % 16) {
+			char * s;
+			if (LK_OK != lkonf_getkey_string(iLc, region, &s, 0)) {
+				return -1;
+			}
+			free(s);
+			if (LK_OK != lkonf_get_integer(iLc,
+			    "limits.connections", &t)) {
+				return -1;
+			}
+			if (LK_OK != lkonf_get_string_ref(iLc,
+			    "limits.label", &name, 0)) {
+				return -1;
+			}
+			n += 3;
+		}
+	}
+	return n;
+}
+
+/**
+ * Print a usage.
+ */
+int
+usage(const char * progname)
+{
+	fprintf(stderr, "Usage: %s [-r <rounds>] [-s <servers>]\n", progname);
+	fprintf(stderr, "    -r <rounds>   Loads of the configuration. [20]\n");
+	fprintf(stderr, "    -s <servers>  Servers in the configuration. [5000]\n");
+	return EXIT_FAILURE;
+}
+
+/**
+ * Main entry.
+ */
+int
+main(int argc, char * argv[])
+{
+		/* determine progname */
+	char * progname = strrchr(argv[0], '/');
+	if (progname) {
+		++progname;
+	} else {
+		progname = argv[0];
+	}
+
+	int rounds = 20;
+	int servers = 5000;
+	int ch;
+	while (-1 != (ch = getopt(argc, argv, "r:s:"))) {
+		switch (ch) {
+			case 'r':
+				rounds = atoi(optarg);
+				break;
+			case 's':
+				servers = atoi(optarg);
+				break;
+			default:
+				return usage(progname);
+		}
+	}
+	if (rounds <= 0 || servers <= 0) {
+		return usage(progname);
+	}
+
+	char * config = generate(servers);
+
+	double load = 0;
+	double lookup = 0;
+	long n = 0;
+	int r;
+	for (r = 0; r < rounds; ++r) {
+		lkonf_context * lc = lkonf_construct();
+		if (! lc) {
+			fprintf(stderr, "%s: Can't construct lkonf_context\n",
+				progname);
+			return EXIT_FAILURE;
+		}
+
+		const double start = now();
+		if (LK_OK != lkonf_load_string(lc, config)) {
+			fprintf(stderr, "%s: %s\n", progname,
+				lkonf_get_error_string(lc));
+			return EXIT_FAILURE;
+		}
+		const double loaded = now();
+		const long res = lookups(lc, servers);
+		lookup += now() - loaded;
+		load += loaded - start;
+
+		if (res < 0) {
+			fprintf(stderr, "%s: %s\n", progname,
+				lkonf_get_error_string(lc));
+			return EXIT_FAILURE;
+		}
+		n += res;
+
+		lkonf_destruct(lc);
+	}
+
+	free(config);
+
+	printf("load_ms %.1f\n", load / 1e6);
+	printf("lookup_ms %.1f\n", lookup / 1e6);
+	printf("lookups %ld\n", n);
+	printf("total_ms %.1f\n", (load + lookup) / 1e6);
+
+	return EXIT_SUCCESS;
+}
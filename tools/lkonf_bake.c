@@ -0,0 +1,480 @@
+#include <lkonf.h>
+
+#include <lua.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Node of the evaluated configuration.
+ */
+typedef struct node_s node;
+
+struct node_s
+{
+	char *		name;		/** String key, or 0 if index. */
+	int		index;		/** Integer key. */
+	lkonf_value	value;		/** Value; string is owned. */
+	node *		children;	/** Children if LK_TYPE_TABLE. */
+	size_t		count;		/** Number of children. */
+};
+
+/**
+ * Bake state.
+ */
+typedef struct
+{
+	const char *	progname;	/** Program name, for messages. */
+	lua_State *	state;		/** Lua state of the context. */
+	int		visited;	/** Index of tables being visited. */
+	size_t		next_id;	/** Next id of emitted arrays. */
+} bake;
+
+/**
+ * Exit if out of memory.
+ */
+static void *
+check_alloc(void * iPtr)
+{
+	if (! iPtr) {
+		fprintf(stderr, "Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	return iPtr;
+}
+
+/**
+ * Return a copy of iStr[0..iLen).
+ */
+static char *
+copy(const char * iStr, const size_t iLen)
+{
+	char * str = check_alloc(malloc(iLen + 1));
+	memcpy(str, iStr, iLen);
+	str[iLen] = '\0';
+	return str;
+}
+
+/**
+ * Free the members of iNode.
+ */
+static void
+free_node(node * iNode)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		free_node(&iNode->children[i]);
+	}
+	free(iNode->children);
+	free(iNode->name);
+	free((char *)iNode->value.string);
+}
+
+/**
+ * Order children as per lkonf_static_node:
+ * integer keys by index, then names.
+ */
+static int
+compare_nodes(const void * iLhs, const void * iRhs)
+{
+	const node * lhs = iLhs;
+	const node * rhs = iRhs;
+
+	if (! lhs->name && ! rhs->name) {
+		return lhs->index < rhs->index ? -1 : lhs->index > rhs->index;
+	}
+	if (! lhs->name || ! rhs->name) {
+		return lhs->name ? 1 : -1;
+	}
+	return strcmp(lhs->name, rhs->name);
+}
+
+/**
+ * Append iKey to iPath, as a path component.
+ * @return New path, or 0 if iKey can't be a path component.
+ */
+static char *
+child_path(const char * iPath, const node * iKey)
+{
+	char buf[32];
+	const char * key = buf;
+	const char * sep = "";
+
+	if (iKey->name) {
+		if (! *iKey->name || strpbrk(iKey->name, ".[]")) {
+			return 0;
+		}
+		key = iKey->name;
+		sep = *iPath ? "." : "";
+	} else {
+		if (! *iPath) {
+			return 0;
+		}
+		snprintf(buf, sizeof(buf), "[%d]", iKey->index);
+	}
+
+	const size_t len = strlen(iPath) + strlen(sep) + strlen(key) + 1;
+	char * path = check_alloc(malloc(len));
+	snprintf(path, len, "%s%s%s", iPath, sep, key);
+	return path;
+}
+
+static bool
+evaluate_table(bake * iBake, const char * iPath, node * ioNode);
+
+/**
+ * Evaluate the value at the top of the stack into ioNode,
+ * calling it as function(iPath) if it's a function.
+ * @return False on error.
+ */
+static bool
+evaluate(bake * iBake, const char * iPath, node * ioNode)
+{
+	lua_State * L = iBake->state;
+
+	if (lua_isfunction(L, -1)) {
+		if (! iPath) {
+			fprintf(stderr, "%s: Function at key that can't be"
+				" a path\n", iBake->progname);
+			return false;
+		}
+		lua_pushstring(L, iPath);
+		if (0 != lua_pcall(L, 1, 1, 0)) {
+			fprintf(stderr, "%s: %s: %s\n", iBake->progname, iPath,
+				lua_tostring(L, -1));
+			return false;
+		}
+	}
+
+	switch (lua_type(L, -1)) {
+
+	case LUA_TBOOLEAN:
+		ioNode->value.type = LK_TYPE_BOOLEAN;
+		ioNode->value.boolean = lua_toboolean(L, -1);
+		return true;
+
+	case LUA_TNUMBER:
+		ioNode->value.type = LK_TYPE_NUMBER;
+		ioNode->value.number = lua_tonumber(L, -1);
+		ioNode->value.integer = lua_tointeger(L, -1);
+		return true;
+
+	case LUA_TSTRING: {
+		size_t len;
+		const char * str = lua_tolstring(L, -1, &len);
+		ioNode->value.type = LK_TYPE_STRING;
+		ioNode->value.string = copy(str, len);
+		ioNode->value.length = len;
+		return true;
+	}
+
+	case LUA_TTABLE:
+		ioNode->value.type = LK_TYPE_TABLE;
+		return evaluate_table(iBake, iPath, ioNode);
+
+	default:
+		fprintf(stderr, "%s: %s: Unsupported type %s\n",
+			iBake->progname, iPath ? iPath : "?",
+			lua_typename(L, lua_type(L, -1)));
+		return false;
+	}
+}
+
+/**
+ * Evaluate the table at the top of the stack into the children of ioNode.
+ * @return False on error.
+ */
+static bool
+evaluate_table(bake * iBake, const char * iPath, node * ioNode)
+{
+	lua_State * L = iBake->state;
+
+	if (! lua_checkstack(L, 8)) {
+		fprintf(stderr, "%s: %s: Too deep\n",
+			iBake->progname, iPath ? iPath : "?");
+		return false;
+	}
+
+	const int table = lua_gettop(L);
+
+	lua_pushvalue(L, table);
+	lua_rawget(L, iBake->visited);
+	const bool cycle = lua_toboolean(L, -1);
+	lua_pop(L, 1);
+	if (cycle) {
+		fprintf(stderr, "%s: %s: Table contains itself\n",
+			iBake->progname, iPath ? iPath : "?");
+		return false;
+	}
+	lua_pushvalue(L, table);
+	lua_pushboolean(L, 1);
+	lua_rawset(L, iBake->visited);
+
+	bool ok = true;
+	lua_pushnil(L);						/* S: t nil */
+	while (ok && lua_next(L, table)) {			/* S: t k v */
+		node child;
+		memset(&child, 0, sizeof(child));
+
+		const int key = table + 1;
+		if (LUA_TSTRING == lua_type(L, key)) {
+			size_t len;
+			const char * name = lua_tolstring(L, key, &len);
+			if (strlen(name) != len) {
+				fprintf(stderr, "%s: %s: Skipping key with nul\n",
+					iBake->progname, iPath ? iPath : "?");
+				lua_pop(L, 1);
+				continue;
+			}
+			child.name = copy(name, len);
+		} else if (LUA_TNUMBER == lua_type(L, key)
+			   && lua_tonumber(L, key) >= -2147483648.0
+			   && lua_tonumber(L, key) <= 2147483647.0
+			   && lua_tonumber(L, key)
+			      == (lua_Number)(int)lua_tonumber(L, key)) {
+			child.index = (int)lua_tonumber(L, key);
+		} else {
+			fprintf(stderr, "%s: %s: Skipping %s key\n",
+				iBake->progname, iPath ? iPath : "?",
+				lua_typename(L, lua_type(L, key)));
+			lua_pop(L, 1);
+			continue;
+		}
+
+		char * path = iPath ? child_path(iPath, &child) : 0;
+		ok = evaluate(iBake, path, &child);
+		free(path);
+		lua_settop(L, key);				/* S: t k */
+
+		ioNode->children = check_alloc(realloc(ioNode->children,
+			(ioNode->count + 1) * sizeof(child)));
+		ioNode->children[ioNode->count++] = child;
+	}
+	lua_settop(L, table);					/* S: t */
+
+	lua_pushvalue(L, table);
+	lua_pushnil(L);
+	lua_rawset(L, iBake->visited);
+
+	if (ioNode->count) {
+		qsort(ioNode->children, ioNode->count,
+			sizeof(*ioNode->children), compare_nodes);
+	}
+
+	return ok;
+}
+
+/**
+ * Write iStr[0..iLen) as a C string literal.
+ */
+static void
+write_string(FILE * iFile, const char * iStr, const size_t iLen)
+{
+	fputc('"', iFile);
+	size_t i;
+	for (i = 0; i < iLen; ++i) {
+		const unsigned char c = (unsigned char)iStr[i];
+		if ('"' == c || '\\' == c || '?' == c) {
+			fprintf(iFile, "\\%c", c);
+		} else if (isprint(c)) {
+			fputc(c, iFile);
+		} else {
+			fprintf(iFile, "\\%03o", c);
+		}
+	}
+	fputc('"', iFile);
+}
+
+/**
+ * Write iValue as a lkonf_value initialiser.
+ */
+static void
+write_value(FILE * iFile, const lkonf_value * iValue)
+{
+	static const char * const types[] = {
+		"LK_TYPE_NIL",
+		"LK_TYPE_BOOLEAN",
+		"LK_TYPE_NUMBER",
+		"LK_TYPE_STRING",
+		"LK_TYPE_TABLE",
+	};
+
+	fprintf(iFile, "{ %s, %s, ", types[iValue->type],
+		iValue->boolean ? "true" : "false");
+
+	const double n = iValue->number;
+	if (n != n) {
+		fprintf(iFile, "NAN, ");
+	} else if (n > 1e308 || n < -1e308) {
+		fprintf(iFile, "%sHUGE_VAL, ", n < 0 ? "-" : "");
+	} else {
+		fprintf(iFile, "%.17g, ", n);
+	}
+	fprintf(iFile, "(lua_Integer)%lldLL, ", (long long)iValue->integer);
+
+	if (iValue->string) {
+		write_string(iFile, iValue->string, iValue->length);
+		fprintf(iFile, ", %zu }", iValue->length);
+	} else {
+		fprintf(iFile, "0, 0 }");
+	}
+}
+
+/**
+ * Write the arrays of children of iNode, innermost first.
+ * @return Id of the array of children of iNode.
+ */
+static size_t
+write_children(bake * iBake, FILE * iFile, const node * iNode)
+{
+	size_t * ids = check_alloc(calloc(iNode->count + 1, sizeof(*ids)));
+
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		if (iNode->children[i].count) {
+			ids[i] = write_children(iBake, iFile, &iNode->children[i]);
+		}
+	}
+
+	const size_t id = iBake->next_id++;
+	fprintf(iFile, "static const lkonf_static_node n%zu[] = {\n", id);
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		fprintf(iFile, "\t{ ");
+		if (c->name) {
+			write_string(iFile, c->name, strlen(c->name));
+		} else {
+			fprintf(iFile, "0");
+		}
+		fprintf(iFile, ", %d,\n\t  ", c->index);
+		write_value(iFile, &c->value);
+		if (c->count) {
+			fprintf(iFile, ",\n\t  n%zu, %zu },\n", ids[i], c->count);
+		} else {
+			fprintf(iFile, ",\n\t  0, 0 },\n");
+		}
+	}
+	fprintf(iFile, "};\n\n");
+
+	free(ids);
+	return id;
+}
+
+/**
+ * Print a usage.
+ */
+int
+usage(const char * progname)
+{
+	fprintf(stderr, "Usage: %s [-s <symbol>] -o <output> <config>\n",
+		progname);
+	fprintf(stderr, "    -s <symbol>  Name of root node. [lkonf_baked]\n");
+	fprintf(stderr, "    -o <output>  C source file to write.\n");
+	fprintf(stderr, "    <config>     Configuration file.\n");
+	return EXIT_FAILURE;
+}
+
+/**
+ * Main entry.
+ */
+int
+main(int argc, char * argv[])
+{
+		/* determine progname */
+	char * progname = strrchr(argv[0], '/');
+	if (progname) {
+		++progname;
+	} else {
+		progname = argv[0];
+	}
+
+	const char * symbol = "lkonf_baked";
+	const char * output = 0;
+	int ch;
+	while (-1 != (ch = getopt(argc, argv, "o:s:"))) {
+		switch (ch) {
+			case 'o':
+				output = optarg;
+				break;
+			case 's':
+				symbol = optarg;
+				break;
+			default:
+				return usage(progname);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+	if (1 != argc || ! output) {
+		return usage(progname);
+	}
+	const char * input = argv[0];
+
+	lkonf_context * lc = lkonf_construct();
+	if (! lc) {
+		fprintf(stderr, "%s: Can't construct lkonf_context\n", progname);
+		return EXIT_FAILURE;
+	}
+
+	if (LK_OK != lkonf_load_file(lc, input)) {
+		fprintf(stderr, "%s: %s: %s\n", progname, input,
+			lkonf_get_error_string(lc));
+		lkonf_destruct(lc);
+		return EXIT_FAILURE;
+	}
+
+	bake b;
+	memset(&b, 0, sizeof(b));
+	b.progname = progname;
+	b.state = lkonf_get_lua_State(lc);
+
+	lua_newtable(b.state);
+	b.visited = lua_gettop(b.state);
+#if LUA_VERSION_NUM >= 502
+	lua_pushglobaltable(b.state);
+#else
+	lua_pushvalue(b.state, LUA_GLOBALSINDEX);
+#endif
+
+	node root;
+	memset(&root, 0, sizeof(root));
+	root.value.type = LK_TYPE_TABLE;
+
+	int rv = EXIT_FAILURE;
+	FILE * f = 0;
+	if (! evaluate_table(&b, "", &root)) {
+		/* error already reported */
+	} else if (0 == (f = fopen(output, "w"))) {
+		fprintf(stderr, "%s: Can't create %s\n", progname, output);
+	} else {
+		fprintf(f, "/*\n * Generated by lkonf-bake from %s;"
+			" do not edit.\n *\n * Use with:\n"
+			" *	extern const lkonf_static_node %s;\n"
+			" *	lkonf_construct_static(&%s);\n */\n\n",
+			input, symbol, symbol);
+		fprintf(f, "#include <lkonf.h>\n\n#include <math.h>\n\n");
+		const size_t id = root.count ? write_children(&b, f, &root) : 0;
+		fprintf(f, "const lkonf_static_node %s = {\n\t0, 0,\n\t", symbol);
+		write_value(f, &root.value);
+		if (root.count) {
+			fprintf(f, ",\n\tn%zu, %zu\n};\n", id, root.count);
+		} else {
+			fprintf(f, ",\n\t0, 0\n};\n");
+		}
+		if (0 != fclose(f)) {
+			fprintf(stderr, "%s: Can't write %s\n",
+				progname, output);
+		} else {
+			rv = EXIT_SUCCESS;
+		}
+	}
+
+	free_node(&root);
+	lkonf_destruct(lc);
+
+	return rv;
+}
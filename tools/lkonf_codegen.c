@@ -0,0 +1,673 @@
+#include <lkonf.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Kind of a generated member.
+ */
+typedef enum
+{
+	NODE_BOOLEAN,
+	NODE_INTEGER,
+	NODE_DOUBLE,
+	NODE_STRING,
+	NODE_STRUCT,
+} node_kind;
+
+/**
+ * Member inferred from the sample configuration.
+ */
+typedef struct node_s node;
+
+struct node_s
+{
+	char *		name;		/** Key, or 0 for the root. */
+	char *		cname;		/** C name: prefix_key_key. */
+	node_kind	kind;		/** Kind of member. */
+	node *		children;	/** Members of NODE_STRUCT. */
+	size_t		count;		/** Number of children. */
+};
+
+/**
+ * Generation options.
+ */
+typedef struct
+{
+	const char *	progname;	/** Program name, for messages. */
+	const char *	input;		/** Sample configuration file. */
+	const char *	prefix;		/** Prefix of generated names. */
+	const char *	root;		/** Path of root table. */
+	const char *	header;		/** Basename of generated header. */
+	bool		required;	/** Bind members as required. */
+	char **		root_keys;	/** Components of root. */
+	size_t		num_root_keys;	/** Number of root_keys. */
+} options;
+
+/**
+ * Return true if iName is a C identifier.
+ */
+static bool
+is_identifier(const char * iName)
+{
+	if (! iName || (! isalpha((unsigned char)*iName) && '_' != *iName)) {
+		return false;
+	}
+	for (++iName; *iName; ++iName) {
+		if (! isalnum((unsigned char)*iName) && '_' != *iName) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Return a new string of iLhs + iSep + iRhs.
+ */
+static char *
+join(const char * iLhs, const char * iSep, const char * iRhs)
+{
+	const size_t len = strlen(iLhs) + strlen(iSep) + strlen(iRhs) + 1;
+	char * str = malloc(len);
+	if (! str) {
+		fprintf(stderr, "Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	snprintf(str, len, "%s%s%s", iLhs, iSep, iRhs);
+	return str;
+}
+
+/**
+ * Free the members of iNode.
+ */
+static void
+free_node(node * iNode)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		free_node(&iNode->children[i]);
+	}
+	free(iNode->children);
+	free(iNode->name);
+	free(iNode->cname);
+}
+
+/**
+ * Infer the members of ioNode from the table at iPath.
+ * Keys are sorted, so output is stable.
+ * @return False on error.
+ */
+static bool
+build(
+	const options *	iOpts,
+	lkonf_context *	iLc,
+	const char *	iPath,
+	node *		ioNode)
+{
+	lkonf_iter * it = 0;
+	if (LK_OK != lkonf_iter_begin(iLc, iPath,
+	    LK_ITER_HASH | LK_ITER_SORTED, &it)) {
+		fprintf(stderr, "%s: %s\n",
+			iOpts->progname, lkonf_get_error_string(iLc));
+		return false;
+	}
+
+	lkonf_value	key;
+	lkonf_value	value;
+	lkonf_error	lerr;
+	while (LK_OK == (lerr = lkonf_iter_next(it, &key, &value))) {
+		if (LK_TYPE_STRING != key.type || ! is_identifier(key.string)) {
+			fprintf(stderr, "%s: %s: Skipping non-identifier key\n",
+				iOpts->progname, *iPath ? iPath : "(root)");
+			continue;
+		}
+
+		if (! ioNode->name && (0 == strcmp("load", key.string)
+		    || 0 == strcmp("free", key.string))) {
+			fprintf(stderr, "%s: %s: Skipping key reserved for"
+				" %s_%s()\n", iOpts->progname, key.string,
+				ioNode->cname, key.string);
+			continue;
+		}
+
+		node child;
+		memset(&child, 0, sizeof(child));
+		child.name = join("", "", key.string);
+		child.cname = join(ioNode->cname, "_", key.string);
+		char * path = *iPath ? join(iPath, ".", key.string)
+				     : join("", "", key.string);
+
+		bool keep = true;
+		switch (value.type) {
+		case LK_TYPE_BOOLEAN:
+			child.kind = NODE_BOOLEAN;
+			break;
+		case LK_TYPE_NUMBER:
+			child.kind = (double)value.integer == value.number
+			    ? NODE_INTEGER : NODE_DOUBLE;
+			break;
+		case LK_TYPE_STRING:
+			child.kind = NODE_STRING;
+			break;
+		case LK_TYPE_TABLE:
+			child.kind = NODE_STRUCT;
+			if (! build(iOpts, iLc, path, &child)) {
+				free(path);
+				free_node(&child);
+				lkonf_iter_end(it);
+				return false;
+			}
+			if (! child.count) {
+				fprintf(stderr, "%s: %s: Skipping table without"
+					" named keys\n", iOpts->progname, path);
+				keep = false;
+			}
+			break;
+		default:
+			fprintf(stderr, "%s: %s: Skipping unsupported type\n",
+				iOpts->progname, path);
+			keep = false;
+			break;
+		}
+		free(path);
+
+		if (! keep) {
+			free_node(&child);
+			continue;
+		}
+
+		node * children = realloc(ioNode->children,
+			(ioNode->count + 1) * sizeof(*children));
+		if (! children) {
+			fprintf(stderr, "Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+		ioNode->children = children;
+		ioNode->children[ioNode->count++] = child;
+	}
+
+	lkonf_iter_end(it);
+
+	if (LK_NOT_FOUND != lerr) {
+		fprintf(stderr, "%s: %s\n",
+			iOpts->progname, lkonf_get_error_string(iLc));
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Depth of the deepest member of iNode.
+ */
+static size_t
+depth(const node * iNode)
+{
+	size_t max = 0;
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		const size_t d = depth(&iNode->children[i]);
+		if (d > max) {
+			max = d;
+		}
+	}
+	return iNode->count ? max + 1 : 0;
+}
+
+/**
+ * C type of a member iNode.
+ */
+static const char *
+c_type(const node * iNode)
+{
+	switch (iNode->kind) {
+	case NODE_BOOLEAN:	return "bool\t\t";
+	case NODE_INTEGER:	return "lua_Integer\t";
+	case NODE_DOUBLE:	return "double\t\t";
+	case NODE_STRING:	return "char *\t\t";
+	case NODE_STRUCT:	break;
+	}
+	return "";
+}
+
+/**
+ * Write struct definitions for iNode and its children, innermost first.
+ */
+static void
+write_structs(FILE * iFile, const node * iNode)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		if (NODE_STRUCT == iNode->children[i].kind) {
+			write_structs(iFile, &iNode->children[i]);
+		}
+	}
+
+	fprintf(iFile, "struct %s\n{\n", iNode->cname);
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		if (NODE_STRUCT == c->kind) {
+			fprintf(iFile, "\tstruct %s\t%s;\n", c->cname, c->name);
+		} else {
+			fprintf(iFile, "\t%s%s;\n", c_type(c), c->name);
+		}
+	}
+	fprintf(iFile, "};\n\n");
+}
+
+/**
+ * Write the accessor prototype for iNode.
+ */
+static void
+write_prototype(FILE * iFile, const node * iNode)
+{
+	fprintf(iFile, "lkonf_error\n%s(lkonf_context * iLc, ", iNode->cname);
+	switch (iNode->kind) {
+	case NODE_BOOLEAN:
+		fprintf(iFile, "bool * oValue)");
+		break;
+	case NODE_INTEGER:
+		fprintf(iFile, "lua_Integer * oValue)");
+		break;
+	case NODE_DOUBLE:
+		fprintf(iFile, "double * oValue)");
+		break;
+	case NODE_STRING:
+		fprintf(iFile, "char ** oValue, size_t * oLen)");
+		break;
+	case NODE_STRUCT:
+		break;
+	}
+}
+
+/**
+ * Write accessor prototypes for the leaves of iNode.
+ */
+static void
+write_prototypes(FILE * iFile, const node * iNode)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		if (NODE_STRUCT == c->kind) {
+			write_prototypes(iFile, c);
+		} else {
+			write_prototype(iFile, c);
+			fprintf(iFile, ";\n\n");
+		}
+	}
+}
+
+/**
+ * Write accessors for the leaves of iNode,
+ * with iKeys[0..iDepth) the keys of iNode.
+ */
+static void
+write_accessors(
+	FILE *		iFile,
+	const node *	iNode,
+	const char **	iKeys,
+	const size_t	iDepth)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		iKeys[iDepth] = c->name;
+		if (NODE_STRUCT == c->kind) {
+			write_accessors(iFile, c, iKeys, iDepth + 1);
+			continue;
+		}
+
+		fprintf(iFile, "static const lkonf_ikey keys_%s[] = {\n\t",
+			c->cname);
+		size_t k;
+		for (k = 0; k <= iDepth; ++k) {
+			fprintf(iFile, "LK_NAME(\"%s\"), ", iKeys[k]);
+		}
+		fprintf(iFile, "LK_END\n};\n\n");
+
+		write_prototype(iFile, c);
+		fprintf(iFile, "\n{\n\treturn lkonf_getikey_");
+		switch (c->kind) {
+		case NODE_BOOLEAN:
+			fprintf(iFile, "boolean(iLc, keys_%s, oValue);\n",
+				c->cname);
+			break;
+		case NODE_INTEGER:
+			fprintf(iFile, "integer(iLc, keys_%s, oValue);\n",
+				c->cname);
+			break;
+		case NODE_DOUBLE:
+			fprintf(iFile, "double(iLc, keys_%s, oValue);\n",
+				c->cname);
+			break;
+		case NODE_STRING:
+			fprintf(iFile, "string(iLc, keys_%s, oValue, oLen);\n",
+				c->cname);
+			break;
+		case NODE_STRUCT:
+			break;
+		}
+		fprintf(iFile, "}\n\n");
+	}
+}
+
+/**
+ * Write binding tables for iNode and its children, innermost first.
+ */
+static void
+write_bindings(FILE * iFile, const options * iOpts, const node * iNode)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		if (NODE_STRUCT == iNode->children[i].kind) {
+			write_bindings(iFile, iOpts, &iNode->children[i]);
+		}
+	}
+
+	static const char * const types[] = {
+		"LK_BIND_BOOLEAN",
+		"LK_BIND_INTEGER",
+		"LK_BIND_DOUBLE",
+		"LK_BIND_STRING",
+		"LK_BIND_STRUCT",
+	};
+
+	fprintf(iFile, "static const lkonf_binding bindings_%s[] = {\n",
+		iNode->cname);
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		fprintf(iFile, "\t{ \"%s\", %s,\n\t  offsetof(struct %s, %s), %s,\n",
+			c->name, types[c->kind], iNode->cname, c->name,
+			iOpts->required ? "true" : "false");
+		if (NODE_STRUCT == c->kind) {
+			fprintf(iFile, "\t  { .integer = 0 }, bindings_%s, %zu, 0 },\n",
+				c->cname, c->count);
+		} else {
+			fprintf(iFile, "\t  { .integer = 0 }, 0, 0, 0 },\n");
+		}
+	}
+	fprintf(iFile, "};\n\n");
+}
+
+/**
+ * Write statements to free the strings of iNode,
+ * with iMember the expression for iNode.
+ */
+static void
+write_free(FILE * iFile, const node * iNode, const char * iMember)
+{
+	size_t i;
+	for (i = 0; i < iNode->count; ++i) {
+		const node * c = &iNode->children[i];
+		const size_t len = strlen(iMember);
+		const bool arrow = len >= 2 && '>' == iMember[len - 1];
+		char * member = join(iMember, arrow ? "" : ".", c->name);
+		if (NODE_STRUCT == c->kind) {
+			write_free(iFile, c, member);
+		} else if (NODE_STRING == c->kind) {
+			fprintf(iFile, "\tfree(%s);\n", member);
+		}
+		free(member);
+	}
+}
+
+/**
+ * Write the generated header.
+ */
+static bool
+write_header(const options * iOpts, const char * iFilename, const node * iRoot)
+{
+	FILE * f = fopen(iFilename, "w");
+	if (! f) {
+		fprintf(stderr, "%s: Can't create %s\n",
+			iOpts->progname, iFilename);
+		return false;
+	}
+
+	char * guard = join(iOpts->header, "", "");
+	char * p;
+	for (p = guard; *p; ++p) {
+		*p = isalnum((unsigned char)*p) ? toupper((unsigned char)*p) : '_';
+	}
+
+	fprintf(f, "/*\n * Generated by lkonf-codegen from %s; do not edit.\n"
+		" */\n\n", iOpts->input);
+	fprintf(f, "#ifndef %s\n#define %s\n\n#include <lkonf.h>\n\n",
+		guard, guard);
+	fprintf(f, "#ifdef  __cplusplus\nextern \"C\" {\n#endif\n\n");
+
+	write_structs(f, iRoot);
+	write_prototypes(f, iRoot);
+
+	fprintf(f, "/**\n * Load struct %s from \"%s\" in one pass.\n"
+		" * As per lkonf_bind(); free with %s_free().\n */\n",
+		iRoot->cname, iOpts->root, iRoot->cname);
+	fprintf(f, "lkonf_error\n%s_load(\n\tlkonf_context *\t\tiLc,\n"
+		"\tstruct %s *\t\toCfg,\n"
+		"\tlkonf_bind_report\tiReport,\n"
+		"\tvoid *\t\t\tiArg);\n\n", iRoot->cname, iRoot->cname);
+	fprintf(f, "/**\n * Free the strings in struct %s.\n */\n"
+		"void\n%s_free(struct %s * iCfg);\n\n",
+		iRoot->cname, iRoot->cname, iRoot->cname);
+
+	fprintf(f, "#ifdef  __cplusplus\n} /* extern \"C\" */\n#endif\n\n");
+	fprintf(f, "#endif /* %s */\n", guard);
+	free(guard);
+
+	if (0 != fclose(f)) {
+		fprintf(stderr, "%s: Can't write %s\n",
+			iOpts->progname, iFilename);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Write the generated source.
+ */
+static bool
+write_source(const options * iOpts, const char * iFilename, const node * iRoot)
+{
+	FILE * f = fopen(iFilename, "w");
+	if (! f) {
+		fprintf(stderr, "%s: Can't create %s\n",
+			iOpts->progname, iFilename);
+		return false;
+	}
+
+	fprintf(f, "/*\n * Generated by lkonf-codegen from %s; do not edit.\n"
+		" */\n\n", iOpts->input);
+	fprintf(f, "#include \"%s\"\n\n#include <stddef.h>\n"
+		"#include <stdlib.h>\n\n", iOpts->header);
+
+	const char ** keys = calloc(iOpts->num_root_keys + depth(iRoot),
+		sizeof(*keys));
+	if (! keys) {
+		fprintf(stderr, "Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	size_t k;
+	for (k = 0; k < iOpts->num_root_keys; ++k) {
+		keys[k] = iOpts->root_keys[k];
+	}
+	write_accessors(f, iRoot, keys, iOpts->num_root_keys);
+	free(keys);
+
+	write_bindings(f, iOpts, iRoot);
+
+	fprintf(f, "lkonf_error\n%s_load(\n\tlkonf_context *\t\tiLc,\n"
+		"\tstruct %s *\t\toCfg,\n"
+		"\tlkonf_bind_report\tiReport,\n"
+		"\tvoid *\t\t\tiArg)\n{\n", iRoot->cname, iRoot->cname);
+	fprintf(f, "\treturn lkonf_bind(iLc, \"%s\", bindings_%s, %zu,\n"
+		"\t\toCfg, iReport, iArg);\n}\n\n",
+		iOpts->root, iRoot->cname, iRoot->count);
+
+	fprintf(f, "void\n%s_free(struct %s * iCfg)\n{\n",
+		iRoot->cname, iRoot->cname);
+	write_free(f, iRoot, "iCfg->");
+	fprintf(f, "}\n");
+
+	if (0 != fclose(f)) {
+		fprintf(stderr, "%s: Can't write %s\n",
+			iOpts->progname, iFilename);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Split iRoot into ioOpts->root_keys.
+ * @return False if a component isn't an identifier.
+ */
+static bool
+split_root(options * ioOpts)
+{
+	const char * p = ioOpts->root;
+	while (*p) {
+		const size_t len = strcspn(p, ".");
+		char * key = malloc(len + 1);
+		char ** keys = realloc(ioOpts->root_keys,
+			(ioOpts->num_root_keys + 1) * sizeof(*keys));
+		if (! key || ! keys) {
+			fprintf(stderr, "Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(key, p, len);
+		key[len] = '\0';
+		ioOpts->root_keys = keys;
+		ioOpts->root_keys[ioOpts->num_root_keys++] = key;
+		if (! is_identifier(key)) {
+			return false;
+		}
+		p += len;
+		if ('.' == *p && ! *++p) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Print a usage.
+ */
+int
+usage(const char * progname)
+{
+	fprintf(stderr,
+		"Usage: %s [-O] [-p <prefix>] [-r <root>] -o <output> <sample>\n",
+		progname);
+	fprintf(stderr, "    -O           Bind members as optional.\n");
+	fprintf(stderr, "    -p <prefix>  Prefix of generated names. [cfg]\n");
+	fprintf(stderr, "    -r <root>    Path of root table. [globals]\n");
+	fprintf(stderr, "    -o <output>  Write <output>.h and <output>.c.\n");
+	fprintf(stderr, "    <sample>     Sample configuration file.\n");
+	return EXIT_FAILURE;
+}
+
+/**
+ * Main entry.
+ */
+int
+main(int argc, char * argv[])
+{
+		/* determine progname */
+	char * progname = strrchr(argv[0], '/');
+	if (progname) {
+		++progname;
+	} else {
+		progname = argv[0];
+	}
+
+	options opts;
+	memset(&opts, 0, sizeof(opts));
+	opts.progname = progname;
+	opts.prefix = "cfg";
+	opts.root = "";
+	opts.required = true;
+
+	const char * output = 0;
+	int ch;
+	while (-1 != (ch = getopt(argc, argv, "Oo:p:r:"))) {
+		switch (ch) {
+			case 'O':
+				opts.required = false;
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			case 'p':
+				opts.prefix = optarg;
+				break;
+			case 'r':
+				opts.root = optarg;
+				break;
+			default:
+				return usage(progname);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+	if (1 != argc || ! output) {
+		return usage(progname);
+	}
+	opts.input = argv[0];
+
+	if (! is_identifier(opts.prefix)) {
+		fprintf(stderr, "%s: Invalid prefix '%s'\n",
+			progname, opts.prefix);
+		return EXIT_FAILURE;
+	}
+
+	if (! split_root(&opts)) {
+		fprintf(stderr, "%s: Invalid root '%s'\n", progname, opts.root);
+		return EXIT_FAILURE;
+	}
+
+	char * header = join(output, "", ".h");
+	char * source = join(output, "", ".c");
+	const char * base = strrchr(header, '/');
+	opts.header = base ? base + 1 : header;
+
+	lkonf_context * lc = lkonf_construct();
+	if (! lc) {
+		fprintf(stderr, "%s: Can't construct lkonf_context\n", progname);
+		return EXIT_FAILURE;
+	}
+
+	int rv = EXIT_FAILURE;
+	node root;
+	memset(&root, 0, sizeof(root));
+	root.kind = NODE_STRUCT;
+	root.cname = join(opts.prefix, "", "");
+
+	if (LK_OK != lkonf_load_file(lc, opts.input)) {
+		fprintf(stderr, "%s: %s: %s\n", progname, opts.input,
+			lkonf_get_error_string(lc));
+	} else if (! build(&opts, lc, opts.root, &root)) {
+		/* error already reported */
+	} else if (! root.count) {
+		fprintf(stderr, "%s: %s: No members found\n",
+			progname, opts.input);
+	} else if (write_header(&opts, header, &root)
+		   && write_source(&opts, source, &root)) {
+		rv = EXIT_SUCCESS;
+	}
+
+	free_node(&root);
+	lkonf_destruct(lc);
+	size_t k;
+	for (k = 0; k < opts.num_root_keys; ++k) {
+		free(opts.root_keys[k]);
+	}
+	free(opts.root_keys);
+	free(header);
+	free(source);
+
+	return rv;
+}
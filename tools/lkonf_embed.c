@@ -0,0 +1,158 @@
+#include <lauxlib.h>
+#include <lua.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Output of lua_dump().
+ */
+typedef struct
+{
+	FILE *		file;		/** File to write. */
+	size_t		len;		/** Bytes written. */
+} embed_writer;
+
+/**
+ * lua_Writer writing the chunk as C array elements.
+ */
+static int
+write_chunk(lua_State * iState, const void * iData, size_t iSize, void * iUd)
+{
+	(void)iState;
+
+	embed_writer * writer = iUd;
+	const unsigned char * data = iData;
+
+	size_t i;
+	for (i = 0; i < iSize; ++i, ++writer->len) {
+		fprintf(writer->file, "%s0x%02x,",
+			(writer->len % 12) ? " " : "\n\t", data[i]);
+	}
+
+	return ferror(writer->file);
+}
+
+/**
+ * Print a usage.
+ */
+int
+usage(const char * progname)
+{
+	fprintf(stderr, "Usage: %s [-s <symbol>] -o <output> <config>\n",
+		progname);
+	fprintf(stderr, "    -s <symbol>  Name of chunk array. [lkonf_embedded]\n");
+	fprintf(stderr, "    -o <output>  C source file to write.\n");
+	fprintf(stderr, "    <config>     Configuration file.\n");
+	return EXIT_FAILURE;
+}
+
+/**
+ * Main entry.
+ */
+int
+main(int argc, char * argv[])
+{
+		/* determine progname */
+	char * progname = strrchr(argv[0], '/');
+	if (progname) {
+		++progname;
+	} else {
+		progname = argv[0];
+	}
+
+	const char * symbol = "lkonf_embedded";
+	const char * output = 0;
+	int ch;
+	while (-1 != (ch = getopt(argc, argv, "o:s:"))) {
+		switch (ch) {
+			case 'o':
+				output = optarg;
+				break;
+			case 's':
+				symbol = optarg;
+				break;
+			default:
+				return usage(progname);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+	if (1 != argc || ! output) {
+		return usage(progname);
+	}
+	const char * input = argv[0];
+
+	lua_State * L = luaL_newstate();
+	if (! L) {
+		fprintf(stderr, "%s: Can't create Lua state\n", progname);
+		return EXIT_FAILURE;
+	}
+
+		/* Compile only; the chunk is run by lkonf_load_embedded(). */
+	if (luaL_loadfile(L, input)) {
+		fprintf(stderr, "%s: %s\n", progname, lua_tostring(L, -1));
+		lua_close(L);
+		return EXIT_FAILURE;
+	}
+
+	FILE * f = fopen(output, "w");
+	if (! f) {
+		fprintf(stderr, "%s: Can't create %s\n", progname, output);
+		lua_close(L);
+		return EXIT_FAILURE;
+	}
+
+	fprintf(f, "/*\n * Generated by lkonf-embed from %s;"
+		" do not edit.\n *\n * Use with:\n"
+		" *	extern const unsigned char %s[];\n"
+		" *	extern const size_t %s_size;\n"
+		" *	lkonf_load_embedded(lc, %s, %s_size, \"=%s\");\n */\n\n",
+		input, symbol, symbol, symbol, symbol, input);
+	fprintf(f, "#include <lua.h>\n#include <stddef.h>\n\n");
+
+		/* The bytecode format is specific to the Lua version
+		 * and the size of lua_Number, so check both at build time. */
+	fprintf(f, "#if LUA_VERSION_NUM != %d\n"
+		"#error \"%s was compiled for Lua version %d\"\n#endif\n\n",
+		LUA_VERSION_NUM, input, LUA_VERSION_NUM);
+		/* LuaJIT bytecode isn't Lua 5.1 bytecode, nor vice versa.
+		 * LuaJIT's lualib.h defines LUA_JITLIBNAME. */
+#if defined(LKONF_LUAJIT)
+	fprintf(f, "#include <luajit.h>\n\n"
+		"#if ! defined(LUAJIT_VERSION)\n"
+		"#error \"%s was compiled for LuaJIT\"\n#endif\n\n",
+		input);
+#else
+	fprintf(f, "#include <lualib.h>\n\n"
+		"#if defined(LUAJIT_VERSION) || defined(LUA_JITLIBNAME)\n"
+		"#error \"%s was compiled for Lua, not LuaJIT\"\n#endif\n\n",
+		input);
+#endif
+	fprintf(f, "typedef char %s_lua_Number_check"
+		"[sizeof(lua_Number) == %zu ? 1 : -1];\n\n",
+		symbol, sizeof(lua_Number));
+
+	fprintf(f, "const unsigned char %s[] = {", symbol);
+	embed_writer writer = { f, 0 };
+#if LUA_VERSION_NUM >= 503
+	const int res = lua_dump(L, write_chunk, &writer, 1);
+#else
+	const int res = lua_dump(L, write_chunk, &writer);
+#endif
+	fprintf(f, "\n};\n\nconst size_t %s_size = sizeof(%s);\n",
+		symbol, symbol);
+
+	int rv = EXIT_SUCCESS;
+	if (0 != fclose(f) || res) {
+		fprintf(stderr, "%s: Can't write %s\n", progname, output);
+		rv = EXIT_FAILURE;
+	}
+
+	lua_close(L);
+
+	return rv;
+}